@@ -1,66 +1,459 @@
 #include "PitchDetector.h"
 
-#include <cmath>
 #include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <functional>
+
+#include "dsp/AllocationGuard.h"
 
 namespace {
-constexpr float kA4 = 440.0f;
-constexpr int32_t kMidiMin = 21;
-constexpr int32_t kMidiMax = 108;
+/** 一路分析的融合候选；frequencyHz <= 0 表示无效 */
+struct Candidate {
+    float frequencyHz;
+    float confidence;
+};
+
+/** YIN 可信度高于此值即采用 YIN（对应 CMND 谷值低于 YIN 的绝对阈值 0.15） */
+constexpr float kYinTrust = 0.85f;
+/** YIN 不可信时，HPS 可信度高于此值才采用 HPS */
+constexpr float kHpsTrust = 0.05f;
+
+bool inRange(float hz, float minHz, float maxHz) { return hz > 0.0f && hz >= minHz && hz < maxHz; }
+
+/**
+ * 融合规则：高置信 YIN 优先，否则回退 HPS；只接受 [minHz, maxHz) 内的基频
+ * （多分辨率下各路只对自己的音区负责）。
+ */
+Candidate fuse(const YINWrapper::Result& yin, const HPS::Result& hps, float minHz, float maxHz) {
+    if (yin.confidence > kYinTrust && inRange(yin.pitchHz, minHz, maxHz)) {
+        return Candidate{yin.pitchHz, yin.confidence};
+    }
+    if (hps.confidence > kHpsTrust && inRange(hps.frequencyHz, minHz, maxHz)) {
+        return Candidate{hps.frequencyHz, hps.confidence};
+    }
+    return Candidate{-1.0f, 0.0f};
+}
+
+/** 级联融合：确认 HPS 候选 f 前先查的最高倍频 k·f（k = 2..该值，同 [isHarmonicOf] 的谐波范围） */
+constexpr int32_t kMaxCheckedMultiple = 8;
+/** YIN 的搜索上限（C8）；更高的倍频不查 */
+constexpr float kYinMaxHz = 4186.0f;
 
 /**
- * 由基频 Hz 换算 MIDI 音符号（四舍五入），并限制在钢琴范围 [kMidiMin, kMidiMax]。
- * 公式：midi = 69 + 12 * log2(f / 440)，其中 69 对应 A4。
+ * 按融合方式组合 HPS 与 YIN（time / numSamples 为 YIN 的输入），并累计各路执行次数。
+ * Cascaded：以 HPS 候选 f 的 k·f（k = [kMaxCheckedMultiple]..1）、f/2，以及另一音区给出的基频 hintHz（无则 <= 0）
+ * 为候选，按频率从高到低（tau 从小到大）逐个跑窄带 YIN，第一个过可信门的即全范围 YIN 会取到的
+ * “最小的过阈 tau”（周期信号在 T 的整数倍处都有谷，HPS 报成次谐波时只查 f 会确认错的八度）；
+ * 它落在 [minHz, maxHz) 外时与全范围 YIN 一样交给 [fuse] 拒绝、回退 HPS。都未确认才跑全范围 YIN。
+ * 候选不看 HPS 可信度：窄带 YIN 本身就是确认，而白化在冷启动时会把已在发声的音当作噪声底、可信度记 0。
  */
-int32_t freqToMidi(float freqHz) {
-    if (freqHz <= 0.0f) return -1;
-    const float midiFloat = 69.0f + 12.0f * std::log2(freqHz / kA4);
-    int32_t midi = static_cast<int32_t>(std::lround(midiFloat));
-    if (midi < kMidiMin || midi > kMidiMax) return -1;
-    return midi;
+Candidate fuseWithYin(YINWrapper& yin, PitchDetector::FusionMode mode, PitchDetector::FusionStats& stats,
+                      const HPS::Result& hps, float hintHz, const float* time, int32_t numSamples, float sampleRate,
+                      float minHz, float maxHz) {
+    ++stats.frames;
+    if (mode == PitchDetector::FusionMode::Cascaded && hps.frequencyHz > 0.0f &&
+        yin.prepareNarrow(time, numSamples)) {
+        ++stats.narrowYin;
+        float candidates[kMaxCheckedMultiple + 2];
+        int32_t count = 0;
+        for (int32_t m = kMaxCheckedMultiple; m >= 1; --m) {
+            candidates[count++] = static_cast<float>(m) * hps.frequencyHz;
+        }
+        candidates[count++] = 0.5f * hps.frequencyHz;
+        if (hintHz > 0.0f) candidates[count++] = hintHz;
+        std::sort(candidates, candidates + count, std::greater<float>());
+
+        for (int32_t i = 0; i < count; ++i) {
+            if (candidates[i] > kYinMaxHz) continue;
+            const auto narrow = yin.detectNear(sampleRate, candidates[i], PitchDetector::kNarrowYinTolerance);
+            if (narrow.confidence > kYinTrust && narrow.pitchHz > 0.0f) {
+                ++stats.confirmed;
+                return fuse(narrow, hps, minHz, maxHz);
+            }
+        }
+    }
+    ++stats.fullYin;
+    return fuse(yin.detect(time, numSamples, sampleRate), hps, minHz, maxHz);
+}
+
+/**
+ * 白化开启时 HPS 的可信度改用“高出噪声底的幅度占比”（[NoiseFloor::whiten] 的返回值），低于此值视为无音：
+ * 稳态噪声帧实测不超过约 0.19，5 dB 信噪比的单音约 0.2 以上。归一化谐波积本身对噪声不敏感
+ * （实测有音帧中位数仅约 0.002，多数帧过不了 0.05 的门），白化后改以占比为门，HPS 才能真正作为 YIN 的后备。
+ */
+constexpr float kMinTonalRatio = 0.2f;
+
+/** 白化后的 HPS 结果：可信度换为高出噪声底的占比，未过门限则清零 */
+HPS::Result gateByTonalRatio(HPS::Result hps, float tonalRatio) {
+    hps.confidence = tonalRatio >= kMinTonalRatio ? tonalRatio : 0.0f;
+    return hps;
+}
+
+/** 幅度谱上 freqHz 附近 ±1 bin 的最大值 */
+float peakNear(const FFTWrapper::Spectrum& spectrum, float freqHz, float sampleRate) {
+    const float bin = freqHz * static_cast<float>(2 * spectrum.numBins) / sampleRate;
+    const int32_t center = static_cast<int32_t>(std::lround(bin));
+    float peak = 0.0f;
+    for (int32_t k = std::max(center - 1, 0); k <= std::min(center + 1, spectrum.numBins - 1); ++k) {
+        peak = std::max(peak, spectrum.magnitudes[k]);
+    }
+    return peak;
+}
+
+/** upper 是否约为 lower 的 2..8 次谐波（允许 3% 偏差，覆盖钢琴弦的非谐性） */
+bool isHarmonicOf(float upper, float lower) {
+    const float ratio = upper / lower;
+    const float h = std::round(ratio);
+    return h >= 2.0f && h <= 8.0f && std::fabs(ratio - h) <= 0.03f * h;
+}
+}
+
+PitchDetector::PitchDetector() {
+    poly_.prepare(FFTWrapper::kFftSize, kDefaultSampleRate);
+    lastChord_.numNotes = 0;
+    lastChord_.volume = 0.0f;
+    lastChord_.onsetLag = -1;
+    configureNoiseFloors();
+}
+
+void PitchDetector::prepare(float sampleRate, int32_t hopSize) {
+    hopSize = std::clamp(hopSize, 1, FFTWrapper::kFftSize);
+    if (sampleRate <= 0.0f || (sampleRate == sampleRate_ && hopSize == hopSize_)) return;
+
+    if (sampleRate != sampleRate_) {
+        cq_ = ConstantQ(FFTWrapper::kFftSize, sampleRate, kCqBinsPerSemitone, TuningTable::kFirstMidi,
+                        ConstantQ::kDefaultSemitones, tuning_);
+        poly_.prepare(FFTWrapper::kFftSize, sampleRate);
+        sampleRate_ = sampleRate;
+    }
+
+    // 起音后须连续分析到窗口被新音填满：窗口帧数随帧移变化
+    hopSize_ = hopSize;
+    OnsetDetector::Config onsetConfig = onset_.config();
+    onsetConfig.postOnsetHops = (FFTWrapper::kFftSize + hopSize - 1) / hopSize + 1;
+    onset_.setConfig(onsetConfig);
+    configureNoiseFloors();
+    setFftStrategy(requestedStrategy_);
+    reset();
+}
+
+void PitchDetector::setTuning(const TuningTable& tuning) {
+    tuning_ = tuning;
+    cq_ = ConstantQ(FFTWrapper::kFftSize, cq_.sampleRate(), kCqBinsPerSemitone, TuningTable::kFirstMidi,
+                    ConstantQ::kDefaultSemitones, tuning_);
+    poly_.setTuning(tuning_);
+}
+
+void PitchDetector::setFftStrategy(FFTWrapper::Strategy strategy) {
+    requestedStrategy_ = strategy;
+    const bool incrementalOk = hopSize_ == fft_.blockSize();
+    fft_.setStrategy(strategy == FFTWrapper::Strategy::Incremental && !incrementalOk ? FFTWrapper::Strategy::Full
+                                                                                     : strategy);
+}
+
+void PitchDetector::setNoiseWhitening(bool enabled) {
+    noiseWhitening_ = enabled;
+    resetNoiseFloors();
+}
+
+void PitchDetector::setNoiseFloorConfig(const NoiseFloor::Config& config) {
+    noiseConfig_ = config;
+    configureNoiseFloors();
+}
+
+void PitchDetector::configureNoiseFloors() {
+    // 平滑系数按“每前移 N/4 个样本”定义：窗口越长、帧间重叠越多，相邻帧越相关，须更强的平滑
+    // 才能让最小统计不落到噪声起伏的谷底（8192 点窗口 @512 帧移约 0.95）；不低于配置值
+    auto forWindow = [&](int32_t fftSize) {
+        NoiseFloor::Config config = noiseConfig_;
+        const float exponent = 4.0f * static_cast<float>(hopSize_) / static_cast<float>(fftSize);
+        config.smoothing = std::max(noiseConfig_.smoothing, std::pow(noiseConfig_.smoothing, exponent));
+        return config;
+    };
+    noise_.setConfig(forWindow(FFTWrapper::kFftSize));
+    cqNoise_.setConfig(forWindow(FFTWrapper::kFftSize));
+    longNoise_.setConfig(forWindow(kLongFftSize));
+    shortNoise_.setConfig(forWindow(kShortFftSize));
+}
+
+void PitchDetector::resetNoiseFloors() {
+    noise_.reset();
+    cqNoise_.reset();
+    longNoise_.reset();
+    shortNoise_.reset();
+}
+
+void PitchDetector::reset() {
+    fft_.reset();
+    onset_.reset();
+    resetNoiseFloors();
+    lastResult_ = NoteResult{-1, 0.0f, 0.0f, -1.0f};
+    lastChord_.numNotes = 0;
+    gateStats_ = GateStats{};
+    fusionStats_ = FusionStats{};
+    stageStats_.reset();
+}
+
+void PitchDetector::setOnsetGating(bool enabled) {
+    onsetGating_ = enabled;
+    onset_.reset();
+    lastResult_ = NoteResult{-1, 0.0f, 0.0f, -1.0f};
+    lastChord_.numNotes = 0;
+}
+
+OnsetDetector::Decision PitchDetector::gate(const FFTWrapper::Spectrum& spectrum, int32_t fftSize,
+                                            float sampleRate) {
+    if (!onsetGating_) {
+        ++gateStats_.analyzed;
+        return OnsetDetector::Decision::Analyze;
+    }
+    const auto decision = onset_.update(spectrum.magnitudes, spectrum.numBins, fftSize, sampleRate, spectrum.rms);
+    switch (decision) {
+        case OnsetDetector::Decision::Silent:
+            ++gateStats_.silent;
+            break;
+        case OnsetDetector::Decision::Reuse:
+            ++gateStats_.reused;
+            break;
+        case OnsetDetector::Decision::Onset:
+            ++gateStats_.onsets;
+            ++gateStats_.analyzed;
+            break;
+        case OnsetDetector::Decision::Analyze:
+            ++gateStats_.analyzed;
+            break;
+    }
+    return decision;
+}
+
+bool PitchDetector::gatedResult(OnsetDetector::Decision decision, float volume, NoteResult& out) const {
+    if (decision == OnsetDetector::Decision::Silent) {
+        out = NoteResult{-1, volume, 0.0f, -1.0f};
+        return true;
+    }
+    if (decision == OnsetDetector::Decision::Reuse) {
+        out = lastResult_;
+        out.volume = out.midiNote >= 0 ? std::clamp(volume, 0.0f, 1.0f) : volume;
+        out.onsetLag = -1;
+        return true;
+    }
+    return false;
 }
+
+void PitchDetector::trackNoise(const FFTWrapper::Spectrum& spectrum, float sampleRate) {
+    // 与 [process] 的前端选择一致：常 Q 前端跟踪半音谱，否则跟踪线性谱
+    if (hpsFrontEnd_ == HpsFrontEnd::ConstantQ && sampleRate == cq_.sampleRate()) {
+        cq_.transform(spectrum.re, spectrum.im, cqMagnitudes_);
+        cqNoise_.track(cqMagnitudes_, cq_.numBins());
+    } else {
+        noise_.track(spectrum.magnitudes, spectrum.numBins);
+    }
 }
 
-PitchDetector::PitchDetector() = default;
+PitchDetector::NoteResult PitchDetector::finishAnalysis(NoteResult result, OnsetDetector::Decision decision,
+                                                        const float* window, int32_t windowSize) {
+    result.onsetLag = -1;
+    lastResult_ = result;
+    if (decision == OnsetDetector::Decision::Onset) {
+        result.onsetLag = OnsetDetector::locate(window, windowSize, hopSize_);
+    }
+    return result;
+}
 
 PitchDetector::NoteResult PitchDetector::process(const float* window, int32_t windowSize, float sampleRate) {
     if (window == nullptr || windowSize < FFTWrapper::kFftSize || sampleRate <= 0.0f) {
         return NoteResult{-1, -1.0f, 0.0f, -1.0f};
     }
 
+    // 整条路径构造后不分配：Debug 构建下任何 operator new 在此触发 assert
+    RealtimeScope realtime;
+    StageTimer timer(stageStats_, StageStats::Stage::Detect);
+
     // 1) FFT：得到各 bin 幅度 + 时域 RMS（映射为 volume）
     const auto spectrum = fft_.analyze(window);
+    timer.lap(StageStats::Stage::Fft);
+
+    // 门控：静音 / 延音帧不跑 HPS、YIN
+    const auto decision = gate(spectrum, fft_.fftSize(), sampleRate);
+    timer.skip();
+    NoteResult gated;
+    if (gatedResult(decision, spectrum.rms, gated)) {
+        if (noiseWhitening_) trackNoise(spectrum, sampleRate);
+        return gated;
+    }
 
     // 2) HPS：在钢琴基频范围内搜索谐波积最大的 bin -> 候选基频
     constexpr int32_t kMaxHarmonics = 5;
     constexpr float minHz = 27.5f;
     constexpr float maxHz = 4186.0f;
-    const auto hpsRes = hps_.detect(spectrum.magnitudes, spectrum.numBins, sampleRate,
-                                      kMaxHarmonics, minHz, maxHz);
+    //    白化开启时先减去跟踪到的噪声底（常 Q 前端在半音谱上原地白化）
+    HPS::Result hpsRes;
+    if (hpsFrontEnd_ == HpsFrontEnd::ConstantQ && sampleRate == cq_.sampleRate()) {
+        cq_.transform(spectrum.re, spectrum.im, cqMagnitudes_);
+        const float tonalRatio =
+            noiseWhitening_ ? cqNoise_.whiten(cqMagnitudes_, cqMagnitudes_, cq_.numBins()) : 0.0f;
+        hpsRes = hps_.detectSemitone(cqMagnitudes_, cq_.binFrequencies(), cq_.numBins(), cq_.binsPerSemitone(),
+                                     kMaxHarmonics, minHz, maxHz);
+        if (noiseWhitening_) hpsRes = gateByTonalRatio(hpsRes, tonalRatio);
+    } else if (noiseWhitening_) {
+        const float tonalRatio = noise_.whiten(spectrum.magnitudes, whitened_, spectrum.numBins);
+        hpsRes = gateByTonalRatio(
+            hps_.detect(whitened_, spectrum.numBins, sampleRate, kMaxHarmonics, minHz, maxHz), tonalRatio);
+    } else {
+        hpsRes = hps_.detect(spectrum.magnitudes, spectrum.numBins, sampleRate,
+                             kMaxHarmonics, minHz, maxHz);
+    }
+    timer.lap(StageStats::Stage::Hps);
 
-    // 3) YIN：时域自相关类方法，输出 pitch + 启发式 confidence
-    const auto yinRes = yin_.detect(window, windowSize, sampleRate);
+    // 3) YIN（时域自相关类方法）并融合：高置信 YIN 优先，否则回退 HPS；Cascaded 下先做窄带确认
+    const Candidate chosen =
+        fuseWithYin(yin_, fusionMode_, fusionStats_, hpsRes, -1.0f, window, windowSize, sampleRate, 0.0f, FLT_MAX);
+    timer.lap(StageStats::Stage::Yin);
+    return finishAnalysis(toNoteResult(chosen.frequencyHz, chosen.confidence, spectrum.rms), decision,
+                          window, windowSize);
+}
 
-    // 4) 融合：高置信 YIN 优先，否则回退 HPS
-    float chosenFreq = -1.0f;
-    float chosenConfidence = 0.0f;
-    if (yinRes.confidence > 0.85f && yinRes.pitchHz > 0.0f) {
-        chosenFreq = yinRes.pitchHz;
-        chosenConfidence = yinRes.confidence;
-    } else if (hpsRes.confidence > 0.05f && hpsRes.frequencyHz > 0.0f) {
-        chosenFreq = hpsRes.frequencyHz;
-        chosenConfidence = hpsRes.confidence;
+PitchDetector::NoteResult PitchDetector::toNoteResult(float frequencyHz, float confidence, float volume) const {
+    if (frequencyHz <= 0.0f) {
+        return NoteResult{-1, volume, 0.0f, -1.0f};
     }
 
-    if (chosenFreq <= 0.0f) {
-        return NoteResult{-1, spectrum.rms, 0.0f, -1.0f};
+    // 按调律表的逐键分界查找（二分），越出钢琴范围为 -1
+    const TuningTable::Lookup key = tuning_.lookup(frequencyHz);
+    if (key.midiNote < 0) {
+        return NoteResult{-1, volume, 0.0f, frequencyHz};
     }
 
-    const int32_t midi = freqToMidi(chosenFreq);
-    if (midi < 0) {
-        return NoteResult{-1, spectrum.rms, 0.0f, chosenFreq};
+    return NoteResult{key.midiNote, std::clamp(volume, 0.0f, 1.0f), std::clamp(confidence, 0.0f, 1.0f), frequencyHz,
+                      key.cents};
+}
+
+PitchDetector::NoteResult PitchDetector::processMultiResolution(const float* window, int32_t windowSize,
+                                                               float sampleRate) {
+    if (window == nullptr || windowSize < kLongFftSize || sampleRate <= 0.0f) {
+        return NoteResult{-1, -1.0f, 0.0f, -1.0f};
     }
 
-    const float confidence = std::clamp(chosenConfidence, 0.0f, 1.0f);
-    return NoteResult{midi, std::clamp(spectrum.rms, 0.0f, 1.0f), confidence, chosenFreq};
+    RealtimeScope realtime;
+    StageTimer timer(stageStats_, StageStats::Stage::Detect);
+
+    constexpr int32_t kMaxHarmonics = 5;
+    constexpr float minHz = 27.5f;
+    constexpr float maxHz = 4186.0f;
+    const float* end = window + windowSize;
+
+    // --- 1) 高音区短窗先算：门控也用它判决（对起音最敏感），静音 / 延音帧连长窗 FFT 一起省掉 ---
+    const auto shortSpectrum = shortFft_.analyze(end - kShortFftSize);
+    timer.lap(StageStats::Stage::Fft);
+    const auto decision = gate(shortSpectrum, kShortFftSize, sampleRate);
+    timer.skip();
+    NoteResult gated;
+    if (gatedResult(decision, shortSpectrum.rms, gated)) {
+        // 短窗噪声底照常跟踪；长窗谱本帧未算，长窗噪声底只在完整分析的帧上前进
+        if (noiseWhitening_) shortNoise_.track(shortSpectrum.magnitudes, shortSpectrum.numBins);
+        return gated;
+    }
+
+    // --- 2) 低音区：8192 点 FFT + HPS，YIN 用最新 2048 点（tau 覆盖到 A0）---
+    const auto longSpectrum = longFft_.analyze(end - kLongFftSize);
+    timer.lap(StageStats::Stage::Fft);
+    const float* longMagnitudes = longSpectrum.magnitudes;
+    const float* shortMagnitudes = shortSpectrum.magnitudes;
+    float longTonal = 0.0f;
+    float shortTonal = 0.0f;
+    if (noiseWhitening_) {
+        longTonal = longNoise_.whiten(longMagnitudes, whitened_, longSpectrum.numBins);
+        shortTonal = shortNoise_.whiten(shortMagnitudes, shortWhitened_, shortSpectrum.numBins);
+        longMagnitudes = whitened_;
+        shortMagnitudes = shortWhitened_;
+    }
+    auto bassHps = hps_.detect(longMagnitudes, longSpectrum.numBins, sampleRate,
+                               kMaxHarmonics, minHz, kSplitHz);
+    if (noiseWhitening_) bassHps = gateByTonalRatio(bassHps, longTonal);
+    timer.lap(StageStats::Stage::Hps);
+    const Candidate bass = fuseWithYin(yin_, fusionMode_, fusionStats_, bassHps, -1.0f, end - FFTWrapper::kFftSize,
+                                       FFTWrapper::kFftSize, sampleRate, minHz, kSplitHz);
+    timer.lap(StageStats::Stage::Yin);
+
+    // --- 3) 高音区：只看最新 1024 点；低音路的基频作为级联融合的候选之一（低音帧上高音路的 YIN 由它确认、拒绝）---
+    auto trebleHps = hps_.detect(shortMagnitudes, shortSpectrum.numBins, sampleRate,
+                                 kMaxHarmonics, kSplitHz, maxHz);
+    if (noiseWhitening_) trebleHps = gateByTonalRatio(trebleHps, shortTonal);
+    timer.lap(StageStats::Stage::Hps);
+    const Candidate treble = fuseWithYin(yin_, fusionMode_, fusionStats_, trebleHps, bass.frequencyHz,
+                                         end - kShortFftSize, kShortFftSize, sampleRate, kSplitHz, maxHz);
+    timer.lap(StageStats::Stage::Yin);
+
+    // --- 4) 合并：在同一张 8192 点谱上比较两路基频处的能量 ---
+    Candidate chosen = bass.frequencyHz > 0.0f ? bass : treble;
+    if (bass.frequencyHz > 0.0f && treble.frequencyHz > 0.0f) {
+        const float bassPeak = peakNear(longSpectrum, bass.frequencyHz, sampleRate);
+        const float treblePeak = peakNear(longSpectrum, treble.frequencyHz, sampleRate);
+        if (bassPeak < 0.1f * treblePeak) {
+            chosen = treble;
+        } else if (!isHarmonicOf(treble.frequencyHz, bass.frequencyHz) && treblePeak > bassPeak) {
+            chosen = treble;
+        }
+    }
+
+    // 音量取短窗 RMS，随起音变化最快
+    return finishAnalysis(toNoteResult(chosen.frequencyHz, chosen.confidence, shortSpectrum.rms), decision,
+                          window, windowSize);
+}
+
+PitchDetector::ChordResult PitchDetector::processPolyphonic(const float* window, int32_t windowSize,
+                                                           float sampleRate) {
+    ChordResult chord;
+    chord.numNotes = 0;
+    chord.volume = -1.0f;
+    chord.onsetLag = -1;
+    if (window == nullptr || windowSize < FFTWrapper::kFftSize || sampleRate <= 0.0f) {
+        return chord;
+    }
+
+    RealtimeScope realtime;
+    StageTimer timer(stageStats_, StageStats::Stage::Detect);
+
+    // 1) FFT：与单音路径共用
+    const auto spectrum = fft_.analyze(window);
+    timer.lap(StageStats::Stage::Fft);
+    chord.volume = std::clamp(spectrum.rms, 0.0f, 1.0f);
+
+    // 门控：静音无音；延音复用上次的和弦，各音音量按整窗音量变化等比缩放
+    const auto decision = gate(spectrum, fft_.fftSize(), sampleRate);
+    timer.skip();
+    if (decision == OnsetDetector::Decision::Silent) {
+        lastChord_.numNotes = 0;
+        return chord;
+    }
+    if (decision == OnsetDetector::Decision::Reuse) {
+        const float ratio = lastChord_.volume > 0.0f ? chord.volume / lastChord_.volume : 1.0f;
+        chord.numNotes = lastChord_.numNotes;
+        for (int32_t i = 0; i < chord.numNotes; ++i) {
+            chord.notes[i] = lastChord_.notes[i];
+            chord.notes[i].volume = std::clamp(lastChord_.notes[i].volume * ratio, 0.0f, 1.0f);
+        }
+        return chord;
+    }
+
+    // 2) 迭代谐波相减
+    poly_.prepare(FFTWrapper::kFftSize, sampleRate);
+    PolyphonicDetector::Note notes[PolyphonicDetector::kMaxNotes];
+    const int32_t count = poly_.detect(spectrum.magnitudes, spectrum.numBins, notes);
+    timer.lap(StageStats::Stage::Polyphonic);
+
+    for (int32_t i = 0; i < count; ++i) {
+        NoteResult& out = chord.notes[chord.numNotes++];
+        out.midiNote = notes[i].midiNote;
+        out.volume = notes[i].volume;
+        out.confidence = notes[i].confidence;
+        out.frequencyHz = notes[i].frequencyHz;
+        out.cents = tuning_.centsFrom(out.midiNote, out.frequencyHz);
+    }
+    lastChord_ = chord;
+    if (decision == OnsetDetector::Decision::Onset) {
+        chord.onsetLag = OnsetDetector::locate(window, windowSize, hopSize_);
+    }
+    return chord;
 }
@@ -2,8 +2,14 @@
 
 #include <cstdint>
 
+#include "dsp/ConstantQ.h"
 #include "dsp/FFTWrapper.h"
 #include "dsp/HPS.h"
+#include "dsp/NoiseFloor.h"
+#include "dsp/OnsetDetector.h"
+#include "dsp/PolyphonicDetector.h"
+#include "dsp/StageStats.h"
+#include "dsp/TuningTable.h"
 #include "dsp/YINWrapper.h"
 
 /**
@@ -14,6 +20,50 @@
  * - YIN 可信度 > 0.85 且频率有效 -> 采用 YIN 基频
  * - 否则若 HPS 有足够置信度 -> 采用 HPS 基频
  * - 否则本帧视为无效（midi=-1），由 [AudioEngine] 决定是否回调
+ *
+ * 融合方式（[FusionMode]，默认 Cascaded）：Parallel 每帧都跑 HPS 与全范围 YIN 再按上面的规则取舍；
+ * Cascaded 先跑便宜的 HPS，再只在候选 f 及其上下八度附近（tau = sr / f ±[kNarrowYinTolerance]）
+ * 跑窄带 YIN（[YINWrapper::detectNear]），谷值过 YIN 的可信门即提前结束并采用窄带 YIN 的细化频率；
+ * 两处都未确认（或 HPS 无候选）时才跑全范围 YIN，按上面的规则融合。各路执行次数见 [fusionStats]。
+ *
+ * HPS 前端（[HpsFrontEnd]）：Linear 在线性 FFT 幅度谱上做 HPS（默认）；ConstantQ 先经 [ConstantQ]
+ * 稀疏核映射到 1/3 半音 bin，再做半音域 HPS，bin 中心对齐琴键、不受 23.4 Hz 线性网格量化。
+ * 核按 [prepare] 的采样率预计算（默认 48 kHz），调用时采样率不符则自动回退 Linear。
+ *
+ * 噪声底白化（[setNoiseWhitening]，默认开启）：HPS 之前用 [NoiseFloor] 逐 bin 跟踪稳态噪声底并谱减
+ * （线性谱、常 Q 谱、多分辨率长 / 短窗各自跟踪），HPS 的可信度改为“高出噪声底的幅度占比”，
+ * 占比不足即不采用 HPS。归一化谐波积在有音帧上通常远小于 0.05 的门限，白化后 HPS 才真正成为 YIN 的后备；
+ * 工频嗡声等稳态谱线被当作噪声底减去，多分辨率长窗不再把它们报成低音。起音门控、多音检测仍用原始谱。
+ *
+ * 采样率与帧移（[prepare]）：设备原生采样率（如 44.1 kHz）与帧移由 [AudioEngine] 在开流后传入，
+ * 一次性重建依赖它们的表（常 Q 核、多音谐波表、起音门控的窗口帧数与起音搜索长度）；
+ * FFT 点数与 Hann 窗与采样率无关，HPS / YIN 的搜索范围每帧按传入的采样率换算（开销可忽略）。
+ *
+ * 多分辨率模式（[processMultiResolution]）：输入更长的窗口（[kLongFftSize] = 8192），
+ * - 低音区：整窗 8192 点 FFT（bin 宽 5.9 Hz）上做 HPS，配合最新 2048 点上的 YIN，只接受 < [kSplitHz] 的基频；
+ * - 高音区：只取最新 [kShortFftSize] = 1024 点做 FFT + HPS 与 YIN，只接受 >= [kSplitHz] 的基频，
+ *   窗口短、对起音反应快；
+ * - 每帧合并两路：高音候选是低音候选的整数倍泛音时取低音；低音候选基频处能量不足（低于高音候选的 1/10，
+ *   多为虚假的次谐波）时取高音；其余取 8192 点谱上基频能量较大者。
+ *
+ * 多音模式（[processPolyphonic]）：同一 FFT 幅度谱交给 [PolyphonicDetector] 做迭代谐波相减，
+ * 一帧输出最多 [PolyphonicDetector::kMaxNotes] 个音；不跑 HPS/YIN。
+ *
+ * 起音门控（[setOnsetGating]，默认关闭）：每帧 FFT 后先经 [OnsetDetector] 判决，
+ * 静音帧直接输出无效结果，稳定延音帧复用上一次分析结果（只刷新音量），只有起音、起音后窗口填满前
+ * 以及定期刷新的帧才跑 HPS/YIN（多音模式下为 [PolyphonicDetector]）。起音帧在结果中带
+ * [NoteResult::onsetLag]（起音点距窗口末端的样本数）。计数见 [gateStats]。
+ * 跳过分析的帧仍用本帧谱更新噪声底（[NoiseFloor::track]），静音段的噪声照常计入；
+ * 多分辨率长窗的谱在这些帧上不计算，其噪声底只随完整分析的帧前进。
+ *
+ * 调律（[setTuning]，默认 440 Hz 十二平均律）：基频 -> MIDI 按 [TuningTable] 的逐键分界二分查找，
+ * 结果带相对该键中心的音分偏差 [NoteResult::cents]；442 Hz 或拉伸调律的琴用校准得到的表，半音边界随之移动。
+ * 常 Q bin 中心与多音模式的琴键模板同样按表取样（[ConstantQ]、[PolyphonicDetector::setTuning]）。
+ *
+ * 逐级耗时（[stageStats]）：每帧把 FFT、HPS（含白化）、YIN、多音相减与整帧检测的耗时记入 [StageStats] 直方图，
+ * 任意线程可读快照；编译时未启用 PIANO_NOTE_STAGE_STATS 则不计时。
+ *
+ * 内存：各子模块的缓冲均在构造时分配，[process] 不做堆分配（由 [RealtimeScope] 在 Debug 构建下守护）。
  */
 class PitchDetector {
 public:
@@ -22,20 +72,186 @@ public:
         float volume;         ///< 0..1，来自 FFT 侧 RMS 映射
         float confidence;     ///< 0..1，融合路径的可信度
         float frequencyHz;    ///< 选用算法的基频；midi<0 时可能仍带频率（越界裁剪场景）
+        float cents = 0.0f;   ///< 相对 [setTuning] 调律表中该键中心频率的偏差（音分）；无效帧为 0
+        int32_t onsetLag = -1; ///< 起音门控：本帧检出起音时为起音点距窗口末端的样本数，否则 -1
+    };
+
+    /** 多音模式一帧结果；notes[0..numNotes) 按显著度降序 */
+    struct ChordResult {
+        int32_t numNotes;
+        NoteResult notes[PolyphonicDetector::kMaxNotes];
+        float volume;         ///< 整窗音量（同 [NoteResult::volume]）
+        int32_t onsetLag;     ///< 同 [NoteResult::onsetLag]
+    };
+
+    /** 起音门控计数（自构造或 [reset] 起） */
+    struct GateStats {
+        uint64_t analyzed; ///< 跑了完整检测的帧（含起音帧）
+        uint64_t reused;   ///< 复用上一帧结果的延音帧
+        uint64_t silent;   ///< 低于音量门的帧
+        uint64_t onsets;   ///< 检出的起音数
     };
 
+    /** 融合各路执行计数（自构造或 [reset] 起）；多分辨率模式下低音、高音两路各计一次 */
+    struct FusionStats {
+        uint64_t frames;    ///< 做了融合的帧（= 跑了 HPS 的帧）
+        uint64_t narrowYin; ///< 跑了窄带 YIN 的帧（仅 Cascaded）
+        uint64_t confirmed; ///< 窄带 YIN 确认候选、提前结束的帧（仅 Cascaded）
+        uint64_t fullYin;   ///< 跑了全范围 YIN 的帧
+    };
+
+    enum class HpsFrontEnd {
+        Linear,
+        ConstantQ,
+    };
+
+    enum class FusionMode {
+        Parallel,
+        Cascaded,
+    };
+
+    /** 常 Q 前端的每半音 bin 数 */
+    static constexpr int32_t kCqBinsPerSemitone = 3;
+    /** 构造时默认的采样率与帧移；实际值由 [prepare] 设置 */
+    static constexpr float kDefaultSampleRate = 48000.0f;
+    static constexpr int32_t kDefaultHopSize = 512;
+
+    /** 多分辨率：低音长窗、高音短窗的点数与分界频率 */
+    static constexpr int32_t kLongFftSize = 8192;
+    static constexpr int32_t kShortFftSize = 1024;
+    static constexpr float kSplitHz = 523.25f; ///< C5
+
+    /** 级联融合：窄带 YIN 的相对邻域宽度（±3%，约 ±50 音分，覆盖 HPS 的残余误差与非谐性） */
+    static constexpr float kNarrowYinTolerance = 0.03f;
+
     PitchDetector();
 
+    /**
+     * 按采样率与帧移重建派生表；参数未变时直接返回。常 Q 核重建会分配内存，须在音频线程之外调用。
+     * @param hopSize 相邻两次调用之间窗口前移的样本数，1..[FFTWrapper::kFftSize]
+     */
+    void prepare(float sampleRate, int32_t hopSize);
+    float sampleRate() const { return sampleRate_; }
+    int32_t hopSize() const { return hopSize_; }
+
     /**
      * 对固定长度窗口做一帧识别。
      * @param window 时域样本，长度至少 [FFTWrapper::kFftSize]（2048）
      * @param windowSize 实际长度，应 >= 2048
-     * @param sampleRate 采样率 Hz，须与 Oboe 一致（当前 48000）
+     * @param sampleRate 采样率 Hz，须与 [prepare] 一致
      */
     NoteResult process(const float* window, int32_t windowSize, float sampleRate);
 
+    /**
+     * 多分辨率一帧识别（单音）；窗口末端为最新样本。
+     * @param window 时域样本，长度至少 [kLongFftSize]；只用末尾 [kLongFftSize] 个
+     */
+    NoteResult processMultiResolution(const float* window, int32_t windowSize, float sampleRate);
+
+    /**
+     * 多音模式一帧识别；参数约束同 [process]。
+     * 采样率变化时重建谐波表（定长数组内改写，不分配）。
+     */
+    ChordResult processPolyphonic(const float* window, int32_t windowSize, float sampleRate);
+
+    void setPolyphonicConfig(const PolyphonicDetector::Config& config) { poly_.setConfig(config); }
+
+    /**
+     * 切换主路径 FFT 策略（Full / Incremental），用于 A/B 对比；Incremental 要求每次调用窗口恰好前移
+     * [FFTWrapper::blockSize]（512），帧移不符时保持 Full。
+     * 首次切到 Incremental 时分配块缓存，须在音频线程之外调用。多分辨率的长/短窗始终为 Full。
+     */
+    void setFftStrategy(FFTWrapper::Strategy strategy);
+
+    /** 切换 HPS 前端；核在构造时已生成，切换不分配 */
+    void setHpsFrontEnd(HpsFrontEnd frontEnd) { hpsFrontEnd_ = frontEnd; }
+    HpsFrontEnd hpsFrontEnd() const { return hpsFrontEnd_; }
+
+    /** 切换融合方式；不分配，可随时切换 */
+    void setFusionMode(FusionMode mode) { fusionMode_ = mode; }
+    FusionMode fusionMode() const { return fusionMode_; }
+    const FusionStats& fusionStats() const { return fusionStats_; }
+
+    /** 开关噪声底白化（默认开启，见 [NoiseFloor]）；切换时清空噪声底历史 */
+    void setNoiseWhitening(bool enabled);
+    bool noiseWhitening() const { return noiseWhitening_; }
+    void setNoiseFloorConfig(const NoiseFloor::Config& config);
+
+    /** 开关起音门控；切换时清空门控历史 */
+    void setOnsetGating(bool enabled);
+    bool onsetGating() const { return onsetGating_; }
+    void setOnsetConfig(const OnsetDetector::Config& config) { onset_.setConfig(config); }
+    const GateStats& gateStats() const { return gateStats_; }
+
+    /**
+     * 替换调律表，并按它重建常 Q 核与多音谐波表（常 Q 核重建会分配）；须在检测线程之外、两次处理之间调用
+     */
+    void setTuning(const TuningTable& tuning);
+    const TuningTable& tuning() const { return tuning_; }
+
+    /** 逐级耗时直方图（Fft / Hps / Yin / Polyphonic / Detect）；可在其它线程读取快照 */
+    const StageStats& stageStats() const { return stageStats_; }
+
+    /** 输入流重新开始时调用，清空跨帧状态（FFT 块缓存、门控历史与计数、融合计数、耗时直方图、噪声底） */
+    void reset();
+
+    /** 运行中跳过 / 丢弃了若干帧（Coalesce、DropOldest）：只清 Incremental 块缓存，门控历史与计数保留 */
+    void skipFrames() { fft_.reset(); }
+
 private:
+    /** 由选定基频按 [tuning_] 组装结果：无效或越出钢琴范围时 midi = -1 */
+    NoteResult toNoteResult(float frequencyHz, float confidence, float volume) const;
+    /** 清空各噪声底跟踪器 */
+    void resetNoiseFloors();
+    /** 按 [noiseConfig_] 与各窗口长度 / 帧移配置噪声底跟踪器 */
+    void configureNoiseFloors();
+    /** 门控判决并计数；未开启门控时恒为 Analyze */
+    OnsetDetector::Decision gate(const FFTWrapper::Spectrum& spectrum, int32_t fftSize, float sampleRate);
+    /** 门控下的快速路径：静音给无效结果，延音复用 [lastResult_] 并刷新音量；须完整分析时返回 false */
+    bool gatedResult(OnsetDetector::Decision decision, float volume, NoteResult& out) const;
+    /** 门控跳过分析的帧上只更新当前前端（线性 / 常 Q）的噪声底，不白化 */
+    void trackNoise(const FFTWrapper::Spectrum& spectrum, float sampleRate);
+    /** 记录完整分析的结果；起音帧附上起音位置 */
+    NoteResult finishAnalysis(NoteResult result, OnsetDetector::Decision decision, const float* window,
+                              int32_t windowSize);
+
     FFTWrapper fft_;
-    HPS hps_;
+    FFTWrapper longFft_{kLongFftSize};
+    FFTWrapper shortFft_{kShortFftSize};
+    HPS hps_{kLongFftSize / 2};
     YINWrapper yin_;
+    PolyphonicDetector poly_;
+
+    float sampleRate_{kDefaultSampleRate};
+    int32_t hopSize_{kDefaultHopSize};
+    /** 最近一次 [setFftStrategy] 请求的策略（帧移变化时据此恢复） */
+    FFTWrapper::Strategy requestedStrategy_{FFTWrapper::Strategy::Full};
+
+    HpsFrontEnd hpsFrontEnd_{HpsFrontEnd::Linear};
+    FusionMode fusionMode_{FusionMode::Cascaded};
+    FusionStats fusionStats_{};
+    ConstantQ cq_{FFTWrapper::kFftSize, kDefaultSampleRate, kCqBinsPerSemitone};
+    float cqMagnitudes_[ConstantQ::kDefaultSemitones * kCqBinsPerSemitone];
+
+    // --- 噪声底白化：每种谱（线性 2048 / 常 Q / 长窗 / 短窗）各自跟踪 ---
+    bool noiseWhitening_{true};
+    NoiseFloor::Config noiseConfig_;
+    NoiseFloor noise_{FFTWrapper::kFftSize / 2};
+    NoiseFloor cqNoise_{ConstantQ::kDefaultSemitones * kCqBinsPerSemitone};
+    NoiseFloor longNoise_{kLongFftSize / 2};
+    NoiseFloor shortNoise_{kShortFftSize / 2};
+    /** 线性谱白化结果（长窗最长） */
+    float whitened_[kLongFftSize / 2];
+    float shortWhitened_[kShortFftSize / 2];
+
+    // --- 起音门控 ---
+    bool onsetGating_{false};
+    OnsetDetector onset_{PolyphonicDetector::kMaxBins};
+    NoteResult lastResult_{-1, 0.0f, 0.0f, -1.0f};
+    ChordResult lastChord_;
+    GateStats gateStats_{};
+
+    TuningTable tuning_;
+
+    StageStats stageStats_;
 };
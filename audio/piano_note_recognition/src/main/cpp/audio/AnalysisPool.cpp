@@ -0,0 +1,97 @@
+#include "AnalysisPool.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace {
+/** 兜底唤醒周期：与 [AudioEngine] 单独分析线程相同，notify 丢失时只多等约半个 hop */
+constexpr auto kPoolWaitTimeout = std::chrono::milliseconds(5);
+}
+
+AnalysisPool::AnalysisPool(int32_t numThreads) {
+    if (numThreads <= 0) {
+        numThreads = std::max<int32_t>(static_cast<int32_t>(std::thread::hardware_concurrency()) - 1, 1);
+    }
+    threads_.reserve(static_cast<size_t>(numThreads));
+    for (int32_t i = 0; i < numThreads; ++i) {
+        threads_.emplace_back([this] { threadLoop(); });
+    }
+}
+
+AnalysisPool::~AnalysisPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_.store(false);
+    }
+    cv_.notify_all();
+    for (auto& t : threads_) t.join();
+}
+
+int32_t AnalysisPool::attach(DrainFn drain, void* user) {
+    if (drain == nullptr) return -1;
+    std::lock_guard<std::mutex> lock(slotMutex_);
+    for (int32_t i = 0; i < kMaxClients; ++i) {
+        Slot& slot = slots_[i];
+        if (slot.drain.load() != nullptr) continue;
+        slot.user.store(user);
+        slot.state.store(0);
+        // drain 最后写入：线程认领后先读 drain 再读 user
+        slot.drain.store(drain);
+        return i;
+    }
+    return -1;
+}
+
+void AnalysisPool::detach(int32_t slot) {
+    if (slot < 0 || slot >= kMaxClients) return;
+    Slot& s = slots_[slot];
+    std::unique_lock<std::mutex> lock(slotMutex_);
+    s.drain.store(nullptr);
+    s.state.fetch_and(~kPending);
+    // 正在处理的线程释放 Running 后若看到 drain 已清空，会持 slotMutex_ 通知
+    idleCv_.wait(lock, [&s] { return (s.state.load() & kRunning) == 0; });
+    s.user.store(nullptr);
+}
+
+void AnalysisPool::signal(int32_t slot) {
+    if (slot < 0 || slot >= kMaxClients) return;
+    // 已有 Pending 时无需再唤醒；Running 中置 Pending 由处理线程或下一轮扫描认领
+    const uint32_t prev = slots_[slot].state.fetch_or(kPending);
+    if ((prev & kPending) == 0) cv_.notify_one();
+}
+
+bool AnalysisPool::hasPending() const {
+    for (const Slot& slot : slots_) {
+        if (slot.state.load(std::memory_order_relaxed) == kPending) return true;
+    }
+    return false;
+}
+
+bool AnalysisPool::runOne() {
+    const uint32_t start = cursor_.fetch_add(1, std::memory_order_relaxed);
+    for (int32_t n = 0; n < kMaxClients; ++n) {
+        Slot& slot = slots_[(start + static_cast<uint32_t>(n)) % kMaxClients];
+        uint32_t expected = kPending;
+        if (!slot.state.compare_exchange_strong(expected, kRunning)) continue;
+
+        const DrainFn drain = slot.drain.load();
+        if (drain != nullptr) drain(slot.user.load());
+
+        slot.state.fetch_and(~kRunning);
+        if (slot.drain.load() == nullptr) {
+            // detach 正在等待本次处理结束
+            std::lock_guard<std::mutex> lock(slotMutex_);
+            idleCv_.notify_all();
+        }
+        return true;
+    }
+    return false;
+}
+
+void AnalysisPool::threadLoop() {
+    while (running_.load()) {
+        if (runOne()) continue;
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait_for(lock, kPoolWaitTimeout, [this] { return hasPending() || !running_.load(); });
+    }
+}
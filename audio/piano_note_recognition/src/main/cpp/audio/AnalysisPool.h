@@ -0,0 +1,79 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @class AnalysisPool
+ * @brief 多个 [AudioEngine] 共享的定长分析线程池：每个引擎的积压 hop 由任一空闲线程处理，同一引擎同一时刻只在一个线程上
+ *
+ * 调度：
+ * - 客户端（引擎）以 [attach] 占用一个槽位，得到槽号；音频线程入队后调用 [signal]，只做一次原子 fetch_or，
+ *   必要时不持锁 notify，不阻塞、不分配。
+ * - 槽位状态为两个位：kPending（有待处理数据）与 kRunning（某线程正在处理）。线程以 CAS 从 Pending 认领为 Running
+ *   （同时清除 Pending），处理完清除 Running；处理期间新到的 [signal] 重新置 Pending，由下一轮扫描认领。
+ *   因此一个引擎的滑窗与 [PitchDetector] 始终只被一个线程访问，前后两个线程之间由认领 / 释放的原子操作建立先后关系。
+ * - 线程从轮转的起点扫描槽位，多个引擎同时积压时轮流处理，避免总是偏向低槽号。
+ * - 与单引擎 Pipelined 模式相同，notify 丢失时由等待超时兜底。
+ *
+ * 生命周期：[attach]/[detach] 在 JNI 线程调用；[detach] 等待正在进行的处理结束后返回，之后不再调用该客户端。
+ * 线程在构造时创建，析构时 join。
+ */
+class AnalysisPool {
+public:
+    /** 处理入口：在池线程上调用，须处理完当前积压后返回 */
+    using DrainFn = void (*)(void* user);
+
+    /** 最大同时挂接的客户端数 */
+    static constexpr int32_t kMaxClients = 16;
+
+    /** @param numThreads 线程数；<=0 时取硬件并发数 - 1（至少 1） */
+    explicit AnalysisPool(int32_t numThreads = 0);
+    ~AnalysisPool();
+
+    AnalysisPool(const AnalysisPool&) = delete;
+    AnalysisPool& operator=(const AnalysisPool&) = delete;
+
+    /** 占用一个槽位；槽位已满返回 -1 */
+    int32_t attach(DrainFn drain, void* user);
+
+    /** 释放槽位，等待正在进行的 drain 返回；之后该客户端不会再被调用 */
+    void detach(int32_t slot);
+
+    /** 标记槽位有待处理数据并唤醒一个线程；可在音频线程调用（wait-free） */
+    void signal(int32_t slot);
+
+    int32_t numThreads() const { return static_cast<int32_t>(threads_.size()); }
+
+private:
+    static constexpr uint32_t kPending = 1u;
+    static constexpr uint32_t kRunning = 2u;
+
+    struct Slot {
+        std::atomic<DrainFn> drain{nullptr};
+        std::atomic<void*> user{nullptr};
+        std::atomic<uint32_t> state{0};
+    };
+
+    void threadLoop();
+    /** 认领并处理一个待处理槽位；没有可认领的返回 false */
+    bool runOne();
+    /** 是否有待处理且未被认领的槽位 */
+    bool hasPending() const;
+
+    Slot slots_[kMaxClients];
+    /** 下一轮扫描的起始槽位 */
+    std::atomic<uint32_t> cursor_{0};
+
+    std::vector<std::thread> threads_;
+    std::atomic<bool> running_{true};
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    /** [attach]/[detach] 互斥；[detach] 在其上等待 drain 结束 */
+    std::mutex slotMutex_;
+    std::condition_variable idleCv_;
+};
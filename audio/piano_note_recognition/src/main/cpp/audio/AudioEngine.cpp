@@ -1,36 +1,22 @@
 #include "AudioEngine.h"
 
+#include <algorithm>
+#include <chrono>
 #include <cstring>
-
-#include <oboe/Oboe.h>
+#include <thread>
 
 #include "../PitchDetector.h"
+#include "../dsp/AllocationGuard.h"
+#include "../dsp/TuningCalibrator.h"
+#include "AnalysisPool.h"
+#include "InputSource.h"
 
-/**
- * Oboe 音频数据就绪回调：把 float 缓冲交给 [AudioEngine::processAudio]。
- */
-class AudioEngine::CallbackImpl final : public oboe::AudioStreamCallback {
-public:
-    explicit CallbackImpl(AudioEngine& engine) : engine_(engine) {}
-
-    oboe::DataCallbackResult onAudioReady(oboe::AudioStream* /*stream*/,
-                                          void* audioData,
-                                          int32_t numFrames) override {
-        // 已 stop 时尽快返回，避免在 teardown 过程中仍处理数据
-        if (!engine_.running_.load()) {
-            return oboe::DataCallbackResult::Continue;
-        }
-        auto* data = static_cast<const float*>(audioData);
-        engine_.processAudio(data, numFrames);
-        return oboe::DataCallbackResult::Continue;
-    }
-
-private:
-    AudioEngine& engine_;
-};
+namespace {
+/** 分析线程的兜底唤醒周期：即使 notify 丢失也只多等约一个 hop（512 / 48k ≈ 10.7ms） */
+constexpr auto kWorkerWaitTimeout = std::chrono::milliseconds(5);
+}
 
 AudioEngine::AudioEngine() {
-    callback_ = new CallbackImpl(*this);
     pitchDetector_ = new PitchDetector();
     window_.resize(windowSize_);
 }
@@ -39,112 +25,508 @@ AudioEngine::~AudioEngine() {
     stop();
     delete pitchDetector_;
     pitchDetector_ = nullptr;
-    delete callback_;
-    callback_ = nullptr;
 }
 
-bool AudioEngine::start(NoteCallback cb) {
-    std::lock_guard<std::mutex> lock(cbMutex_);
+bool AudioEngine::start(const Callbacks& callbacks) {
+    std::lock_guard<std::mutex> lock(controlMutex_);
     // 与 JNI 层“重复 start 先停旧”配合：正常情况下不应在 running 时再 start
-    if (running_.load()) return false;
+    if (running_.load() || source_ == nullptr) return false;
 
-    noteCb_ = std::move(cb);
-    windowFilled_ = 0;
-    if (!window_.empty()) {
-        std::fill(window_.begin(), window_.end(), 0.0f);
-    }
-
-    // --- Oboe 输入流配置：低延迟、单声道 float、48k、每次回调 hopSize_ 帧 ---
-    oboe::AudioStreamBuilder builder;
-    builder.setDirection(oboe::Direction::Input);
-    builder.setSharingMode(oboe::SharingMode::Shared);
-    builder.setPerformanceMode(oboe::PerformanceMode::LowLatency);
-    builder.setFormat(oboe::AudioFormat::Float);
-    builder.setChannelCount(1);
-    builder.setSampleRate(sampleRate_);
-    builder.setFramesPerCallback(hopSize_);
-    builder.setCallback(callback_);
-
-    builder.setUsage(oboe::Usage::Game);
-    builder.setContentType(oboe::ContentType::Music);
-
-    oboe::Result result = builder.openStream(&stream_);
-    if (result != oboe::Result::OK || stream_ == nullptr) {
-        stream_ = nullptr;
+    // --- 打开输入源：未指定时采样率取设备原生值，回调帧数不固定（按 burst）---
+    InputSource::Request request;
+    request.sampleRate = requestedSampleRate_;
+    request.deviceId = inputDeviceId_;
+    InputSource::Format format{0, 0};
+    if (!source_->open(request, &AudioEngine::onInput, this, format) || format.sampleRate <= 0) {
+        source_->close();
         running_.store(false);
         return false;
     }
 
-    result = stream_->requestStart();
-    if (result != oboe::Result::OK) {
-        oboe::Result closeResult = stream_->close();
-        (void)closeResult;
-        stream_ = nullptr;
+    // --- 按实际采样率 / 帧移重建派生表（源 start 前不会回调，可以分配）---
+    sampleRate_ = format.sampleRate;
+    hopSize_ = requestedHopSize_ > 0 ? std::min(requestedHopSize_, windowSize_)
+                                     : defaultHopSize(sampleRate_, format.framesPerBurst);
+    pitchDetector_->prepare(static_cast<float>(sampleRate_), hopSize_);
+
+    callbackStorage_ = callbacks;
+    batching_ = callbacks.onEvents != nullptr;
+    NoteEventBatcher::Config batchConfig = batchConfig_;
+    batchConfig.tracking.monophonic = !polyphonic_;
+    batchConfig.tracking.onsetWindowFrames = windowSize_;
+    batcher_.configure(batchConfig, sampleRate_, &AudioEngine::flushEvents, this);
+    window_.clear();
+    hopFilled_ = 0;
+    windowEndFrame_ = 0;
+    pitchDetector_->reset();
+
+    stageStats_.reset();
+    captureEpochNs_.store(0);
+    hardwareTimestamps_.store(false);
+    framesReceived_ = 0;
+    timestampCountdown_ = 0;
+
+    hopQueue_.clear();
+    queueBlock_ = nullptr;
+    queueFill_ = 0;
+    pendingGapFrames_ = 0;
+    pushedHops_.store(0);
+    droppedHops_.store(0);
+    discardedHops_.store(0);
+    coalescedHops_.store(0);
+    // 先起分析线程（或挂上线程池）再启动流，首包即可入队
+    if (mode_ == ProcessingMode::Pipelined && !startWorker()) {
+        source_->close();
         running_.store(false);
         return false;
     }
 
+    // 源启动前发布回调并置 running_：首块数据即被处理（回放源不限速时不丢开头），
+    // 首个结果交付时读者即可看到完整的 [callbackStorage_]
+    callbacks_.store(&callbackStorage_);
     running_.store(true);
+    if (!source_->start()) {
+        running_.store(false);
+        source_->close();
+        stopWorker();
+        callbacks_.store(nullptr);
+        return false;
+    }
     return true;
 }
 
 bool AudioEngine::stop() {
-    std::lock_guard<std::mutex> lock(cbMutex_);
-    if (!running_.load()) return false;
+    {
+        std::lock_guard<std::mutex> lock(controlMutex_);
+        if (!running_.load()) return false;
+
+        running_.store(false);
+        // 返回后源不再回调
+        source_->close();
+    }
+
+    // 回调可能同步回到 JNI / Kotlin 层，join（或等待池线程处理完）与收尾交付都在锁外进行
+    stopWorker();
 
-    running_.store(false);
+    // 流与分析线程均已停止：在调用线程上交付剩余事件
+    if (batching_) {
+        batcher_.finish(windowEndFrame_);
+    }
 
-    if (stream_ != nullptr) {
-        stream_->requestStop();
-        stream_->close();
-        stream_ = nullptr;
+    // 撤下发布后等待宽限期：此后登记的读者只会读到 nullptr，计数归零即没有读者仍持有旧目标。
+    // 只在 JNI 线程上让出等待，音频 / 分析线程从不因此阻塞
+    callbacks_.store(nullptr);
+    while (callbacksInFlight_.load() != 0) {
+        std::this_thread::yield();
     }
 
-    noteCb_ = nullptr;
+    std::lock_guard<std::mutex> lock(controlMutex_);
+    callbackStorage_ = Callbacks{};
+    batching_ = false;
+    return true;
+}
+
+bool AudioEngine::setStreamConfig(int32_t sampleRate, int32_t hopSize) {
+    std::lock_guard<std::mutex> lock(controlMutex_);
+    if (running_.load()) return false;
+    requestedSampleRate_ = std::max(sampleRate, 0);
+    requestedHopSize_ = std::clamp(hopSize, 0, windowSize_);
+    return true;
+}
+
+int32_t AudioEngine::defaultHopSize(int32_t sampleRate, int32_t framesPerBurst) {
+    // 48 kHz 下 512 帧，其它采样率按同一时长换算
+    const int32_t target = std::max<int32_t>(
+        static_cast<int32_t>(sampleRate * static_cast<int64_t>(PitchDetector::kDefaultHopSize) /
+                             static_cast<int64_t>(PitchDetector::kDefaultSampleRate)),
+        1);
+    int32_t hop = target;
+    if (framesPerBurst > 0) {
+        const int32_t bursts = std::max<int32_t>((target + framesPerBurst / 2) / framesPerBurst, 1);
+        hop = bursts * framesPerBurst;
+    }
+    return std::min(hop, windowSize_);
+}
+
+bool AudioEngine::setInputDevice(int32_t deviceId) {
+    std::lock_guard<std::mutex> lock(controlMutex_);
+    if (running_.load()) return false;
+    inputDeviceId_ = std::max(deviceId, 0);
+    return true;
+}
+
+bool AudioEngine::setInputSource(InputSource* source) {
+    std::lock_guard<std::mutex> lock(controlMutex_);
+    if (running_.load()) return false;
+    source_ = source;
+    return true;
+}
+
+bool AudioEngine::setTuning(const TuningTable& tuning) {
+    std::lock_guard<std::mutex> lock(controlMutex_);
+    if (running_.load()) return false;
+    pitchDetector_->setTuning(tuning);
+    return true;
+}
+
+bool AudioEngine::setCalibrator(TuningCalibrator* calibrator) {
+    std::lock_guard<std::mutex> lock(controlMutex_);
+    if (running_.load()) return false;
+    calibrator_ = calibrator;
+    return true;
+}
+
+const TuningTable& AudioEngine::tuning() const {
+    return pitchDetector_->tuning();
+}
+
+bool AudioEngine::setEventBatchConfig(const NoteEventBatcher::Config& config) {
+    std::lock_guard<std::mutex> lock(controlMutex_);
+    if (running_.load()) return false;
+    batchConfig_ = config;
+    return true;
+}
+
+bool AudioEngine::setMultiResolution(bool enabled) {
+    std::lock_guard<std::mutex> lock(controlMutex_);
+    if (running_.load()) return false;
+    multiResolution_ = enabled;
+    window_.resize(enabled ? PitchDetector::kLongFftSize : windowSize_);
+    return true;
+}
+
+bool AudioEngine::setOnsetGating(bool enabled) {
+    std::lock_guard<std::mutex> lock(controlMutex_);
+    if (running_.load()) return false;
+    pitchDetector_->setOnsetGating(enabled);
+    return true;
+}
+
+bool AudioEngine::setNoiseWhitening(bool enabled) {
+    std::lock_guard<std::mutex> lock(controlMutex_);
+    if (running_.load()) return false;
+    pitchDetector_->setNoiseWhitening(enabled);
+    return true;
+}
+
+bool AudioEngine::setPolyphonic(bool enabled, int32_t maxNotes) {
+    std::lock_guard<std::mutex> lock(controlMutex_);
+    if (running_.load()) return false;
+    polyphonic_ = enabled;
+    PolyphonicDetector::Config config;
+    config.maxNotes = maxNotes;
+    pitchDetector_->setPolyphonicConfig(config);
+    return true;
+}
+
+void AudioEngine::flushEvents(void* user, const NoteEvent* events, int32_t count) {
+    auto* engine = static_cast<AudioEngine*>(user);
+    CallbackGuard guard(*engine);
+    const Callbacks* cbs = guard.get();
+    if (cbs != nullptr && cbs->onEvents != nullptr) cbs->onEvents(cbs->user, events, count);
+}
+
+bool AudioEngine::setProcessingMode(ProcessingMode mode, BackPressure backPressure) {
+    std::lock_guard<std::mutex> lock(controlMutex_);
+    if (running_.load()) return false;
+    mode_ = mode;
+    backPressure_ = backPressure;
     return true;
 }
 
+bool AudioEngine::setAnalysisPool(AnalysisPool* pool) {
+    std::lock_guard<std::mutex> lock(controlMutex_);
+    if (running_.load()) return false;
+    pool_ = pool;
+    return true;
+}
+
+AudioEngine::PipelineStats AudioEngine::pipelineStats() const {
+    PipelineStats stats;
+    stats.pushedHops = pushedHops_.load(std::memory_order_relaxed);
+    stats.droppedHops = droppedHops_.load(std::memory_order_relaxed);
+    stats.discardedHops = discardedHops_.load(std::memory_order_relaxed);
+    stats.coalescedHops = coalescedHops_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+AudioEngine::Stats AudioEngine::stats() {
+    Stats out;
+    const StageStats& detector = pitchDetector_->stageStats();
+    for (int32_t i = 0; i < StageStats::kNumStages; ++i) {
+        const auto stage = static_cast<StageStats::Stage>(i);
+        out.stages[i] = stage < StageStats::Stage::AudioCallback ? detector.summary(stage)
+                                                                 : stageStats_.summary(stage);
+    }
+    out.hardwareTimestamps = hardwareTimestamps_.load(std::memory_order_relaxed);
+    out.xRunCount = -1;
+
+    // 与 stop 互斥：源只在持锁时关闭
+    std::lock_guard<std::mutex> lock(controlMutex_);
+    if (running_.load()) out.xRunCount = source_->xRunCount();
+    return out;
+}
+
+void AudioEngine::onInput(void* user, const float* input, int32_t numFrames) {
+    auto* engine = static_cast<AudioEngine*>(user);
+    // 已 stop 时尽快返回，避免在 teardown 过程中仍处理数据
+    if (!engine->running_.load()) return;
+    engine->updateCaptureClock(numFrames);
+    engine->processAudio(input, numFrames);
+}
+
+void AudioEngine::updateCaptureClock(int32_t numFrames) {
+    if (!StageStats::enabled() || numFrames <= 0) return;
+    framesReceived_ += numFrames;
+    const double nsPerFrame = 1e9 / static_cast<double>(sampleRate_);
+
+    if (--timestampCountdown_ <= 0) {
+        timestampCountdown_ = kTimestampIntervalCallbacks;
+        int64_t framePosition = 0;
+        int64_t timeNs = 0;
+        if (source_->captureTimestamp(framePosition, timeNs)) {
+            captureEpochNs_.store(timeNs - static_cast<int64_t>(static_cast<double>(framePosition) * nsPerFrame),
+                                  std::memory_order_relaxed);
+            hardwareTimestamps_.store(true, std::memory_order_relaxed);
+            return;
+        }
+        hardwareTimestamps_.store(false, std::memory_order_relaxed);
+    }
+    if (hardwareTimestamps_.load(std::memory_order_relaxed)) return;
+
+    // 无硬件时间戳：视本次回调的最后一帧为此刻采集
+    captureEpochNs_.store(StageStats::nowNs() - static_cast<int64_t>(static_cast<double>(framesReceived_) * nsPerFrame),
+                          std::memory_order_relaxed);
+}
+
 void AudioEngine::processAudio(const float* input, int32_t numFrames) {
     if (input == nullptr || numFrames <= 0) return;
 
-    // --- 阶段 1：冷启动填满 2048 点窗口 ---
-    const int32_t canCopy = std::min<int32_t>(numFrames, windowSize_ - windowFilled_);
-    if (windowFilled_ < windowSize_) {
-        if (canCopy > 0) {
-            std::memcpy(window_.data() + windowFilled_, input, static_cast<size_t>(canCopy) * sizeof(float));
-            windowFilled_ += canCopy;
-        }
-        if (windowFilled_ < windowSize_) return;
+    // 音频回调线程：Debug 构建下本函数内的堆分配会直接 assert
+    RealtimeScope realtime;
+    StageTimer timer(stageStats_, StageStats::Stage::AudioCallback);
+
+    if (mode_ == ProcessingMode::Pipelined) {
+        enqueueHops(input, numFrames);
+        return;
     }
 
-    // --- 阶段 2：滑窗：左移 n，尾部接入本包最新 n 个采样（n<=512）---
-    const int32_t n = std::min<int32_t>(numFrames, windowSize_);
-    if (n <= 0) return;
+    feed(input, numFrames, true);
+}
+
+int32_t AudioEngine::feed(const float* input, int32_t numFrames, bool dispatch) {
+    // 回调帧数与帧移无关：逐段补满当前 hop，每个完整 hop 检测一次，不丢样本
+    int32_t completed = 0;
+    while (numFrames > 0) {
+        const int32_t n = std::min(numFrames, hopSize_ - hopFilled_);
+        window_.push(input, n);
+        windowEndFrame_ += n;
+        input += n;
+        numFrames -= n;
+        hopFilled_ += n;
+        if (hopFilled_ < hopSize_) break;
+        hopFilled_ = 0;
+        ++completed;
+        // 攒够一个 2048 点窗口才检测
+        if (dispatch && window_.filled() >= windowSize_) detectAndDispatch();
+    }
+    return completed;
+}
 
-    if (n < windowSize_) {
-        std::memmove(window_.data(), window_.data() + n, static_cast<size_t>(windowSize_ - n) * sizeof(float));
-        std::memcpy(window_.data() + (windowSize_ - n), input, static_cast<size_t>(n) * sizeof(float));
+void AudioEngine::detectAndDispatch() {
+    // --- 整窗送 PitchDetector；无效帧（midi<0）不回调，减轻 JNI 压力 ---
+    NoteEventBatcher::FrameNote frameNotes[PolyphonicDetector::kMaxNotes];
+    int32_t frameCount = 0;
+    int32_t onsetLag = -1;
+
+    // 整窗为一段连续内存，直接交给检测器（不另拷贝）；最新的 2048 个样本在末端
+    const int32_t length = window_.length();
+    const float* whole = window_.data();
+    const float* recent = whole + (length - windowSize_);
+
+    if (polyphonic_) {
+        const auto chord = pitchDetector_->processPolyphonic(recent, windowSize_, sampleRate_);
+        onsetLag = chord.onsetLag;
+        for (int32_t i = 0; i < chord.numNotes; ++i) {
+            const auto& n = chord.notes[i];
+            frameNotes[frameCount++] = NoteEventBatcher::FrameNote{n.midiNote, n.volume, n.confidence, n.frequencyHz, n.cents};
+        }
     } else {
-        // 单次回调长度超过窗口：只保留末尾 windowSize_（异常保护）
-        std::memcpy(window_.data(), input + (numFrames - windowSize_), static_cast<size_t>(windowSize_) * sizeof(float));
+        const auto result = multiResolution_
+                                ? pitchDetector_->processMultiResolution(whole, length, sampleRate_)
+                                : pitchDetector_->process(recent, windowSize_, sampleRate_);
+        onsetLag = result.onsetLag;
+        if (result.midiNote >= 0) {
+            frameNotes[frameCount++] =
+                NoteEventBatcher::FrameNote{result.midiNote, result.volume, result.confidence, result.frequencyHz,
+                                            result.cents};
+        }
     }
 
-    // --- 阶段 3：整窗送 PitchDetector；无效帧（midi<0）直接丢弃，减轻 JNI 压力 ---
-    const auto result = pitchDetector_->process(window_.data(), windowSize_, sampleRate_);
-    if (result.midiNote < 0) return;
+    // 端到端：窗口末样本的采集时刻 -> 此刻开始交付
+    const int64_t epoch = captureEpochNs_.load(std::memory_order_relaxed);
+    if (StageStats::enabled() && epoch != 0) {
+        const double captureNs = static_cast<double>(epoch) +
+                                 static_cast<double>(windowEndFrame_) * 1e9 / static_cast<double>(sampleRate_);
+        stageStats_.record(StageStats::Stage::EndToEnd, StageStats::nowNs() - static_cast<int64_t>(captureNs));
+    }
+    StageTimer timer(stageStats_, StageStats::Stage::Dispatch);
 
-    NoteCallback cb;
-    {
-        std::lock_guard<std::mutex> lock(cbMutex_);
-        cb = noteCb_;
+    if (calibrator_ != nullptr) {
+        for (int32_t i = 0; i < frameCount; ++i) {
+            calibrator_->observe(frameNotes[i].midiNote, frameNotes[i].cents, frameNotes[i].confidence);
+        }
+    }
+    if (batching_) {
+        // 无效帧也要送入：连续缺席是 NoteOff 的依据
+        const int64_t onsetFrame = onsetLag >= 0 ? windowEndFrame_ - onsetLag : -1;
+        batcher_.onFrame(frameNotes, frameCount, windowEndFrame_, onsetFrame);
     }
-    if (cb) {
+    for (int32_t i = 0; i < frameCount; ++i) {
         // PitchDetector::NoteResult 与 AudioEngine::NoteResult 结构相同但类型不同，显式拷贝
         AudioEngine::NoteResult out;
-        out.midiNote = result.midiNote;
-        out.volume = result.volume;
-        out.confidence = result.confidence;
-        out.frequencyHz = result.frequencyHz;
-        cb(out);
+        out.midiNote = frameNotes[i].midiNote;
+        out.volume = frameNotes[i].volume;
+        out.confidence = frameNotes[i].confidence;
+        out.frequencyHz = frameNotes[i].frequencyHz;
+        out.cents = frameNotes[i].cents;
+        dispatchNote(out);
+    }
+}
+
+void AudioEngine::dispatchNote(const NoteResult& note) {
+    CallbackGuard guard(*this);
+    const Callbacks* cbs = guard.get();
+    if (cbs != nullptr && cbs->onNote != nullptr) cbs->onNote(cbs->user, note);
+}
+
+void AudioEngine::enqueueHops(const float* input, int32_t numFrames) {
+    // 回调帧数按 burst 而定：样本跨回调就地攒进当前写槽，凑满一个 hop 才发布，队列里每个元素恰为一个分析 hop。
+    // 开始新 hop 时队列已满则整个 hop 丢弃并计数，绝不等待分析线程；丢弃的帧数随下一个 hop 入队，分析线程据此跳过缺口
+    int32_t published = 0;
+    while (numFrames > 0) {
+        if (queueFill_ == 0) queueBlock_ = hopQueue_.writeSlot();
+        const int32_t n = std::min(numFrames, hopSize_ - queueFill_);
+        if (queueBlock_ != nullptr) {
+            std::memcpy(queueBlock_->samples + queueFill_, input, static_cast<size_t>(n) * sizeof(float));
+        }
+        input += n;
+        numFrames -= n;
+        queueFill_ += n;
+        if (queueFill_ < hopSize_) break;
+        queueFill_ = 0;
+        if (queueBlock_ == nullptr) {
+            droppedHops_.fetch_add(1, std::memory_order_relaxed);
+            pendingGapFrames_ += hopSize_;
+            continue;
+        }
+        queueBlock_->numFrames = hopSize_;
+        queueBlock_->gapFrames = pendingGapFrames_;
+        pendingGapFrames_ = 0;
+        hopQueue_.publish();
+        queueBlock_ = nullptr;
+        pushedHops_.fetch_add(1, std::memory_order_relaxed);
+        ++published;
+    }
+    if (published == 0) return;
+    if (poolSlot_ >= 0) {
+        pool_->signal(poolSlot_);
+        return;
+    }
+    // notify 不持锁：分析线程另有超时兜底，丢一次唤醒只多等一个周期
+    workerCv_.notify_one();
+}
+
+bool AudioEngine::startWorker() {
+    if (pool_ != nullptr) {
+        poolSlot_ = pool_->attach(&AudioEngine::drainFromPool, this);
+        return poolSlot_ >= 0;
+    }
+    workerRunning_.store(true, std::memory_order_release);
+    worker_ = std::thread([this] { workerLoop(); });
+    return true;
+}
+
+void AudioEngine::stopWorker() {
+    if (poolSlot_ >= 0) {
+        // 流已停止、不会再 signal；detach 返回后池线程不再访问本引擎
+        pool_->detach(poolSlot_);
+        poolSlot_ = -1;
+        hopQueue_.clear();
+        return;
+    }
+    if (!worker_.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(workerMutex_);
+        workerRunning_.store(false, std::memory_order_release);
+    }
+    workerCv_.notify_one();
+    worker_.join();
+    hopQueue_.clear();
+}
+
+void AudioEngine::workerLoop() {
+    while (workerRunning_.load(std::memory_order_acquire)) {
+        drainHops();
+        std::unique_lock<std::mutex> lock(workerMutex_);
+        workerCv_.wait_for(lock, kWorkerWaitTimeout, [this] {
+            return hopQueue_.size() > 0 || !workerRunning_.load(std::memory_order_acquire);
+        });
+    }
+}
+
+void AudioEngine::drainFromPool(void* user) {
+    static_cast<AudioEngine*>(user)->drainHops();
+}
+
+void AudioEngine::skipGap(int64_t frames) {
+    windowEndFrame_ += frames;
+    window_.clear();
+    hopFilled_ = 0;
+    pitchDetector_->skipFrames();
+}
+
+void AudioEngine::drainHops() {
+    int32_t pending = hopQueue_.size();
+    if (pending <= 0) return;
+
+    if (backPressure_ == BackPressure::DropOldest) {
+        // --- 积压过多：丢最旧的，保留最新 kMaxBacklogHops 个；窗口出现缺口，清零后重新攒满并清空 FFT 块缓存 ---
+        if (pending > kMaxBacklogHops) {
+            const int32_t discard = pending - kMaxBacklogHops;
+            int64_t frames = 0;
+            for (int32_t i = 0; i < discard; ++i) {
+                const Hop* hop = hopQueue_.readSlot();
+                frames += hop->gapFrames + hop->numFrames;
+                hopQueue_.release();
+            }
+            discardedHops_.fetch_add(static_cast<uint64_t>(discard), std::memory_order_relaxed);
+            skipGap(frames);
+            pending = kMaxBacklogHops;
+        }
+        // 剩余 hop 逐个滑入并检测
+        for (int32_t i = 0; i < pending; ++i) {
+            const Hop* hop = hopQueue_.readSlot();
+            if (hop->gapFrames > 0) skipGap(hop->gapFrames);
+            feed(hop->samples, hop->numFrames, true);
+            hopQueue_.release();
+        }
+        return;
+    }
+
+    // --- Coalesce：全部滑入窗口，只检测最新窗口 ---
+    int32_t completed = 0;
+    for (int32_t i = 0; i < pending; ++i) {
+        const Hop* hop = hopQueue_.readSlot();
+        if (hop->gapFrames > 0) skipGap(hop->gapFrames);
+        completed += feed(hop->samples, hop->numFrames, false);
+        hopQueue_.release();
+    }
+    if (completed == 0) return;
+    if (completed > 1) {
+        coalescedHops_.fetch_add(static_cast<uint64_t>(completed - 1), std::memory_order_relaxed);
+        // Incremental FFT 依赖每帧恰好前移一个 hop，跳帧后须整窗重建（队列元素为整 hop，窗口末端总在 hop 边界上）
+        pitchDetector_->skipFrames();
     }
+    if (window_.filled() >= windowSize_) detectAndDispatch();
 }
@@ -1,31 +1,68 @@
 #pragma once
 
 #include <atomic>
+#include <condition_variable>
 #include <cstdint>
-#include <functional>
 #include <mutex>
+#include <thread>
 #include <vector>
 
-namespace oboe {
-class AudioStreamCallback;
-class AudioStream;
-}
+#include "../dsp/StageStats.h"
+#include "NoteEventBatcher.h"
+#include "SlidingWindow.h"
+#include "SpscRingBuffer.h"
 
+class AnalysisPool;
+class InputSource;
+class TuningCalibrator;
+class TuningTable;
 class PitchDetector;
 
 /**
  * @class AudioEngine
- * @brief Oboe 采集 + 滑窗缓冲 + 调用 [PitchDetector] 的一帧结果回调
+ * @brief 输入源采集 + 滑窗缓冲 + 调用 [PitchDetector] 的一帧结果回调
  *
  * 数据流（与计划一致）：
- * Oboe 每次回调提供 hop（512）帧 float PCM
- *   -> 维护长度 2048 的滑动窗口
- *   -> [PitchDetector::process] 得到 MIDI / 音量 / 可信度 / 频率
- *   -> 通过 [NoteCallback] 交给 JNI 层转发 Kotlin
+ * [InputSource]（设备上为 [OboeInputSource]）按原生采样率与 burst 回调任意帧数的 float PCM
+ *   -> 按帧移 [hopSize]（默认约 10.7 ms、对齐 burst 的整数倍）切分，逐 hop 滑入长度 2048 的窗口
+ *      （多分辨率模式下为 8192），一次回调中的每个完整 hop 都检测一次
+ *   -> [PitchDetector::process]（或 [PitchDetector::processMultiResolution]）得到 MIDI / 音量 / 可信度 / 频率
+ *   -> 通过 [NoteCallback] 逐帧交给 JNI 层转发 Kotlin；
+ *      或经 [NoteTracker]（多数表决平滑 + 迟滞 + 最短音长）转为带输入帧号时间戳的 note-on/off 事件，
+ *      由 [NoteEventBatcher] 按批通过 [NoteEventCallback] 交付（推荐：只有事件跨 JNI）
  *
  * 线程：
- * - [start]/[stop] 由 JNI 线程调用，内部用 [cbMutex_] 与 [running_] 协调
- * - [processAudio] 在 Oboe 音频回调线程执行，需避免长时间阻塞
+ * - [start]/[stop] 与各项 setter 由 JNI 线程调用，彼此用 [controlMutex_] 与 [running_] 协调
+ * - 回调目标经 [callbacks_] 原子发布，音频 / 分析线程交付结果时不取锁、不拷贝；[stop] 撤下发布后
+ *   在 JNI 线程上等待 [callbacksInFlight_] 归零（宽限期），之后不会再有回调，实时线程从不等待
+ * - [processAudio] 在输入源的采集线程（Oboe 音频回调线程）执行，需避免长时间阻塞，且不得堆分配（[RealtimeScope] 守护）
+ *
+ * 输入源（[setInputSource]，[start] 前必须设置）：引擎不拥有源，也不依赖 Oboe，可在主机上构建。
+ * [ReplayInputSource] 回放 WAV / 裸 PCM，按实时节奏或不限速驱动同一条路径（滑窗、检测、回调、事件批量），
+ * 用于离设备的整条管线压测；[stats] 的 xrun 与采集时间戳同样来自输入源。
+ *
+ * 采样率与帧移（[setStreamConfig]，默认均为 0 即采用设备原生值）：不指定采样率时输入源以设备原生采样率
+ * （常见 44.1 / 48 kHz）开流，避免重采样的时延与 CPU；回调帧数不固定为 hop，由引擎自行切分。
+ * 开流后按实际采样率与帧移调用 [PitchDetector::prepare] 一次性重建派生表，事件时间戳仍以输入帧号计。
+ *
+ * 处理模式（[ProcessingMode]，[start] 前用 [setProcessingMode] 设置）：
+ * - Inline（默认）：音频回调线程内完成滑窗、检测与结果回调。
+ * - Pipelined：回调把样本跨回调攒进 wait-free 的 [SpscRingBuffer] 的当前槽，凑满一个 hop 才发布，
+ *   由分析线程独占滑窗与 [PitchDetector] 完成检测与回调；音频线程不再承担 FFT/HPS/YIN，也不运行结果回调。
+ *   队列满时整个丢弃新 hop 并计入 droppedHops；分析线程积压时按 [BackPressure] 处理。
+ *   队列元素恰为一个分析 hop（与设备 burst 大小无关），容量与积压上限都按 hop 计。
+ *   分析默认由引擎自己的线程承担；[setAnalysisPool] 指定共享的 [AnalysisPool] 后改由池线程调度，
+ *   多个引擎（多路麦克风 / 多件乐器）共用固定数量的线程，而不是各占一个分析线程。
+ *
+ * 观测（[stats]）：检测器各级（FFT / HPS / YIN / 多音 / 整帧）与引擎各级（输入回调、结果交付、
+ * 采集到交付的端到端时延）的耗时直方图，以及输入源的 xrun 计数；记录端无锁、不分配，可随时取快照。
+ * 端到端时延以输入源的采集时间戳（Oboe 硬件时间戳，约每 [kTimestampIntervalCallbacks] 次回调取一次）换算窗口末样本的采集时刻，
+ * 取不到时以回调到达时刻近似（不含输入缓冲时延）。编译时未启用 PIANO_NOTE_STAGE_STATS 则只有 xrun 计数。
+ *
+ * 调律（[setTuning]）：基频 -> MIDI 按逐键调律表划分，结果带音分偏差；[setCalibrator] 挂上校准器时
+ * 检测线程把每帧检出的音交给它，stop 后由 [TuningCalibrator::build] 学出参考音高与拉伸偏移。
+ *
+ * 多实例：引擎之间没有共享的可变状态（流、滑窗、检测器、回调各自独立），同一进程内可同时运行多个。
  */
 class AudioEngine {
 public:
@@ -35,46 +72,307 @@ public:
         float volume;         ///< 音量 0..1（由 FFT 侧 RMS 映射）
         float confidence;     ///< 融合后可信度 0..1
         float frequencyHz;    ///< 估计基频 Hz
+        float cents;          ///< 相对调律表（[setTuning]）该键中心频率的偏差（音分）
+    };
+
+    /** 逐帧回调；函数指针 + user，交付时不分配 */
+    using NoteCallback = void (*)(void* user, const NoteResult& note);
+    /** 批量事件回调：events 仅在回调期间有效 */
+    using NoteEventCallback = void (*)(void* user, const NoteEvent* events, int32_t count);
+
+    /** 一次运行的回调目标；[start] 时拷入引擎，[stop] 返回后不再被调用 */
+    struct Callbacks {
+        NoteCallback onNote = nullptr;      ///< 每帧（窗口更新后）若 midi>=0 则调用
+        NoteEventCallback onEvents = nullptr; ///< 非空时启用事件批量交付
+        void* user = nullptr;               ///< 原样传给上面两个回调
+    };
+
+    enum class ProcessingMode {
+        Inline,
+        Pipelined,
+    };
+
+    /** Pipelined 模式下分析线程积压时的策略 */
+    enum class BackPressure {
+        /** 积压超过 [kMaxBacklogHops] 时丢弃最旧的 hop，窗口重新填满后再检测：时延有界，但会丢样本 */
+        DropOldest,
+        /**
+         * 把积压的 hop 全部滑入窗口，只对最新窗口检测一次：跳过中间帧，积压在队列容量内时不丢样本。
+         * 两种策略下队列满（分析线程停顿超过约 [kHopQueueCapacity] 个 hop）时新数据都会被丢弃（[PipelineStats::droppedHops]）。
+         */
+        Coalesce,
+    };
+
+    /** [stats] 快照 */
+    struct Stats {
+        /** 按 [StageStats::Stage] 下标：Fft..Detect 来自检测器，AudioCallback..EndToEnd 来自引擎 */
+        StageStats::Summary stages[StageStats::kNumStages];
+        int32_t xRunCount;       ///< 输入源报告的 xrun 次数（输入流为溢出丢帧）；不支持或未运行为 -1
+        bool hardwareTimestamps; ///< EndToEnd 是否基于输入源的采集时间戳（否则为回调到达时刻近似）
     };
 
-    using NoteCallback = std::function<void(const NoteResult&)>;
+    /** Pipelined 模式计数（自 [start] 起累计） */
+    struct PipelineStats {
+        uint64_t pushedHops;    ///< 成功入队的 hop（每个 [hopSize] 帧）
+        uint64_t droppedHops;   ///< 队列满、在音频线程被丢弃的 hop
+        uint64_t discardedHops; ///< DropOldest：分析线程丢弃的积压 hop
+        uint64_t coalescedHops; ///< Coalesce：滑入窗口但未单独检测的分析 hop
+    };
 
     AudioEngine();
     ~AudioEngine();
 
     /**
-     * 打开 Oboe 输入流并 requestStart。
-     * @param cb 每帧（窗口更新后）若 midi>=0 则调用
-     * @return 流打开且启动成功为 true
+     * 打开 [setInputSource] 指定的输入源并开始采集；未设置输入源时返回 false。
+     * @param callbacks onEvents 非空时启用事件批量交付：每帧结果（含无效帧）送入 [NoteEventBatcher]，
+     *        按 [setEventBatchConfig] 的跟踪参数产生事件、按间隔/数量成批回调；onNote 可为空
+     * @return 输入源打开且启动成功为 true
      */
-    bool start(NoteCallback cb);
+    bool start(const Callbacks& callbacks);
 
-    /** 停止流、清空回调；可重复调用（第二次返回 false） */
+    /**
+     * 停止流、交付剩余事件（含仍在发声音的 NoteOff）、撤下回调并等待进行中的回调返回；
+     * 返回后回调的 user 可以安全释放。可重复调用（第二次返回 false）
+     */
     bool stop();
 
+    /**
+     * 设置事件批量与跟踪参数；运行中调用无效并返回 false。
+     * [NoteTracker::Config::monophonic] 与 onsetWindowFrames 由引擎按当前模式覆盖。
+     */
+    bool setEventBatchConfig(const NoteEventBatcher::Config& config);
+
+    /**
+     * 多音模式：每帧走 [PitchDetector::processPolyphonic]，[NoteCallback] 对每个检出音各调用一次，
+     * 事件批量按琴键独立去重。运行中调用无效并返回 false。
+     * @param maxNotes 每帧最多输出的音数，1..[PolyphonicDetector::kMaxNotes]
+     */
+    bool setPolyphonic(bool enabled, int32_t maxNotes = 6);
+
+    /**
+     * 多分辨率模式（单音）：滑窗加长到 [PitchDetector::kLongFftSize]，低音区用整窗、高音区只用最新
+     * [PitchDetector::kShortFftSize] 个样本，每帧合并。冷启动仍在攒够 2048 个样本后开始检测（更早的部分为 0）。
+     * 多音模式下不生效（多音检测始终用最新 2048 个样本）。运行中调用无效并返回 false。
+     */
+    bool setMultiResolution(bool enabled);
+
+    /**
+     * 起音门控：静音 / 稳定延音帧跳过 HPS、YIN（见 [PitchDetector::setOnsetGating]），
+     * 批量事件的 NoteOn 记在检出的起音帧上（精确到 64 帧）。运行中调用无效并返回 false。
+     */
+    bool setOnsetGating(bool enabled);
+
+    /**
+     * 噪声底白化（默认开启）：HPS 前减去逐 bin 跟踪的稳态噪声底（见 [PitchDetector::setNoiseWhitening]）。
+     * 运行中调用无效并返回 false。
+     */
+    bool setNoiseWhitening(bool enabled);
+
     bool isRunning() const { return running_.load(); }
 
+    /**
+     * 设置采样率与帧移；0 表示采用设备原生值（帧移取最接近 10.7 ms 的 burst 整数倍）。运行中调用无效并返回 false。
+     * @param hopSize 帧移，1..2048
+     */
+    bool setStreamConfig(int32_t sampleRate, int32_t hopSize);
+
+    /**
+     * 指定输入设备（Android AudioDeviceInfo.id）；0 为系统默认输入。多路麦克风时每个引擎各开一个设备。
+     * 运行中调用无效并返回 false。
+     */
+    bool setInputDevice(int32_t deviceId);
+
+    /**
+     * 指定输入源（不转移所有权，须比引擎活得久）；[start] 时打开、[stop] 时关闭。运行中调用无效并返回 false。
+     */
+    bool setInputSource(InputSource* source);
+
+    /**
+     * 设置调律表（拷贝给检测器；默认 440 Hz 十二平均律），决定基频 -> MIDI 的分界、结果的音分偏差以及常 Q / 多音模板的取样频率。
+     * 运行中调用无效并返回 false。
+     */
+    bool setTuning(const TuningTable& tuning);
+    const TuningTable& tuning() const;
+
+    /**
+     * 校准：非空时检测线程把每帧检出的音送入 calibrator（不转移所有权），用于学出调律表（见 [TuningCalibrator]）。
+     * 引擎不清空它；运行期间只由检测线程写，[stop] 之后才可读取 / 生成新表。运行中调用无效并返回 false。
+     */
+    bool setCalibrator(TuningCalibrator* calibrator);
+
+    /** 实际采样率与帧移：[start] 成功后有效 */
+    int32_t sampleRate() const { return sampleRate_; }
+    int32_t hopSize() const { return hopSize_; }
+
+    /** 按采样率与 burst 选择默认帧移：约 10.7 ms（48 kHz 下 512）取整到 burst 的整数倍，不超过窗口长度 */
+    static int32_t defaultHopSize(int32_t sampleRate, int32_t framesPerBurst);
+
+    /** 设置处理模式；运行中调用无效并返回 false */
+    bool setProcessingMode(ProcessingMode mode, BackPressure backPressure = BackPressure::Coalesce);
+
+    /**
+     * Pipelined 模式的分析调度：非空时挂到共享的 [pool] 上（[start] 时占用槽位，池满则 [start] 失败），
+     * 为空时使用引擎自己的分析线程（默认）。pool 须比引擎活得久。运行中调用无效并返回 false。
+     */
+    bool setAnalysisPool(AnalysisPool* pool);
+
+    PipelineStats pipelineStats() const;
+
+    /** 逐级耗时与 xrun 快照（自 [start] 起累计）；可在任意线程调用，不影响音频线程 */
+    Stats stats();
+
 private:
+    /** [InputSource::DataFn] 入口：已 stop 时直接返回，否则更新采集时钟并交给 [processAudio] */
+    static void onInput(void* user, const float* input, int32_t numFrames);
     /**
-     * Oboe 回调入口：累积/滑动窗口后做一次检测。
+     * 采集线程入口：Inline 模式下滑窗并检测；Pipelined 模式下只入队。
      */
     void processAudio(const float* input, int32_t numFrames);
+    /**
+     * 音频线程：更新采集时钟锚点 [captureEpochNs_]（输入帧 0 的采集时刻），供 EndToEnd 换算。
+     * 每 [kTimestampIntervalCallbacks] 次回调向输入源取一次采集时间戳，取不到时每次回调按到达时刻近似。
+     */
+    void updateCaptureClock(int32_t numFrames);
+
+    /**
+     * 按 [hopSize_] 切分并滑入新样本；每凑满一个 hop 且窗口已攒够时（dispatch 为 true）检测一次。
+     * 不足一个 hop 的尾部留待下次调用。
+     * @return 本次凑满的 hop 数
+     */
+    int32_t feed(const float* input, int32_t numFrames, bool dispatch);
+    /** 输入出现缺口（丢弃的样本）：时间戳跳过 frames 帧，窗口清零后重新攒满，检测器整窗重建 */
+    void skipGap(int64_t frames);
+    /** 对当前窗口做一帧检测，有效结果交给 onNote；启用批量时送入 [batcher_] */
+    void detectAndDispatch();
+    /** 把一个有效音交给 onNote */
+    void dispatchNote(const NoteResult& note);
+    /** [NoteEventBatcher] 交付入口，转发给 onEvents */
+    static void flushEvents(void* user, const NoteEvent* events, int32_t count);
+
+    /** Pipelined：音频线程侧，跨回调攒满一个 hop 再入队，不阻塞 */
+    void enqueueHops(const float* input, int32_t numFrames);
+    /** Pipelined：分析线程主循环 */
+    void workerLoop();
+    /** [AnalysisPool] 处理入口，转发给 [drainHops] */
+    static void drainFromPool(void* user);
+    /** Pipelined：取出全部积压 hop 并按 [backPressure_] 处理 */
+    void drainHops();
+    /** 起分析线程，或挂到 [pool_]；池满返回 false */
+    bool startWorker();
+    void stopWorker();
+
+    /**
+     * 交付侧读取回调期间持有：先登记 [callbacksInFlight_] 再读 [callbacks_]，析构时注销。
+     * 与 [stop] 的“先撤下发布、再等计数归零”配对（均为 seq_cst），保证等待结束后没有读者仍持有旧目标。
+     */
+    class CallbackGuard {
+    public:
+        explicit CallbackGuard(AudioEngine& engine) : engine_(engine) {
+            engine_.callbacksInFlight_.fetch_add(1);
+            callbacks_ = engine_.callbacks_.load();
+        }
+        ~CallbackGuard() { engine_.callbacksInFlight_.fetch_sub(1); }
+        CallbackGuard(const CallbackGuard&) = delete;
+        CallbackGuard& operator=(const CallbackGuard&) = delete;
+
+        /** 未发布（未启动或正在停止）时为 nullptr */
+        const Callbacks* get() const { return callbacks_; }
+
+    private:
+        AudioEngine& engine_;
+        const Callbacks* callbacks_;
+    };
 
     std::atomic<bool> running_{false};
-    std::mutex cbMutex_;
-    NoteCallback noteCb_;
+    /** 只在 JNI 线程之间互斥：start/stop、setter 与 [stats]；音频 / 分析线程从不获取 */
+    std::mutex controlMutex_;
+    /** 本次运行的回调目标；[start] 写入后经 [callbacks_] 发布，运行期间不变 */
+    Callbacks callbackStorage_;
+    /** 指向 [callbackStorage_] 或 nullptr */
+    std::atomic<const Callbacks*> callbacks_{nullptr};
+    /** 正在读取 / 调用回调的交付方数量（[CallbackGuard]） */
+    std::atomic<int32_t> callbacksInFlight_{0};
 
     /** 算法参数：与 PitchDetector / FFTWrapper 的 2048 点一致 */
-    static constexpr int32_t sampleRate_ = 48000;
     static constexpr int32_t windowSize_ = 2048;
-    static constexpr int32_t hopSize_ = 512;
-    std::vector<float> window_;
-    /** 启动后前几包用于填满 window_ */
-    int32_t windowFilled_{0};
-
-    class CallbackImpl;
-    CallbackImpl* callback_{nullptr};
-    oboe::AudioStream* stream_{nullptr};
+    /** [setStreamConfig] 请求的采样率 / 帧移；0 为设备原生 */
+    int32_t requestedSampleRate_{0};
+    int32_t requestedHopSize_{0};
+    /** [setInputDevice]；0 为系统默认 */
+    int32_t inputDeviceId_{0};
+    /** 实际采样率与帧移：[start] 开流后确定，运行期间只读 */
+    int32_t sampleRate_{48000};
+    int32_t hopSize_{512};
+    /** 当前 hop 已滑入的样本数，凑满 [hopSize_] 检测一次 */
+    int32_t hopFilled_{0};
+    /** 滑窗（镜像环形缓冲，推进不搬移）；长度为 [windowSize_]，多分辨率模式下为 [PitchDetector::kLongFftSize] */
+    SlidingWindow window_;
+    /** 窗口末端对应的输入帧号（自 start 起，含被丢弃的 hop），作为事件时间戳 */
+    int64_t windowEndFrame_{0};
+
+    /** [setCalibrator]；运行期间只由检测线程写入 */
+    TuningCalibrator* calibrator_{nullptr};
+
+    /** 多音 / 多分辨率模式：[start] 前设置，运行期间只读 */
+    bool polyphonic_{false};
+    bool multiResolution_{false};
+
+    /** 事件批量：[batching_] 在 start 时确定，运行期间只读 */
+    bool batching_{false};
+    NoteEventBatcher::Config batchConfig_;
+    NoteEventBatcher batcher_;
+
+    // --- Pipelined 模式 ---
+    /** 队列元素的样本容量：帧移上限（[setStreamConfig] 限制 hop <= 窗口长度） */
+    static constexpr int32_t kMaxHopFrames = windowSize_;
+    /** 队列容量（hop 数）：默认帧移下 32 * 512 / 48k ≈ 340ms */
+    static constexpr int32_t kHopQueueCapacity = 32;
+    /** DropOldest：分析线程允许的最大积压 hop 数（默认帧移下约 43ms） */
+    static constexpr int32_t kMaxBacklogHops = 4;
+
+    struct Hop {
+        int32_t numFrames;
+        /** 本 hop 之前因队列满被丢弃的帧数（hop 的整数倍；随下一个成功入队的 hop 带给分析线程，位置与顺序准确） */
+        int64_t gapFrames;
+        float samples[kMaxHopFrames];
+    };
+
+    ProcessingMode mode_{ProcessingMode::Inline};
+    BackPressure backPressure_{BackPressure::Coalesce};
+    SpscRingBuffer<Hop> hopQueue_{kHopQueueCapacity};
+    std::thread worker_;
+    std::atomic<bool> workerRunning_{false};
+    std::mutex workerMutex_;
+    std::condition_variable workerCv_;
+    /** 共享分析线程池与运行期间占用的槽位（未挂接为 -1） */
+    AnalysisPool* pool_{nullptr};
+    int32_t poolSlot_{-1};
+
+    /** 音频线程正在填充的槽（未发布）；为 nullptr 且 [queueFill_] > 0 时表示当前 hop 因队列满而丢弃 */
+    Hop* queueBlock_{nullptr};
+    /** 当前 hop 已写入（或已丢弃）的帧数；只由音频线程读写 */
+    int32_t queueFill_{0};
+    /** 已丢弃、尚未随 hop 交给分析线程的帧数；只由音频线程读写 */
+    int64_t pendingGapFrames_{0};
+    std::atomic<uint64_t> pushedHops_{0};
+    std::atomic<uint64_t> droppedHops_{0};
+    std::atomic<uint64_t> discardedHops_{0};
+    std::atomic<uint64_t> coalescedHops_{0};
+
+    // --- 观测 ---
+    /** 硬件时间戳的查询间隔（回调次数） */
+    static constexpr int32_t kTimestampIntervalCallbacks = 64;
+    /** 引擎各级耗时：AudioCallback 由音频线程写，Dispatch / EndToEnd 由检测线程写（各直方图单写者） */
+    StageStats stageStats_;
+    /** 输入帧 0 的采集时刻（steady_clock ns）；0 为尚未确定 */
+    std::atomic<int64_t> captureEpochNs_{0};
+    std::atomic<bool> hardwareTimestamps_{false};
+    /** 音频线程：自 start 起收到的帧数与距下次查询硬件时间戳的回调数 */
+    int64_t framesReceived_{0};
+    int32_t timestampCountdown_{0};
+
+    /** [setInputSource]；运行期间由 [start] 打开，只在持 [controlMutex_] 时打开 / 关闭 */
+    InputSource* source_{nullptr};
 
     PitchDetector* pitchDetector_{nullptr};
 };
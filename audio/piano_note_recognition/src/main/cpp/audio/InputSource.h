@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * @class InputSource
+ * @brief [AudioEngine] 的输入源：按任意块长把单声道 float PCM 推给引擎
+ *
+ * 实现：
+ * - [OboeInputSource]：Oboe 实时输入流（Android，随 JNI 库构建）
+ * - [ReplayInputSource]：WAV / 裸 PCM 回放，按实时节奏或不限速推送（主机可构建，用于整条管线的压测与基准）
+ *
+ * 线程：[open] / [start] / [close] / [xRunCount] 由引擎在控制线程（JNI 线程）上调用；
+ * 数据回调与 [captureTimestamp] 在源自己的采集线程上调用，与引擎的 Inline 处理同线程，须满足实时约束。
+ */
+class InputSource {
+public:
+    /** 数据就绪：input 仅在回调期间有效，numFrames 不固定 */
+    using DataFn = void (*)(void* user, const float* input, int32_t numFrames);
+
+    /** 引擎的开流请求；0 表示由源决定 */
+    struct Request {
+        int32_t sampleRate = 0; ///< 期望采样率 Hz；源可忽略（如回放文件的原生采样率）
+        int32_t deviceId = 0;   ///< 输入设备（Android AudioDeviceInfo.id）；非设备源忽略
+    };
+
+    /** 打开后的实际格式 */
+    struct Format {
+        int32_t sampleRate;     ///< 实际采样率 Hz
+        int32_t framesPerBurst; ///< 典型回调块长；未知为 0
+    };
+
+    virtual ~InputSource() = default;
+
+    /**
+     * 打开源；[start] 前不会回调，成功时写出实际格式。
+     * @return 失败时源保持关闭状态
+     */
+    virtual bool open(const Request& request, DataFn fn, void* user, Format& format) = 0;
+
+    /** 开始推送数据；失败返回 false（源仍处于打开状态，须 [close]） */
+    virtual bool start() = 0;
+
+    /** 停止并关闭；返回后不再回调。未打开时为空操作 */
+    virtual void close() = 0;
+
+    /**
+     * 采集线程：最近的采集时间戳，即帧 framePosition 的采集时刻（CLOCK_MONOTONIC / steady_clock ns）。
+     * @return 不支持或暂不可用时返回 false，引擎以回调到达时刻近似
+     */
+    virtual bool captureTimestamp(int64_t& framePosition, int64_t& timeNs) = 0;
+
+    /** 溢出丢帧（xrun）次数；不支持或未打开为 -1 */
+    virtual int32_t xRunCount() = 0;
+};
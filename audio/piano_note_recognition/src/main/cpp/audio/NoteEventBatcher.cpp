@@ -0,0 +1,54 @@
+#include "NoteEventBatcher.h"
+
+#include <algorithm>
+
+void NoteEventBatcher::configure(const Config& config, int32_t sampleRate, FlushFn flushFn, void* user) {
+    config_ = config;
+    config_.maxBatchEvents = std::clamp(config_.maxBatchEvents, 1, kMaxBatchEvents);
+    flushIntervalFrames_ = config_.flushIntervalMs > 0
+                               ? static_cast<int64_t>(config_.flushIntervalMs) * sampleRate / 1000
+                               : 0;
+    flushFn_ = flushFn;
+    flushUser_ = user;
+    tracker_.configure(config_.tracking, sampleRate, &NoteEventBatcher::push, this);
+    reset();
+}
+
+void NoteEventBatcher::reset() {
+    tracker_.reset();
+    currentFrame_ = 0;
+    pendingCount_ = 0;
+}
+
+void NoteEventBatcher::push(void* user, const NoteEvent& event) {
+    auto* self = static_cast<NoteEventBatcher*>(user);
+    // 容量与 maxBatchEvents 同步检查，正常不会溢出；保险起见满了先交付
+    if (self->pendingCount_ >= kMaxBatchEvents) self->flush();
+    if (self->pendingCount_ == 0) self->pendingSince_ = self->currentFrame_;
+    self->pending_[self->pendingCount_++] = event;
+}
+
+void NoteEventBatcher::onFrame(const FrameNote* notes, int32_t count, int64_t framePosition, int64_t onsetFrame) {
+    currentFrame_ = framePosition;
+    tracker_.onFrame(notes, count, framePosition, onsetFrame);
+
+    // 交付：攒满，或最早一条等待超过间隔
+    if (pendingCount_ == 0) return;
+    if (pendingCount_ >= config_.maxBatchEvents || framePosition - pendingSince_ >= flushIntervalFrames_) {
+        flush();
+    }
+}
+
+void NoteEventBatcher::flush() {
+    if (pendingCount_ == 0) return;
+    if (flushFn_ != nullptr) {
+        flushFn_(flushUser_, pending_, pendingCount_);
+    }
+    pendingCount_ = 0;
+}
+
+void NoteEventBatcher::finish(int64_t framePosition) {
+    currentFrame_ = framePosition;
+    tracker_.finish(framePosition);
+    flush();
+}
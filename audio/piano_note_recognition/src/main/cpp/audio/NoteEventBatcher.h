@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstdint>
+
+#include "NoteTracker.h"
+
+/**
+ * @file NoteEventBatcher.h
+ * @brief 逐帧识别结果 -> [NoteTracker] 产生 note-on / note-off 事件 -> 按数量或时间间隔成批交付
+ *
+ * 说明：
+ * - 事件的去重、平滑与时间戳由 [NoteTracker] 负责（参数见 [Config::tracking]），本类只攒批。
+ * - 事件为定长 32 字节 POD（[NoteEvent]），批次可直接 memcpy 进 JNI direct ByteBuffer。
+ * - 时间以输入帧号计（[NoteEvent::framePosition]），不读系统时钟；间隔按采样率换算为帧数，
+ *   从批内第一条事件入队时的检测帧起算（事件时间戳本身可能更早）。
+ * - 缓冲为定长数组，构造后不分配，可在音频回调线程使用；非线程安全，由检测线程独占。
+ */
+
+class NoteEventBatcher {
+public:
+    /** 单批最大事件数（缓冲容量） */
+    static constexpr int32_t kMaxBatchEvents = 64;
+
+    struct Config {
+        int32_t flushIntervalMs = 50;  ///< 最早一条待发事件等待超过该时长即交付；<=0 表示每帧检查后立即交付
+        int32_t maxBatchEvents = 16;   ///< 攒满即交付，范围 1..[kMaxBatchEvents]
+        NoteTracker::Config tracking;  ///< 事件状态机参数
+    };
+
+    using FrameNote = NoteTracker::FrameNote;
+
+    /** 交付回调：events 仅在回调期间有效 */
+    using FlushFn = void (*)(void* user, const NoteEvent* events, int32_t count);
+
+    NoteEventBatcher() = default;
+
+    /** 设置参数与交付目标，并清空状态；不可与 [onFrame] 并发调用 */
+    void configure(const Config& config, int32_t sampleRate, FlushFn flushFn, void* user);
+
+    /** 清空跟踪状态与待发事件（不交付） */
+    void reset();
+
+    /**
+     * 送入一帧识别结果。
+     * @param notes 本帧检出的音（midiNote 须在 0..127），count 为 0 表示无效/静音帧
+     * @param framePosition 该帧窗口末端的输入帧号
+     * @param onsetFrame 本帧新检出的起音帧号；无起音为 -1
+     */
+    void onFrame(const FrameNote* notes, int32_t count, int64_t framePosition, int64_t onsetFrame = -1);
+
+    /** 立即交付待发事件（若有） */
+    void flush();
+
+    /** 输入结束：为仍在发声的音补 NoteOff 并交付 */
+    void finish(int64_t framePosition);
+
+    int32_t activeCount() const { return tracker_.activeCount(); }
+
+private:
+    /** [NoteTracker] 事件出口：追加到待发缓冲 */
+    static void push(void* user, const NoteEvent& event);
+
+    Config config_;
+    int64_t flushIntervalFrames_{0};
+    FlushFn flushFn_{nullptr};
+    void* flushUser_{nullptr};
+
+    NoteTracker tracker_;
+    /** 当前帧号（[onFrame] 入口处更新），用于记录批次起点 */
+    int64_t currentFrame_{0};
+    /** 批内第一条事件入队时的检测帧号 */
+    int64_t pendingSince_{0};
+
+    NoteEvent pending_[kMaxBatchEvents];
+    int32_t pendingCount_{0};
+};
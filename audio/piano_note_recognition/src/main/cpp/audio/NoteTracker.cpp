@@ -0,0 +1,171 @@
+#include "NoteTracker.h"
+
+#include <algorithm>
+
+void NoteTracker::configure(const Config& config, int32_t sampleRate, EmitFn emitFn, void* user) {
+    config_ = config;
+    // 表决窗口取奇数，过半即唯一
+    config_.smoothingHops = std::clamp(config_.smoothingHops, 1, kMaxSmoothingHops) | 1;
+    config_.onHops = std::max(config_.onHops, 1);
+    config_.releaseHops = std::max(config_.releaseHops, 1);
+    config_.sustainConfidence = std::min(config_.sustainConfidence, config_.onConfidence);
+    minNoteFrames_ = config_.minNoteMs > 0 ? static_cast<int64_t>(config_.minNoteMs) * sampleRate / 1000 : 0;
+    emitFn_ = emitFn;
+    emitUser_ = user;
+    reset();
+}
+
+void NoteTracker::reset() {
+    std::fill_n(active_, kNumMidi, false);
+    std::fill_n(rawBits_, kNumMidi, 0u);
+    std::fill_n(rawStart_, kNumMidi, int64_t{0});
+    std::fill_n(rawEnd_, kNumMidi, int64_t{0});
+    std::fill_n(pendingRun_, kNumMidi, 0);
+    std::fill_n(absentRun_, kNumMidi, 0);
+    std::fill_n(eventFrame_, kNumMidi, int64_t{0});
+    activeCount_ = 0;
+    silentBits_ = 0;
+    monoSmoothed_ = -1;
+    pendingOnset_ = -1;
+}
+
+void NoteTracker::emit(NoteEventType type, int32_t midiNote, float volume, int64_t framePosition) {
+    if (emitFn_ == nullptr) return;
+    NoteEvent e;
+    e.type = static_cast<int32_t>(type);
+    e.midiNote = midiNote;
+    e.volume = volume;
+    e.confidence = lastConfidence_[midiNote];
+    e.frequencyHz = lastFrequencyHz_[midiNote];
+    e.cents = lastCents_[midiNote];
+    e.framePosition = framePosition;
+    emitFn_(emitUser_, e);
+}
+
+void NoteTracker::noteOn(int32_t midiNote, int64_t at) {
+    // 同一琴键的时间戳不回退（起音帧可能早于上一次 NoteOff）
+    at = std::max(at, eventFrame_[midiNote]);
+    emit(NoteEventType::NoteOn, midiNote, lastVolume_[midiNote], at);
+    active_[midiNote] = true;
+    eventFrame_[midiNote] = at;
+    pendingRun_[midiNote] = 0;
+    absentRun_[midiNote] = 0;
+    ++activeCount_;
+}
+
+void NoteTracker::noteOff(int32_t midiNote, int64_t at) {
+    at = std::max(at, eventFrame_[midiNote]);
+    emit(NoteEventType::NoteOff, midiNote, 0.0f, at);
+    active_[midiNote] = false;
+    eventFrame_[midiNote] = at;
+    pendingRun_[midiNote] = 0;
+    absentRun_[midiNote] = 0;
+    --activeCount_;
+}
+
+void NoteTracker::onFrame(const FrameNote* notes, int32_t count, int64_t framePosition, int64_t onsetFrame) {
+    if (onsetFrame >= 0) pendingOnset_ = onsetFrame;
+
+    // --- 1) 原始出现：过可信度迟滞门限，记录出现 / 缺席的起点 ---
+    bool present[kNumMidi] = {};
+    int32_t monoNote = -1;
+    for (int32_t i = 0; i < count; ++i) {
+        const FrameNote& n = notes[i];
+        if (n.midiNote < 0 || n.midiNote >= kNumMidi) continue;
+        const float gate = active_[n.midiNote] ? config_.sustainConfidence : config_.onConfidence;
+        if (n.confidence < gate) continue;
+        present[n.midiNote] = true;
+        lastVolume_[n.midiNote] = n.volume;
+        lastConfidence_[n.midiNote] = n.confidence;
+        lastFrequencyHz_[n.midiNote] = n.frequencyHz;
+        lastCents_[n.midiNote] = n.cents;
+        if (monoNote < 0) monoNote = n.midiNote;
+    }
+    if (config_.monophonic) {
+        // 单音只认第一个有效音，其余视为缺席
+        for (int32_t m = 0; m < kNumMidi; ++m) present[m] = m == monoNote;
+    }
+    for (int32_t m = 0; m < kNumMidi; ++m) {
+        const bool wasPresent = (rawBits_[m] & 1u) != 0;
+        rawBits_[m] = (rawBits_[m] << 1) | (present[m] ? 1u : 0u);
+        if (present[m] && !wasPresent) rawStart_[m] = framePosition;
+        if (!present[m] && wasPresent) rawEnd_[m] = framePosition;
+    }
+
+    // --- 2) 平滑：按键对最近 smoothingHops 帧多数表决 ---
+    bool smoothed[kNumMidi] = {};
+    const uint32_t mask = (1u << config_.smoothingHops) - 1u;
+    for (int32_t m = 0; m < kNumMidi; ++m) {
+        smoothed[m] = 2 * __builtin_popcount(rawBits_[m] & mask) > config_.smoothingHops;
+    }
+    if (config_.monophonic) {
+        // 单音：过半的音（至多一个）或过半的静音帧决定结果；都不过半（换音 / 起止的过渡帧）时保持上一帧
+        int32_t winner = -1;
+        for (int32_t m = 0; m < kNumMidi && winner < 0; ++m) {
+            if (smoothed[m]) winner = m;
+        }
+        silentBits_ = (silentBits_ << 1) | (monoNote < 0 ? 1u : 0u);
+        if (winner >= 0) {
+            monoSmoothed_ = winner;
+        } else if (2 * __builtin_popcount(silentBits_ & mask) > config_.smoothingHops) {
+            monoSmoothed_ = -1;
+        }
+        for (int32_t m = 0; m < kNumMidi; ++m) smoothed[m] = m == monoSmoothed_;
+    }
+
+    // --- 3) 状态机：未发声键确认 onHops 帧后 NoteOn（单音先顶掉其它音）---
+    for (int32_t m = 0; m < kNumMidi; ++m) {
+        if (active_[m]) continue;
+        if (!smoothed[m]) {
+            pendingRun_[m] = 0;
+            continue;
+        }
+        if (++pendingRun_[m] < config_.onHops) continue;
+        // 起音窗口内的第一个新音记在起音帧上，否则记在原始结果首次出现的帧上
+        int64_t at = pendingOnset_ >= 0 ? pendingOnset_ : rawStart_[m];
+        if (config_.monophonic) {
+            // 顶替发声音同样受最短音长约束：未满时新音继续等待，之后在最短音长处交接
+            int64_t earliest = 0;
+            for (int32_t k = 0; k < kNumMidi; ++k) {
+                if (active_[k]) earliest = std::max(earliest, eventFrame_[k] + minNoteFrames_);
+            }
+            if (framePosition < earliest) continue;
+            at = std::max(at, earliest);
+            for (int32_t k = 0; k < kNumMidi && activeCount_ > 0; ++k) {
+                if (active_[k]) noteOff(k, at);
+            }
+        }
+        pendingOnset_ = -1;
+        noteOn(m, at);
+    }
+
+    // 发声键连续缺席 releaseHops 帧后 NoteOff，记在原始结果开始缺席处，且不早于最短音长
+    for (int32_t m = 0; m < kNumMidi && activeCount_ > 0; ++m) {
+        if (!active_[m]) continue;
+        if (smoothed[m]) {
+            absentRun_[m] = 0;
+            continue;
+        }
+        if (++absentRun_[m] < config_.releaseHops) continue;
+        const int64_t earliest = eventFrame_[m] + minNoteFrames_;
+        if (framePosition < earliest) continue;
+        noteOff(m, std::max(rawEnd_[m], earliest));
+    }
+
+    // --- 4) 起音窗口已过仍未换音：单音模式下是同音重击，补 NoteOff / NoteOn；多音模式无法归属，丢弃 ---
+    if (pendingOnset_ >= 0 && framePosition - pendingOnset_ >= config_.onsetWindowFrames) {
+        if (config_.monophonic && monoNote >= 0 && active_[monoNote] &&
+            pendingOnset_ >= eventFrame_[monoNote] + std::max<int64_t>(minNoteFrames_, 1)) {
+            noteOff(monoNote, pendingOnset_);
+            noteOn(monoNote, pendingOnset_);
+        }
+        pendingOnset_ = -1;
+    }
+}
+
+void NoteTracker::finish(int64_t framePosition) {
+    for (int32_t m = 0; m < kNumMidi && activeCount_ > 0; ++m) {
+        if (active_[m]) noteOff(m, framePosition);
+    }
+    pendingOnset_ = -1;
+}
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * @file NoteTracker.h
+ * @brief 逐帧识别结果 -> 带迟滞的 note-on / note-off 事件（按琴键的状态机）
+ *
+ * 每个琴键一个状态机 Idle -> Pending -> Active -> Releasing -> Idle：
+ * - 多数表决平滑：每键在最近 [Config::smoothingHops] 帧中出现过半才算出现，滤掉单帧八度跳变与掉帧。
+ *   单音模式下静音帧过半时为无音；换音或起止的过渡帧里谁都不过半时保持上一帧的结果，过渡帧不会被当作新音。
+ * - 可信度迟滞：未发声的键须可信度 >= [Config::onConfidence] 才算出现，
+ *   发声中的键只需 >= [Config::sustainConfidence]，避免在阈值附近反复开关。
+ * - 时间迟滞：平滑后连续 [Config::onHops] 帧出现才 NoteOn；连续 [Config::releaseHops] 帧缺席才 NoteOff。
+ * - 最短时长：NoteOff 不早于 NoteOn 后 [Config::minNoteMs]；单音模式下新音须等发声音满最短时长才顶替它，
+ *   交接记在两者较晚处。
+ *
+ * 时间戳（输入帧号，与 Oboe 回调累计读出的帧数一致）：平滑与确认只推迟事件的交付，不推迟时间戳。
+ * NoteOn 记在该键原始结果首次出现的帧上，若 [onFrame] 带有起音帧号（[PitchDetector] 起音门控）则记在
+ * 起音帧上；NoteOff 记在原始结果首次缺席的帧上。因此同一次 [onFrame] 产生的事件可能早于上一帧的
+ * framePosition，但同一琴键的事件总是先 On 后 Off、时间不减。
+ *
+ * 单音模式下起音窗口（[Config::onsetWindowFrames]）过去仍是同一个音，视为同音重击，补一对 NoteOff / NoteOn。
+ *
+ * 状态为定长数组，构造后不分配，可在音频回调线程使用；非线程安全，由检测线程独占。
+ */
+
+/** 事件类型，数值与 Kotlin NoteEvent.TYPE_* 对应 */
+enum class NoteEventType : int32_t {
+    NoteOn = 0,
+    NoteOff = 1,
+};
+
+/** 定长 32 字节事件；字段顺序即 ByteBuffer 内布局（本机字节序） */
+struct NoteEvent {
+    int32_t type;          ///< [NoteEventType]
+    int32_t midiNote;      ///< 21..108
+    float volume;          ///< NoteOn：确认时的音量（力度）；NoteOff：0
+    float confidence;      ///< 触发帧（NoteOff 为最后一帧）可信度
+    float frequencyHz;     ///< 触发帧（NoteOff 为最后一帧）基频
+    float cents;           ///< 触发帧（NoteOff 为最后一帧）相对调律表该键中心的偏差（音分）
+    int64_t framePosition; ///< 事件发生的输入帧号（自 start 起）
+};
+
+static_assert(sizeof(NoteEvent) == 32, "NoteEvent layout is shared with Kotlin");
+
+class NoteTracker {
+public:
+    /** 平滑窗口上限 */
+    static constexpr int32_t kMaxSmoothingHops = 9;
+
+    struct Config {
+        bool monophonic = true;           ///< 单音：同一时刻至多一个活动音
+        int32_t smoothingHops = 3;        ///< 多数表决平滑帧数（奇数，1 表示不平滑），1..[kMaxSmoothingHops]
+        int32_t onHops = 1;               ///< 平滑后连续出现多少帧才 NoteOn
+        int32_t releaseHops = 2;          ///< 平滑后连续缺席多少帧才 NoteOff
+        float onConfidence = 0.3f;        ///< 未发声键的出现门限
+        float sustainConfidence = 0.1f;   ///< 发声中键的保持门限（<= onConfidence）
+        int32_t minNoteMs = 40;           ///< 最短音长
+        int32_t onsetWindowFrames = 2048; ///< 起音后多少帧内的新音使用起音时间戳（通常为分析窗口长度）
+    };
+
+    /** 一帧中检出的一个音 */
+    struct FrameNote {
+        int32_t midiNote;
+        float volume;
+        float confidence;
+        float frequencyHz;
+        float cents;
+    };
+
+    /** 事件出口：每产生一个事件调用一次 */
+    using EmitFn = void (*)(void* user, const NoteEvent& event);
+
+    NoteTracker() = default;
+
+    /** 设置参数与事件出口，并清空状态；不可与 [onFrame] 并发调用 */
+    void configure(const Config& config, int32_t sampleRate, EmitFn emitFn, void* user);
+
+    /** 清空全部状态（不产生事件） */
+    void reset();
+
+    /**
+     * 送入一帧识别结果。
+     * @param notes 本帧检出的音（midiNote 须在 0..127），count 为 0 表示无效/静音帧
+     * @param framePosition 该帧窗口末端的输入帧号
+     * @param onsetFrame 本帧新检出的起音帧号；无起音为 -1
+     */
+    void onFrame(const FrameNote* notes, int32_t count, int64_t framePosition, int64_t onsetFrame = -1);
+
+    /** 输入结束：为仍在发声的音补 NoteOff */
+    void finish(int64_t framePosition);
+
+    int32_t activeCount() const { return activeCount_; }
+    const Config& config() const { return config_; }
+
+private:
+    static constexpr int32_t kNumMidi = 128;
+
+    void emit(NoteEventType type, int32_t midiNote, float volume, int64_t framePosition);
+    void noteOn(int32_t midiNote, int64_t at);
+    void noteOff(int32_t midiNote, int64_t at);
+
+    Config config_;
+    int64_t minNoteFrames_{0};
+    EmitFn emitFn_{nullptr};
+    void* emitUser_{nullptr};
+
+    // --- 按 MIDI 号索引的状态 ---
+    bool active_[kNumMidi] = {};
+    /** 原始结果（过可信度门限后）的出现历史，bit0 为本帧 */
+    uint32_t rawBits_[kNumMidi] = {};
+    /** 原始结果最近一次开始出现 / 开始缺席的帧号 */
+    int64_t rawStart_[kNumMidi] = {};
+    int64_t rawEnd_[kNumMidi] = {};
+    /** 平滑后连续出现（未发声键）/ 连续缺席（发声键）的帧数 */
+    int32_t pendingRun_[kNumMidi] = {};
+    int32_t absentRun_[kNumMidi] = {};
+    /** 本键最近一次事件的帧号（发声中为 NoteOn 时间） */
+    int64_t eventFrame_[kNumMidi] = {};
+    /** 最近一次出现时的结果（供平滑后补出的音与 NoteOff 携带） */
+    float lastVolume_[kNumMidi] = {};
+    float lastConfidence_[kNumMidi] = {};
+    float lastFrequencyHz_[kNumMidi] = {};
+    float lastCents_[kNumMidi] = {};
+    int32_t activeCount_{0};
+
+    /** 单音模式的静音历史，bit0 为本帧 */
+    uint32_t silentBits_{0};
+    /** 单音模式上一帧的平滑结果，无音为 -1 */
+    int32_t monoSmoothed_{-1};
+
+    /** 尚未被新 NoteOn 使用的起音帧号；-1 表示无 */
+    int64_t pendingOnset_{-1};
+};
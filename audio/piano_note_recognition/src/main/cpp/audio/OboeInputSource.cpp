@@ -0,0 +1,89 @@
+#include "OboeInputSource.h"
+
+#include <oboe/Oboe.h>
+
+/**
+ * Oboe 音频数据就绪回调：把 float 缓冲交给 [InputSource::DataFn]。
+ */
+class OboeInputSource::CallbackImpl final : public oboe::AudioStreamCallback {
+public:
+    oboe::DataCallbackResult onAudioReady(oboe::AudioStream* stream,
+                                          void* audioData,
+                                          int32_t numFrames) override {
+        (void)stream;
+        if (fn != nullptr) fn(user, static_cast<const float*>(audioData), numFrames);
+        return oboe::DataCallbackResult::Continue;
+    }
+
+    /** 只在流关闭时修改（[OboeInputSource::open]） */
+    DataFn fn{nullptr};
+    void* user{nullptr};
+};
+
+OboeInputSource::OboeInputSource() : callback_(new CallbackImpl()) {}
+
+OboeInputSource::~OboeInputSource() {
+    close();
+    delete callback_;
+    callback_ = nullptr;
+}
+
+bool OboeInputSource::open(const Request& request, DataFn fn, void* user, Format& format) {
+    close();
+    callback_->fn = fn;
+    callback_->user = user;
+
+    // --- 输入流配置：低延迟、单声道 float；未指定时采样率取设备原生值，回调帧数不固定（按 burst）---
+    oboe::AudioStreamBuilder builder;
+    builder.setDirection(oboe::Direction::Input);
+    builder.setSharingMode(oboe::SharingMode::Shared);
+    builder.setPerformanceMode(oboe::PerformanceMode::LowLatency);
+    builder.setFormat(oboe::AudioFormat::Float);
+    builder.setChannelCount(1);
+    if (request.sampleRate > 0) {
+        builder.setSampleRate(request.sampleRate);
+    }
+    if (request.deviceId > 0) {
+        builder.setDeviceId(request.deviceId);
+    }
+    builder.setCallback(callback_);
+
+    builder.setUsage(oboe::Usage::Game);
+    builder.setContentType(oboe::ContentType::Music);
+
+    oboe::Result result = builder.openStream(stream_);
+    if (result != oboe::Result::OK || stream_ == nullptr) {
+        stream_.reset();
+        return false;
+    }
+    format.sampleRate = stream_->getSampleRate();
+    format.framesPerBurst = stream_->getFramesPerBurst();
+    return true;
+}
+
+bool OboeInputSource::start() {
+    if (stream_ == nullptr) return false;
+    return stream_->requestStart() == oboe::Result::OK;
+}
+
+void OboeInputSource::close() {
+    if (stream_ == nullptr) return;
+    // requestStop 返回后 Oboe 不再进入 onAudioReady
+    oboe::Result stopResult = stream_->requestStop();
+    (void)stopResult;
+    oboe::Result closeResult = stream_->close();
+    (void)closeResult;
+    // 释放流对象本身（close 只释放底层设备资源）
+    stream_.reset();
+}
+
+bool OboeInputSource::captureTimestamp(int64_t& framePosition, int64_t& timeNs) {
+    if (stream_ == nullptr) return false;
+    return stream_->getTimestamp(CLOCK_MONOTONIC, &framePosition, &timeNs) == oboe::Result::OK;
+}
+
+int32_t OboeInputSource::xRunCount() {
+    if (stream_ == nullptr || !stream_->isXRunCountSupported()) return -1;
+    const auto xruns = stream_->getXRunCount();
+    return xruns ? xruns.value() : -1;
+}
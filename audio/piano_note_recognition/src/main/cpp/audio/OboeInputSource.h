@@ -0,0 +1,36 @@
+#pragma once
+
+#include "InputSource.h"
+
+#include <memory>
+
+namespace oboe {
+class AudioStream;
+}
+
+/**
+ * @class OboeInputSource
+ * @brief Oboe 低延迟输入流：单声道 float，采样率未指定时取设备原生值，回调帧数按 burst 不固定
+ *
+ * 数据回调在 Oboe 音频线程上直接转给 [InputSource::DataFn]；采集时间戳取自 AudioStream::getTimestamp（CLOCK_MONOTONIC）。
+ * 只随 JNI 库构建（依赖 Oboe）。
+ */
+class OboeInputSource final : public InputSource {
+public:
+    OboeInputSource();
+    ~OboeInputSource() override;
+
+    OboeInputSource(const OboeInputSource&) = delete;
+    OboeInputSource& operator=(const OboeInputSource&) = delete;
+
+    bool open(const Request& request, DataFn fn, void* user, Format& format) override;
+    bool start() override;
+    void close() override;
+    bool captureTimestamp(int64_t& framePosition, int64_t& timeNs) override;
+    int32_t xRunCount() override;
+
+private:
+    class CallbackImpl;
+    CallbackImpl* callback_{nullptr};
+    std::shared_ptr<oboe::AudioStream> stream_;
+};
@@ -0,0 +1,156 @@
+#include "OfflineAnalyzer.h"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <thread>
+
+#include "../PitchDetector.h"
+#include "WavReader.h"
+
+namespace {
+/** 与 [AudioEngine] 相同：2048 点窗口 */
+constexpr int32_t kWindowSize = FFTWrapper::kFftSize;
+}
+
+OfflineAnalyzer::OfflineAnalyzer(const Config& config) : config_(config) {
+    config_.chunkHops = std::max(config_.chunkHops, 1);
+    config_.hopSize = std::clamp(config_.hopSize, 1, kWindowSize);
+    if (config_.numThreads <= 0) {
+        config_.numThreads = std::max<int32_t>(static_cast<int32_t>(std::thread::hardware_concurrency()), 1);
+    }
+    config_.tracking.monophonic = !config_.polyphonic;
+    config_.tracking.onsetWindowFrames = kWindowSize;
+}
+
+int64_t OfflineAnalyzer::frameEnd(int64_t hop, int64_t numSamples) const {
+    return std::min((hop + 1) * config_.hopSize, numSamples);
+}
+
+void OfflineAnalyzer::collect(void* user, const NoteEvent& event) {
+    static_cast<std::vector<NoteEvent>*>(user)->push_back(event);
+}
+
+bool OfflineAnalyzer::analyze(const float* samples, int64_t numSamples, int32_t sampleRate,
+                              std::vector<NoteEvent>& events) {
+    events.clear();
+    if (samples == nullptr || numSamples < 0 || sampleRate <= 0) return false;
+    if (numSamples < kWindowSize) return true;
+
+    // --- 帧范围：窗口末端首次攒够 2048 个样本的 hop 起，到含末尾不足 hop 样本的最后一帧 ---
+    const int32_t hop = config_.hopSize;
+    const int64_t totalHops = (numSamples + hop - 1) / hop;
+    const int64_t firstHop = (kWindowSize + hop - 1) / hop - 1;
+    const int64_t numHops = totalHops - firstHop;
+    const int64_t numChunks = (numHops + config_.chunkHops - 1) / config_.chunkHops;
+
+    std::vector<ChunkResult> chunks(static_cast<size_t>(numChunks));
+    std::atomic<int64_t> nextChunk{0};
+    const float rate = static_cast<float>(sampleRate);
+
+    // --- 并行检测：调用线程也作为一个工作线程 ---
+    const int32_t numWorkers = static_cast<int32_t>(std::min<int64_t>(config_.numThreads, numChunks));
+    std::vector<std::thread> threads;
+    threads.reserve(static_cast<size_t>(numWorkers - 1));
+    for (int32_t i = 1; i < numWorkers; ++i) {
+        threads.emplace_back([&] { worker(samples, numSamples, rate, firstHop, numHops, nextChunk, chunks); });
+    }
+    worker(samples, numSamples, rate, firstHop, numHops, nextChunk, chunks);
+    for (auto& t : threads) t.join();
+
+    // --- 串行跟踪：按帧序送入同一个状态机，事件与切块方式无关 ---
+    NoteTracker tracker;
+    tracker.configure(config_.tracking, sampleRate, &OfflineAnalyzer::collect, &events);
+    for (ChunkResult& chunk : chunks) {
+        const NoteTracker::FrameNote* notes = chunk.notes.data();
+        for (size_t i = 0; i < chunk.counts.size(); ++i) {
+            tracker.onFrame(notes, chunk.counts[i], chunk.framePositions[i], chunk.onsetFrames[i]);
+            notes += chunk.counts[i];
+        }
+        // 跟踪完即释放，长文件峰值内存只多一份事件数组
+        chunk = ChunkResult();
+    }
+    tracker.finish(numSamples);
+    return true;
+}
+
+bool OfflineAnalyzer::analyzeFile(const char* path, std::vector<NoteEvent>& events) {
+    std::vector<float> samples;
+    int32_t sampleRate = 0;
+    if (!readWavFile(path, samples, sampleRate)) {
+        events.clear();
+        return false;
+    }
+    return analyze(samples.data(), static_cast<int64_t>(samples.size()), sampleRate, events);
+}
+
+void OfflineAnalyzer::worker(const float* samples, int64_t numSamples, float sampleRate, int64_t firstHop,
+                             int64_t numHops, std::atomic<int64_t>& nextChunk,
+                             std::vector<ChunkResult>& chunks) const {
+    // 每个线程独占一个检测器；多分辨率窗口前部不足 8192 时在 scratch 中补 0
+    auto detector = std::make_unique<PitchDetector>();
+    detector->prepare(sampleRate, config_.hopSize);
+    detector->setOnsetGating(config_.onsetGating);
+    detector->setNoiseWhitening(config_.noiseWhitening);
+    detector->setTuning(config_.tuning);
+    PolyphonicDetector::Config polyConfig;
+    polyConfig.maxNotes = config_.maxNotes;
+    detector->setPolyphonicConfig(polyConfig);
+    const int32_t length = config_.multiResolution && !config_.polyphonic ? PitchDetector::kLongFftSize : kWindowSize;
+    std::vector<float> scratch(static_cast<size_t>(length));
+
+    const int64_t numChunks = static_cast<int64_t>(chunks.size());
+    for (int64_t c = nextChunk.fetch_add(1); c < numChunks; c = nextChunk.fetch_add(1)) {
+        const int64_t begin = c * config_.chunkHops;
+        const int64_t end = std::min(begin + config_.chunkHops, numHops);
+        ChunkResult& out = chunks[static_cast<size_t>(c)];
+        out.counts.reserve(static_cast<size_t>(end - begin));
+        out.framePositions.reserve(static_cast<size_t>(end - begin));
+        out.onsetFrames.reserve(static_cast<size_t>(end - begin));
+        out.notes.reserve(static_cast<size_t>(end - begin));
+
+        detector->reset();
+        for (int64_t h = std::max<int64_t>(begin - kWarmupHops, 0); h < end; ++h) {
+            const int64_t frameEndPos = frameEnd(firstHop + h, numSamples);
+            const float* window;
+            if (frameEndPos >= length) {
+                window = samples + (frameEndPos - length);
+            } else {
+                const size_t pad = static_cast<size_t>(length - frameEndPos);
+                std::fill_n(scratch.data(), pad, 0.0f);
+                std::memcpy(scratch.data() + pad, samples, static_cast<size_t>(frameEndPos) * sizeof(float));
+                window = scratch.data();
+            }
+            const float* recent = window + (length - kWindowSize);
+
+            NoteTracker::FrameNote frameNotes[PolyphonicDetector::kMaxNotes];
+            int32_t frameCount = 0;
+            int32_t onsetLag = -1;
+            if (config_.polyphonic) {
+                const auto chord = detector->processPolyphonic(recent, kWindowSize, sampleRate);
+                onsetLag = chord.onsetLag;
+                for (int32_t i = 0; i < chord.numNotes; ++i) {
+                    const auto& n = chord.notes[i];
+                    frameNotes[frameCount++] = NoteTracker::FrameNote{n.midiNote, n.volume, n.confidence, n.frequencyHz, n.cents};
+                }
+            } else {
+                const auto result = config_.multiResolution
+                                        ? detector->processMultiResolution(window, length, sampleRate)
+                                        : detector->process(recent, kWindowSize, sampleRate);
+                onsetLag = result.onsetLag;
+                if (result.midiNote >= 0) {
+                    frameNotes[frameCount++] =
+                        NoteTracker::FrameNote{result.midiNote, result.volume, result.confidence, result.frequencyHz,
+                                               result.cents};
+                }
+            }
+
+            // 预热帧只用于建立门控历史
+            if (h < begin) continue;
+            out.notes.insert(out.notes.end(), frameNotes, frameNotes + frameCount);
+            out.counts.push_back(frameCount);
+            out.framePositions.push_back(frameEndPos);
+            out.onsetFrames.push_back(onsetLag >= 0 ? frameEndPos - onsetLag : -1);
+        }
+    }
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "../dsp/TuningTable.h"
+#include "NoteTracker.h"
+
+/**
+ * @class OfflineAnalyzer
+ * @brief 离线批量识别：整段 PCM（或 WAV 文件）-> 与实时路径相同的 [PitchDetector] 逐帧检测 -> note-on/off 事件数组
+ *
+ * 帧划分与 [AudioEngine] 一致：每 [Config::hopSize] 个样本一帧，窗口末端为该 hop 末尾，攒够 2048 个样本后开始检测；
+ * 末尾不足一个 hop 的样本也滑入并检测一次。多分辨率模式下 8192 点窗口前部不足时补 0。
+ *
+ * 并行：帧序列按 [Config::chunkHops] 切块，工作线程从原子计数器领取块，每个线程独占一个 [PitchDetector]。
+ * 每帧窗口直接取自输入缓冲（不滑窗），块之间没有共享状态，吞吐随核数近似线性增长。
+ * 起音门控有跨帧状态：每块先多跑 [kWarmupHops] 帧预热（结果丢弃），与整段串行处理的差异限于门控判决。
+ * 噪声底白化（[Config::noiseWhitening]）的跟踪窗口约 1 s，长于预热：块首约 1 s 内噪声底与整段处理不同，
+ * 可信度会略有出入，临界帧（如起音的前一两帧）的判决也可能不同；关闭白化且不开门控时事件与切块方式无关。
+ * 逐帧结果全部就绪后，由调用线程串行送入一个 [NoteTracker]，按产生顺序连续输出。
+ *
+ * 内存：逐帧结果按块暂存（单音约 36 字节/帧，1 小时 48k 约 12 MB），跟踪完一块即释放；分析期间会分配，不可在音频线程调用。
+ */
+class OfflineAnalyzer {
+public:
+    /** 每块预热帧数：覆盖起音门控的通量历史与刷新周期 */
+    static constexpr int32_t kWarmupHops = 16;
+
+    struct Config {
+        bool polyphonic = false;      ///< 多音模式（同 [AudioEngine::setPolyphonic]）
+        int32_t maxNotes = 6;         ///< 多音模式每帧最多音数
+        bool multiResolution = false; ///< 多分辨率（单音），同 [AudioEngine::setMultiResolution]
+        bool onsetGating = false;     ///< 起音门控，同 [AudioEngine::setOnsetGating]
+        bool noiseWhitening = true;   ///< 噪声底白化，同 [AudioEngine::setNoiseWhitening]
+        TuningTable tuning;           ///< 调律表，同 [AudioEngine::setTuning]；默认 440 Hz 十二平均律
+        NoteTracker::Config tracking; ///< 事件状态机参数；monophonic 与 onsetWindowFrames 按模式覆盖
+        int32_t hopSize = 512;        ///< 帧移，1..2048（与实时路径默认值相同）
+        int32_t numThreads = 0;       ///< 工作线程数；<=0 取硬件并发数
+        int32_t chunkHops = 256;      ///< 每块帧数（约 2.7 s @48k），兼顾负载均衡与预热开销
+    };
+
+    OfflineAnalyzer() : OfflineAnalyzer(Config{}) {}
+    explicit OfflineAnalyzer(const Config& config);
+
+    /**
+     * 识别一段单声道 PCM；可重复调用，各次互不影响。
+     * @param samples 样本（-1..1）
+     * @param numSamples 样本数
+     * @param sampleRate 采样率 Hz（任意原生采样率，派生表按此重建）
+     * @param events 输出事件，按 [NoteTracker] 产生顺序；时间戳为输入样本序号
+     * @return 参数有效为 true（输入短于一个窗口时返回 true 且无事件）
+     */
+    bool analyze(const float* samples, int64_t numSamples, int32_t sampleRate, std::vector<NoteEvent>& events);
+
+    /** 读取 WAV 文件（见 [readWavFile]）后调用 [analyze]；文件不可读或格式不支持返回 false */
+    bool analyzeFile(const char* path, std::vector<NoteEvent>& events);
+
+    const Config& config() const { return config_; }
+
+private:
+    /** 一块的逐帧结果；notes 按帧连续存放，每帧 counts[i] 个 */
+    struct ChunkResult {
+        std::vector<NoteTracker::FrameNote> notes;
+        std::vector<int32_t> counts;
+        std::vector<int64_t> framePositions;
+        std::vector<int64_t> onsetFrames;
+    };
+
+    /** 第 hop 帧窗口末端的样本序号 */
+    int64_t frameEnd(int64_t hop, int64_t numSamples) const;
+
+    /** 工作线程主体：从 nextChunk 领取块直到取完 */
+    void worker(const float* samples, int64_t numSamples, float sampleRate, int64_t firstHop, int64_t numHops,
+                std::atomic<int64_t>& nextChunk, std::vector<ChunkResult>& chunks) const;
+
+    /** 逐帧结果交给 [NoteTracker] 的事件出口 */
+    static void collect(void* user, const NoteEvent& event);
+
+    Config config_;
+};
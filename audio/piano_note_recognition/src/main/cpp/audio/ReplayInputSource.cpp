@@ -0,0 +1,178 @@
+#include "ReplayInputSource.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+
+#include "../dsp/StageStats.h"
+#include "WavReader.h"
+
+namespace {
+/** 裸 PCM 分块读取的样本数 */
+constexpr size_t kReadSamples = 4096;
+
+struct FileCloser {
+    void operator()(FILE* f) const { std::fclose(f); }
+};
+} // namespace
+
+ReplayInputSource::ReplayInputSource(const Config& config) {
+    setConfig(config);
+}
+
+ReplayInputSource::~ReplayInputSource() {
+    close();
+}
+
+bool ReplayInputSource::setConfig(const Config& config) {
+    if (opened_) return false;
+    config_ = config;
+    config_.blockFrames = std::max(config_.blockFrames, 1);
+    if (!(config_.speed > 0.0f)) config_.speed = 1.0f;
+    return true;
+}
+
+bool ReplayInputSource::loadWav(const char* path) {
+    if (opened_) return false;
+    int32_t sampleRate = 0;
+    if (!readWavFile(path, samples_, sampleRate) || sampleRate <= 0) {
+        samples_.clear();
+        sampleRate_ = 0;
+        return false;
+    }
+    sampleRate_ = sampleRate;
+    return true;
+}
+
+bool ReplayInputSource::loadRawPcm(const char* path, int32_t sampleRate, RawFormat format) {
+    if (opened_ || path == nullptr || sampleRate <= 0) return false;
+    std::unique_ptr<FILE, FileCloser> file(std::fopen(path, "rb"));
+    if (!file) return false;
+
+    const size_t bytesPerSample = format == RawFormat::Float32 ? 4 : 2;
+    std::vector<uint8_t> raw(kReadSamples * bytesPerSample);
+    samples_.clear();
+    for (;;) {
+        const size_t n = std::fread(raw.data(), bytesPerSample, kReadSamples, file.get());
+        for (size_t i = 0; i < n; ++i) {
+            const uint8_t* p = raw.data() + i * bytesPerSample;
+            if (format == RawFormat::Float32) {
+                const uint32_t u = static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+                                   (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+                float v;
+                std::memcpy(&v, &u, sizeof(v));
+                samples_.push_back(v);
+            } else {
+                const auto v = static_cast<int16_t>(static_cast<uint16_t>(p[0] | (p[1] << 8)));
+                samples_.push_back(static_cast<float>(v) / 32768.0f);
+            }
+        }
+        if (n < kReadSamples) break;
+    }
+    if (samples_.empty()) {
+        sampleRate_ = 0;
+        return false;
+    }
+    sampleRate_ = sampleRate;
+    return true;
+}
+
+bool ReplayInputSource::setSamples(const float* samples, int64_t numSamples, int32_t sampleRate) {
+    if (opened_ || samples == nullptr || numSamples <= 0 || sampleRate <= 0) return false;
+    samples_.assign(samples, samples + numSamples);
+    sampleRate_ = sampleRate;
+    return true;
+}
+
+bool ReplayInputSource::waitUntilFinished(int64_t timeoutMs) {
+    std::unique_lock<std::mutex> lock(finishedMutex_);
+    const auto done = [this] { return finished_.load(std::memory_order_acquire); };
+    if (timeoutMs <= 0) {
+        finishedCv_.wait(lock, done);
+        return true;
+    }
+    return finishedCv_.wait_for(lock, std::chrono::milliseconds(timeoutMs), done);
+}
+
+bool ReplayInputSource::open(const Request& request, DataFn fn, void* user, Format& format) {
+    (void)request;
+    close();
+    if (samples_.empty() || sampleRate_ <= 0) return false;
+    fn_ = fn;
+    user_ = user;
+    finished_.store(false, std::memory_order_release);
+    lateBlocks_.store(0, std::memory_order_relaxed);
+    blockFramePosition_ = 0;
+    blockTimeNs_ = 0;
+    opened_ = true;
+    format.sampleRate = sampleRate_;
+    format.framesPerBurst = config_.blockFrames;
+    return true;
+}
+
+bool ReplayInputSource::start() {
+    if (!opened_ || thread_.joinable()) return false;
+    stopRequested_.store(false, std::memory_order_release);
+    thread_ = std::thread([this] { run(); });
+    return true;
+}
+
+void ReplayInputSource::close() {
+    if (thread_.joinable()) {
+        stopRequested_.store(true, std::memory_order_release);
+        thread_.join();
+    }
+    opened_ = false;
+    fn_ = nullptr;
+    user_ = nullptr;
+}
+
+bool ReplayInputSource::captureTimestamp(int64_t& framePosition, int64_t& timeNs) {
+    if (config_.pacing != Pacing::RealTime || config_.speed != 1.0f || blockTimeNs_ == 0) return false;
+    framePosition = blockFramePosition_;
+    timeNs = blockTimeNs_;
+    return true;
+}
+
+int32_t ReplayInputSource::xRunCount() {
+    if (!opened_) return -1;
+    return lateBlocks_.load(std::memory_order_relaxed);
+}
+
+void ReplayInputSource::run() {
+    const auto total = static_cast<int64_t>(samples_.size());
+    const int64_t block = config_.blockFrames;
+    const double nsPerFrame = 1e9 / static_cast<double>(sampleRate_) / static_cast<double>(config_.speed);
+    const bool paced = config_.pacing == Pacing::RealTime;
+    // 与 [StageStats::nowNs] 同一时钟，EndToEnd 可直接相减
+    const int64_t startNs = StageStats::nowNs();
+
+    for (int64_t offset = 0; offset < total; offset += block) {
+        if (stopRequested_.load(std::memory_order_acquire)) break;
+        const int64_t n = std::min(block, total - offset);
+        if (paced) {
+            // 块内最后一帧采集完成时才交付，与设备回调一致
+            const int64_t dueNs = startNs + static_cast<int64_t>(static_cast<double>(offset + n) * nsPerFrame);
+            const int64_t nowNs = StageStats::nowNs();
+            if (nowNs < dueNs) {
+                std::this_thread::sleep_for(std::chrono::nanoseconds(dueNs - nowNs));
+            } else if (nowNs - dueNs > static_cast<int64_t>(static_cast<double>(block) * nsPerFrame)) {
+                lateBlocks_.fetch_add(1, std::memory_order_relaxed);
+            }
+            blockFramePosition_ = offset + n;
+            blockTimeNs_ = dueNs;
+        }
+        if (fn_ != nullptr) fn_(user_, samples_.data() + offset, static_cast<int32_t>(n));
+    }
+    markFinished();
+}
+
+void ReplayInputSource::markFinished() {
+    {
+        std::lock_guard<std::mutex> lock(finishedMutex_);
+        finished_.store(true, std::memory_order_release);
+    }
+    finishedCv_.notify_all();
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "InputSource.h"
+
+/**
+ * @class ReplayInputSource
+ * @brief 录音回放输入源：把整段 PCM 按定长块推给 [AudioEngine]，使滑窗、检测、回调与事件批量整条实时路径
+ *        可以在主机上以确定的输入压测
+ *
+ * 节奏（[Pacing]）：
+ * - RealTime：每块在其最后一帧的时刻推送（第 k 块为 start 后 (k + 1) * blockFrames / sampleRate / speed 秒），模拟设备回调；
+ *   speed 为 1 时采集时间戳取各块的计划时刻，EndToEnd 含回放线程的唤醒抖动；倍速回放不提供采集时间戳。
+ *   推送时已落后计划超过一块计为一次 xrun。倍速回放可在较短时间内压测 Pipelined 的分析线程 / 线程池。
+ * - Unpaced：不限速，上一块返回即推下一块，用于测吞吐；不提供采集时间戳（引擎按到达时刻近似）。
+ *   Pipelined 模式下推送快于分析时会按引擎的队列满 / [AudioEngine::BackPressure] 处理，结果与实时节奏不同；
+ *   需要与实时路径逐帧一致的结果时用 Inline 模式。
+ *
+ * 数据：[loadWav]（见 [readWavFile]）、[loadRawPcm]（无头单声道 little-endian float32 / int16）或 [setSamples]。
+ * 不做重采样：[InputSource::Request::sampleRate] 被忽略，实际采样率为数据的采样率。
+ * 回放到末尾后停止推送并标记结束（[finished] / [waitUntilFinished]），仍须由引擎 stop 关闭。
+ */
+class ReplayInputSource final : public InputSource {
+public:
+    enum class Pacing {
+        RealTime,
+        Unpaced,
+    };
+
+    /** [loadRawPcm] 的样本格式 */
+    enum class RawFormat {
+        Float32,
+        Int16,
+    };
+
+    struct Config {
+        Pacing pacing = Pacing::RealTime;
+        int32_t blockFrames = 192; ///< 每次回调的帧数（常见设备 burst 为 192 / 240）
+        float speed = 1.0f;        ///< RealTime 的回放倍速，> 0
+    };
+
+    ReplayInputSource() : ReplayInputSource(Config{}) {}
+    explicit ReplayInputSource(const Config& config);
+    ~ReplayInputSource() override;
+
+    ReplayInputSource(const ReplayInputSource&) = delete;
+    ReplayInputSource& operator=(const ReplayInputSource&) = delete;
+
+    /** 读取 WAV 文件（多声道混为单声道）；打开状态下调用返回 false */
+    bool loadWav(const char* path);
+
+    /** 读取无头裸 PCM（单声道 little-endian）；打开状态下调用返回 false */
+    bool loadRawPcm(const char* path, int32_t sampleRate, RawFormat format);
+
+    /** 拷贝一段内存样本；打开状态下调用返回 false */
+    bool setSamples(const float* samples, int64_t numSamples, int32_t sampleRate);
+
+    /** 修改节奏与块长；打开状态下调用返回 false */
+    bool setConfig(const Config& config);
+
+    int64_t numSamples() const { return static_cast<int64_t>(samples_.size()); }
+    int32_t sampleRate() const { return sampleRate_; }
+
+    /** 回放已结束：全部样本推送完毕，或被 [close] 提前终止 */
+    bool finished() const { return finished_.load(std::memory_order_acquire); }
+
+    /**
+     * 阻塞到回放结束或超时。
+     * @param timeoutMs <=0 表示一直等待
+     * @return 已结束为 true
+     */
+    bool waitUntilFinished(int64_t timeoutMs = 0);
+
+    bool open(const Request& request, DataFn fn, void* user, Format& format) override;
+    bool start() override;
+    void close() override;
+    bool captureTimestamp(int64_t& framePosition, int64_t& timeNs) override;
+    int32_t xRunCount() override;
+
+private:
+    /** 回放线程主体 */
+    void run();
+    void markFinished();
+
+    Config config_;
+    std::vector<float> samples_;
+    int32_t sampleRate_{0};
+
+    DataFn fn_{nullptr};
+    void* user_{nullptr};
+    bool opened_{false};
+
+    std::thread thread_;
+    std::atomic<bool> stopRequested_{false};
+    std::atomic<bool> finished_{false};
+    std::mutex finishedMutex_;
+    std::condition_variable finishedCv_;
+
+    /** 回放线程写、回放线程读（[captureTimestamp] 在数据回调内调用）：最近一块的起始帧与计划时刻 */
+    int64_t blockFramePosition_{0};
+    int64_t blockTimeNs_{0};
+    std::atomic<int32_t> lateBlocks_{0};
+};
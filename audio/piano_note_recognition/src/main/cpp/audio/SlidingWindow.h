@@ -0,0 +1,74 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+/**
+ * @class SlidingWindow
+ * @brief 定长滑窗：镜像环形缓冲，最新 [length] 个样本始终可作为一段连续内存读取，推进时不搬移旧样本
+ *
+ * 说明：
+ * - 存储为 2 × length，每个样本同时写入 i 与 i + length 两处；设写指针为 w（最旧样本位置），
+ *   则 [w, w + length) 恰为按时间顺序排列的整窗，[data] 直接返回该段指针。
+ * - 每次 [push] 的开销只与新样本数成正比（写两份），与窗口长度无关；
+ *   相比“左移整窗 + 尾部追加”，2048 点窗口每 512 帧 hop 的内存流量约减半，8192 点长窗约降到 1/8。
+ * - 冷启动时尚未写入的部分为 0（检测器据 [filled] 判断是否已攒够）。
+ * - 构造 / [resize] 时分配，[push] / [clear] 不分配，可在音频线程调用。
+ */
+class SlidingWindow {
+public:
+    explicit SlidingWindow(int32_t length = 0) { resize(length); }
+
+    /** 改变窗口长度并清零（分配，勿在音频线程调用） */
+    void resize(int32_t length) {
+        length_ = std::max(length, 0);
+        storage_.assign(static_cast<size_t>(length_) * 2, 0.0f);
+        writePos_ = 0;
+        filled_ = 0;
+    }
+
+    /** 清零并重置已填充计数（输入不连续时调用） */
+    void clear() {
+        std::fill(storage_.begin(), storage_.end(), 0.0f);
+        writePos_ = 0;
+        filled_ = 0;
+    }
+
+    /** 追加 numFrames 个新样本；超过窗口长度时只保留最新的 [length] 个 */
+    void push(const float* input, int32_t numFrames) {
+        if (numFrames <= 0 || length_ == 0) return;
+        filled_ = std::min<int64_t>(static_cast<int64_t>(filled_) + numFrames, length_);
+        if (numFrames > length_) {
+            input += numFrames - length_;
+            numFrames = length_;
+        }
+        // 至多两段：写到缓冲尾部后回绕
+        while (numFrames > 0) {
+            const int32_t n = std::min(numFrames, length_ - writePos_);
+            const size_t bytes = static_cast<size_t>(n) * sizeof(float);
+            std::memcpy(storage_.data() + writePos_, input, bytes);
+            std::memcpy(storage_.data() + writePos_ + length_, input, bytes);
+            writePos_ += n;
+            if (writePos_ == length_) writePos_ = 0;
+            input += n;
+            numFrames -= n;
+        }
+    }
+
+    /** 整窗（最旧在前、最新在末端），长度 [length]；下次 [push] 前有效 */
+    const float* data() const { return storage_.data() + writePos_; }
+
+    int32_t length() const { return length_; }
+
+    /** 自构造 / [clear] 起已写入的样本数，封顶于 [length] */
+    int32_t filled() const { return filled_; }
+
+private:
+    std::vector<float> storage_;
+    int32_t length_{0};
+    /** 下一个写入位置，同时是当前整窗的起点 */
+    int32_t writePos_{0};
+    int32_t filled_{0};
+};
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @class SpscRingBuffer
+ * @brief 单生产者单消费者环形队列：固定容量、构造后不分配，两端均 wait-free
+ *
+ * 说明：
+ * - 容量向上取整为 2 的幂；读写索引单调递增，取模用掩码，满/空由差值判断，不浪费槽位。
+ * - 生产者只写 [writeIndex_]、消费者只写 [readIndex_]，各自 release 发布 / acquire 观察对端，无 CAS、无锁。
+ * - 原地读写：[writeSlot] 取空槽就地填充后 [publish]；[readSlot] 读完后 [release]，
+ *   避免大元素（如整包 PCM）在队列两端各拷贝一次。
+ * - 两个索引分处不同缓存行，避免生产/消费线程伪共享。
+ */
+template <typename T>
+class SpscRingBuffer {
+public:
+    /** @param capacity 最少可容纳的元素数（>= 1） */
+    explicit SpscRingBuffer(int32_t capacity) {
+        int32_t n = 1;
+        while (n < capacity) n <<= 1;
+        slots_.resize(n);
+        mask_ = static_cast<uint32_t>(n - 1);
+    }
+
+    SpscRingBuffer(const SpscRingBuffer&) = delete;
+    SpscRingBuffer& operator=(const SpscRingBuffer&) = delete;
+
+    int32_t capacity() const { return static_cast<int32_t>(slots_.size()); }
+
+    // --- 生产者侧 ---
+
+    /** 下一个可写槽；队列满时返回 nullptr */
+    T* writeSlot() {
+        const uint32_t w = writeIndex_.load(std::memory_order_relaxed);
+        const uint32_t r = readIndex_.load(std::memory_order_acquire);
+        if (w - r > mask_) return nullptr;
+        return &slots_[w & mask_];
+    }
+
+    /** 提交 [writeSlot] 返回的槽，对消费者可见 */
+    void publish() {
+        writeIndex_.store(writeIndex_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    // --- 消费者侧 ---
+
+    /** 最早的已提交元素；队列空时返回 nullptr */
+    const T* readSlot() const {
+        const uint32_t r = readIndex_.load(std::memory_order_relaxed);
+        const uint32_t w = writeIndex_.load(std::memory_order_acquire);
+        if (w == r) return nullptr;
+        return &slots_[r & mask_];
+    }
+
+    /** 释放 [readSlot] 返回的槽，归还给生产者 */
+    void release() {
+        readIndex_.store(readIndex_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    /** 当前元素数；跨线程调用时只是近似快照 */
+    int32_t size() const {
+        const uint32_t w = writeIndex_.load(std::memory_order_acquire);
+        const uint32_t r = readIndex_.load(std::memory_order_acquire);
+        return static_cast<int32_t>(w - r);
+    }
+
+    /** 清空；只能在生产者与消费者都停止时调用 */
+    void clear() {
+        writeIndex_.store(0, std::memory_order_relaxed);
+        readIndex_.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    std::vector<T> slots_;
+    uint32_t mask_{0};
+
+    alignas(64) std::atomic<uint32_t> writeIndex_{0};
+    alignas(64) std::atomic<uint32_t> readIndex_{0};
+};
@@ -0,0 +1,128 @@
+#include "WavReader.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+
+namespace {
+constexpr uint16_t kFormatPcm = 1;
+constexpr uint16_t kFormatFloat = 3;
+constexpr uint16_t kFormatExtensible = 0xFFFE;
+
+/** 分块读取的帧数，避免整文件原始字节再占一份内存 */
+constexpr size_t kReadFrames = 4096;
+
+uint16_t le16(const uint8_t* p) { return static_cast<uint16_t>(p[0] | (p[1] << 8)); }
+uint32_t le32(const uint8_t* p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) | (static_cast<uint32_t>(p[2]) << 16) |
+           (static_cast<uint32_t>(p[3]) << 24);
+}
+
+/** 一个样本（小端）-> float */
+float decodeSample(const uint8_t* p, uint16_t format, uint16_t bits) {
+    if (format == kFormatFloat) {
+        float v;
+        const uint32_t u = le32(p);
+        std::memcpy(&v, &u, sizeof(v));
+        return v;
+    }
+    switch (bits) {
+        case 16:
+            return static_cast<float>(static_cast<int16_t>(le16(p))) / 32768.0f;
+        case 24: {
+            // 符号扩展：放到高 24 位再算术右移
+            const uint32_t u = static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+                               (static_cast<uint32_t>(p[2]) << 16);
+            const int32_t v = static_cast<int32_t>(u << 8) >> 8;
+            return static_cast<float>(v) / 8388608.0f;
+        }
+        default:
+            return static_cast<float>(static_cast<int32_t>(le32(p))) / 2147483648.0f;
+    }
+}
+
+struct FileCloser {
+    void operator()(FILE* f) const { std::fclose(f); }
+};
+} // namespace
+
+bool readWavFile(const char* path, std::vector<float>& samples, int32_t& sampleRate) {
+    if (path == nullptr) return false;
+    std::unique_ptr<FILE, FileCloser> file(std::fopen(path, "rb"));
+    if (!file) return false;
+
+    uint8_t header[12];
+    if (std::fread(header, 1, sizeof(header), file.get()) != sizeof(header)) return false;
+    if (std::memcmp(header, "RIFF", 4) != 0 || std::memcmp(header + 8, "WAVE", 4) != 0) return false;
+
+    uint16_t format = 0;
+    uint16_t channels = 0;
+    uint16_t bits = 0;
+    uint32_t rate = 0;
+    bool haveFormat = false;
+
+    // --- 逐块扫描：fmt 取格式，data 读样本，其余跳过（块长为奇数时有 1 字节填充）---
+    uint8_t chunk[8];
+    while (std::fread(chunk, 1, sizeof(chunk), file.get()) == sizeof(chunk)) {
+        const uint32_t size = le32(chunk + 4);
+        if (std::memcmp(chunk, "fmt ", 4) == 0) {
+            uint8_t fmt[40] = {};
+            const uint32_t n = size < sizeof(fmt) ? size : static_cast<uint32_t>(sizeof(fmt));
+            if (n < 16 || std::fread(fmt, 1, n, file.get()) != n) return false;
+            if (std::fseek(file.get(), static_cast<long>(size - n + (size & 1u)), SEEK_CUR) != 0) return false;
+            format = le16(fmt);
+            channels = le16(fmt + 2);
+            rate = le32(fmt + 4);
+            bits = le16(fmt + 14);
+            // EXTENSIBLE：子格式 GUID 的前两个字节即实际格式
+            if (format == kFormatExtensible && n >= 26) format = le16(fmt + 24);
+            haveFormat = true;
+            continue;
+        }
+        if (std::memcmp(chunk, "data", 4) != 0) {
+            if (std::fseek(file.get(), static_cast<long>(size + (size & 1u)), SEEK_CUR) != 0) return false;
+            continue;
+        }
+
+        if (!haveFormat || channels == 0 || rate == 0) return false;
+        const bool supported = (format == kFormatPcm && (bits == 16 || bits == 24 || bits == 32)) ||
+                               (format == kFormatFloat && bits == 32);
+        if (!supported) return false;
+
+        const size_t bytesPerSample = bits / 8;
+        const size_t frameBytes = bytesPerSample * channels;
+        // 以文件剩余长度为上限（流式写出的文件 data 块长可能为 0xFFFFFFFF）
+        const long dataStart = std::ftell(file.get());
+        if (dataStart < 0 || std::fseek(file.get(), 0, SEEK_END) != 0) return false;
+        const long fileEnd = std::ftell(file.get());
+        if (fileEnd < dataStart || std::fseek(file.get(), dataStart, SEEK_SET) != 0) return false;
+        const size_t available = static_cast<size_t>(fileEnd - dataStart);
+        const size_t totalFrames = std::min<size_t>(size, available) / frameBytes;
+        samples.resize(totalFrames);
+        sampleRate = static_cast<int32_t>(rate);
+
+        std::vector<uint8_t> raw(kReadFrames * frameBytes);
+        const float scale = 1.0f / static_cast<float>(channels);
+        size_t done = 0;
+        while (done < totalFrames) {
+            const size_t frames = std::fread(raw.data(), frameBytes, std::min(kReadFrames, totalFrames - done),
+                                             file.get());
+            if (frames == 0) {
+                samples.resize(done);
+                break;
+            }
+            for (size_t f = 0; f < frames; ++f) {
+                const uint8_t* p = raw.data() + f * frameBytes;
+                float sum = 0.0f;
+                for (uint16_t c = 0; c < channels; ++c) {
+                    sum += decodeSample(p + c * bytesPerSample, format, bits);
+                }
+                samples[done + f] = sum * scale;
+            }
+            done += frames;
+        }
+        return !samples.empty();
+    }
+    return false;
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * @file WavReader.h
+ * @brief 读取 RIFF/WAVE 文件为单声道 float PCM（离线分析用）
+ *
+ * 支持：PCM 16 / 24 / 32 位整数、IEEE float 32 位，以及 WAVE_FORMAT_EXTENSIBLE 中的同类子格式。
+ * 多声道按帧取平均混为单声道；不做重采样，采样率原样返回。
+ */
+
+/**
+ * 读取整个文件。
+ * @param path 文件路径
+ * @param samples 输出单声道样本（-1..1），失败时内容未定义
+ * @param sampleRate 输出采样率 Hz
+ * @return 格式受支持且读到至少一个样本为 true（data 块长超出文件时按实际长度截断）
+ */
+bool readWavFile(const char* path, std::vector<float>& samples, int32_t& sampleRate);
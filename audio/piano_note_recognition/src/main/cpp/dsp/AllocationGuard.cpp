@@ -0,0 +1,110 @@
+#include "AllocationGuard.h"
+
+#if defined(PIANO_NOTE_ALLOC_GUARD)
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+namespace {
+/** 计数与嵌套深度均为平凡类型的 thread_local，访问本身不会再触发 operator new */
+thread_local uint64_t tAllocationCount = 0;
+thread_local int32_t tRealtimeDepth = 0;
+
+std::atomic<bool> gFatal{true};
+
+void onAllocation(std::size_t size) {
+    ++tAllocationCount;
+    if (tRealtimeDepth > 0 && gFatal.load(std::memory_order_relaxed)) {
+        // 不依赖 NDEBUG：开启守卫即意味着要拦下，Release 下手动开启也一样生效
+        std::fprintf(stderr, "piano_note: heap allocation of %zu bytes inside RealtimeScope\n", size);
+        std::abort();
+    }
+}
+
+void* allocate(std::size_t size) {
+    onAllocation(size);
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+void* allocateAligned(std::size_t size, std::align_val_t align) {
+    onAllocation(size);
+    std::size_t alignment = static_cast<std::size_t>(align);
+    if (alignment < sizeof(void*)) alignment = sizeof(void*);
+    void* p = nullptr;
+    if (posix_memalign(&p, alignment, size == 0 ? 1 : size) != 0) return nullptr;
+    return p;
+}
+}
+
+RealtimeScope::RealtimeScope() { ++tRealtimeDepth; }
+
+RealtimeScope::~RealtimeScope() { --tRealtimeDepth; }
+
+bool allocationGuardEnabled() { return true; }
+
+uint64_t threadAllocationCount() { return tAllocationCount; }
+
+void setRealtimeAllocationFatal(bool fatal) { gFatal.store(fatal, std::memory_order_relaxed); }
+
+// --- 全局 operator new / delete 替换：malloc / free 为底，全部形式成对覆盖 ---
+
+void* operator new(std::size_t size) {
+    void* p = allocate(size);
+    if (p == nullptr) throw std::bad_alloc();
+    return p;
+}
+
+void* operator new[](std::size_t size) {
+    void* p = allocate(size);
+    if (p == nullptr) throw std::bad_alloc();
+    return p;
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return allocate(size); }
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return allocate(size); }
+
+void* operator new(std::size_t size, std::align_val_t align) {
+    void* p = allocateAligned(size, align);
+    if (p == nullptr) throw std::bad_alloc();
+    return p;
+}
+
+void* operator new[](std::size_t size, std::align_val_t align) {
+    void* p = allocateAligned(size, align);
+    if (p == nullptr) throw std::bad_alloc();
+    return p;
+}
+
+void* operator new(std::size_t size, std::align_val_t align, const std::nothrow_t&) noexcept {
+    return allocateAligned(size, align);
+}
+
+void* operator new[](std::size_t size, std::align_val_t align, const std::nothrow_t&) noexcept {
+    return allocateAligned(size, align);
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept { std::free(p); }
+
+#else
+
+bool allocationGuardEnabled() { return false; }
+
+uint64_t threadAllocationCount() { return 0; }
+
+void setRealtimeAllocationFatal(bool) {}
+
+#endif
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * @file AllocationGuard.h
+ * @brief 调试期堆分配守卫：捕获实时线程（Oboe 回调）上的 operator new
+ *
+ * 说明：
+ * - 定义 PIANO_NOTE_ALLOC_GUARD 时（CMake 在 Debug 构建或 -DPIANO_NOTE_ALLOC_GUARD=ON 时定义），
+ *   AllocationGuard.cpp 替换全局 operator new / delete：逐线程计数，并在 [RealtimeScope] 内的分配处 assert。
+ * - 未定义时 [RealtimeScope] 为空类，计数恒为 0，Release 构建零开销。
+ * - Android 上 libc++ 为共享库，替换只覆盖本库代码（含内联的 STL 模板）发起的分配，
+ *   正好是需要守护的范围；主机静态链接时覆盖整个进程。
+ * - 只拦截 operator new；直接调用 malloc 的代码不在守护范围内（本库中不应出现）。
+ */
+
+/**
+ * @class RealtimeScope
+ * @brief RAII：标记当前线程处于实时区（可嵌套）；区内任何 operator new 视为缺陷
+ */
+class RealtimeScope {
+public:
+#if defined(PIANO_NOTE_ALLOC_GUARD)
+    RealtimeScope();
+    ~RealtimeScope();
+#else
+    /** 非平凡的空构造：避免调用处被报告为未使用变量 */
+    RealtimeScope() {}
+#endif
+
+    RealtimeScope(const RealtimeScope&) = delete;
+    RealtimeScope& operator=(const RealtimeScope&) = delete;
+};
+
+/** 守卫是否编译启用 */
+bool allocationGuardEnabled();
+
+/** 当前线程累计的 operator new 次数（未启用时恒为 0）；基准用差值统计每帧分配数 */
+uint64_t threadAllocationCount();
+
+/**
+ * 实时区内分配是否 assert（默认 true）。
+ * 基准需要“数出”分配而非中止时临时关闭；只影响 assert，计数照常。
+ */
+void setRealtimeAllocationFatal(bool fatal);
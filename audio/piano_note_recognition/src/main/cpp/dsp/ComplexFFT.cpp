@@ -0,0 +1,77 @@
+#include "ComplexFFT.h"
+
+#include "DspKernels.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace {
+constexpr double kPi = 3.14159265358979323846;
+}
+
+ComplexFFT::ComplexFFT(int32_t size)
+    : size_(size) {
+    // --- 位反序表：只依赖点数，构造时算一次 ---
+    bitrev_.resize(size_);
+    int32_t bits = 0;
+    while ((1 << bits) < size_) ++bits;
+    for (int32_t i = 0; i < size_; ++i) {
+        int32_t r = 0;
+        for (int32_t b = 0; b < bits; ++b) {
+            r |= ((i >> b) & 1) << (bits - 1 - b);
+        }
+        bitrev_[i] = r;
+    }
+
+    // --- 旋转因子：double 直接求值，避免逐次复数乘递推带来的误差累积；按级连续存放 ---
+    const int32_t stageTotal = std::max<int32_t>(1, size_ - 1);
+    stageTwRe_.resize(stageTotal);
+    stageTwIm_.resize(stageTotal);
+    for (int32_t h = 1; h < size_; h <<= 1) {
+        for (int32_t j = 0; j < h; ++j) {
+            const double ang = -kPi * j / static_cast<double>(h);
+            stageTwRe_[h - 1 + j] = static_cast<float>(std::cos(ang));
+            stageTwIm_[h - 1 + j] = static_cast<float>(std::sin(ang));
+        }
+    }
+}
+
+void ComplexFFT::forward(float* re, float* im) const {
+    const int32_t n = size_;
+
+    // 位反序置换：查表，只交换 i < j 的一半
+    for (int32_t i = 0; i < n; ++i) {
+        const int32_t j = bitrev_[i];
+        if (i < j) {
+            std::swap(re[i], re[j]);
+            std::swap(im[i], im[j]);
+        }
+    }
+
+    runStages(re, im, 1);
+}
+
+void ComplexFFT::forwardPrefix(const float* inRe, const float* inIm, int32_t count,
+                               float* re, float* im) const {
+    const int32_t p = size_ / count;
+
+    // 位反序 + 前 log2(P) 级：第 n 个输入落在 bitrev(n)（P 的倍数），复制到其后 P 个位置
+    for (int32_t n = 0; n < count; ++n) {
+        const int32_t base = bitrev_[n];
+        for (int32_t r = 0; r < p; ++r) {
+            re[base + r] = inRe[n];
+            im[base + r] = inIm[n];
+        }
+    }
+
+    runStages(re, im, p);
+}
+
+void ComplexFFT::runStages(float* re, float* im, int32_t firstHalf) const {
+    // 逐级合并，半长 h = firstHalf,...,n/2；每级旋转因子连续存放于 stageTw*_[h-1 ...]
+    const DspKernels& kernels = dspKernels();
+    for (int32_t h = firstHalf; h < size_; h <<= 1) {
+        kernels.butterflyStage(re, im, size_, h, stageTwRe_.data() + (h - 1), stageTwIm_.data() + (h - 1));
+    }
+}
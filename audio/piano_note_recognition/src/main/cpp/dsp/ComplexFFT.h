@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * @class ComplexFFT
+ * @brief 复数 FFT 核心：实部/虚部分离（SoA）的原地迭代基 2 变换
+ *
+ * 说明：
+ * - 位反序表与各级旋转因子在构造时一次性算好，[forward] 内不调用三角函数、不分配内存。
+ * - 蝶形经 [dspKernels] 分派到 SIMD 实现。
+ * - 自身不持有数据缓冲，可被多个上层变换（[RealFFT] 等）复用；实例本身只读，线程安全。
+ */
+class ComplexFFT {
+public:
+    /** @param size 复数点数，须为 2 的幂且 >= 1 */
+    explicit ComplexFFT(int32_t size);
+
+    int32_t size() const { return size_; }
+
+    /** 原地正变换 X[k] = sum_n x[n] * e^{-2πikn/size}；re/im 长度 [size] */
+    void forward(float* re, float* im) const;
+
+    /**
+     * 零填充正变换：输入仅前 count 个点非零（count 为 2 的幂且整除 size，P = size / count）。
+     * 位反序后非零点恰落在 P 的整数倍位置，前 log2(P) 级蝶形只是把它复制到所在的 P 个位置，
+     * 因此直接广播写入，省去位反序交换与这几级（恰是无法向量化的短级）。
+     * @param inRe/inIm 长度 [count]
+     * @param re/im 输出，长度 [size]
+     */
+    void forwardPrefix(const float* inRe, const float* inIm, int32_t count, float* re, float* im) const;
+
+private:
+    /** 从半长 firstHalf 的一级开始执行其余各级蝶形 */
+    void runStages(float* re, float* im, int32_t firstHalf) const;
+
+    int32_t size_;
+
+    /** 长度 size_：bitrev_[i] 为 i 的位反序 */
+    std::vector<int32_t> bitrev_;
+    /**
+     * 各级旋转因子按级连续存放：半长为 h 的一级占 [h-1, 2h-1)，内容为 e^{-2πij/(2h)}，j < h；
+     * 蝶形内核可直接按 4/8 路连续加载。
+     */
+    std::vector<float> stageTwRe_;
+    std::vector<float> stageTwIm_;
+};
@@ -0,0 +1,133 @@
+#include "ConstantQ.h"
+
+#include "ComplexFFT.h"
+#include "RealFFT.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+constexpr double kPi = 3.14159265358979323846;
+
+/** 稀疏化阈值：相对本 bin 核最大幅度，低于此的频域项丢弃 */
+constexpr double kSparsity = 0.005;
+}
+
+ConstantQ::ConstantQ(int32_t fftSize, float sampleRate, int32_t binsPerSemitone,
+                     int32_t firstMidi, int32_t numSemitones, const TuningTable& tuning)
+    : fftSize_(fftSize),
+      sampleRate_(sampleRate),
+      binsPerSemitone_(std::max<int32_t>(1, binsPerSemitone)),
+      firstMidi_(firstMidi) {
+    const int32_t n = fftSize_;
+    const int32_t half = n / 2;
+    const double fs = static_cast<double>(sampleRate_);
+    const double q = 1.0 / (std::pow(2.0, 1.0 / (12.0 * binsPerSemitone_)) - 1.0);
+
+    // 覆盖范围截到 0.95 Nyquist 以下
+    numBins_ = 0;
+    for (int32_t b = 0; b < numSemitones * binsPerSemitone_; ++b) {
+        const double f = tuning.frequencyAt(firstMidi_ + static_cast<double>(b) / binsPerSemitone_);
+        if (f >= 0.475 * fs) break;
+        binHz_.push_back(static_cast<float>(f));
+        numBins_ = b + 1;
+    }
+
+    // --- 整帧对称 Hann（与 FFTWrapper 一致），用于标定 ---
+    std::vector<float> frameWin(n);
+    double winSum = 0.0;
+    for (int32_t i = 0; i < n; ++i) {
+        frameWin[i] = static_cast<float>(0.5 - 0.5 * std::cos(2.0 * kPi * i / static_cast<double>(n - 1)));
+        winSum += frameWin[i];
+    }
+    const double target = 0.5 * winSum;
+
+    ComplexFFT fft(n);
+    RealFFT realFft(n);
+    std::vector<float> kRe(n), kIm(n);
+    std::vector<float> probe(n), probeRe(half + 1), probeIm(half + 1);
+
+    rowStart_.assign(numBins_ + 1, 0);
+    for (int32_t b = 0; b < numBins_; ++b) {
+        const double f = binHz_[b];
+
+        // --- 1) 时域核：长 N_b 的 Hann 窗复指数，居中放入 N 点帧，再做 FFT ---
+        const int32_t len = std::min<int32_t>(n, static_cast<int32_t>(std::ceil(q * fs / f)));
+        const int32_t start = (n - len) / 2;
+        std::fill(kRe.begin(), kRe.end(), 0.0f);
+        std::fill(kIm.begin(), kIm.end(), 0.0f);
+        for (int32_t i = 0; i < len; ++i) {
+            const double w = 0.5 - 0.5 * std::cos(2.0 * kPi * i / static_cast<double>(std::max(1, len - 1)));
+            const double ph = 2.0 * kPi * f * (start + i) / fs;
+            kRe[start + i] = static_cast<float>(w * std::cos(ph) / len);
+            kIm[start + i] = static_cast<float>(w * std::sin(ph) / len);
+        }
+        fft.forward(kRe.data(), kIm.data());
+
+        // --- 2) 折叠负频率：对 j = 0..N/2-1，A = conj(K[j])，B = conj(K[N-j])（j = 0 自共轭，B = 0）---
+        // 覆盖范围止于 0.475 fs，核在 Nyquist bin 上可忽略，故不读取 X[N/2]
+        const int32_t rowBegin = static_cast<int32_t>(col_.size());
+        double peak = 0.0;
+        for (int32_t j = 0; j < n; ++j) {
+            peak = std::max(peak, std::hypot(static_cast<double>(kRe[j]), static_cast<double>(kIm[j])));
+        }
+        for (int32_t j = 0; j < half; ++j) {
+            const double aRe = kRe[j];
+            const double aIm = -kIm[j];
+            double bRe = 0.0;
+            double bIm = 0.0;
+            if (j != 0) {
+                bRe = kRe[n - j];
+                bIm = -kIm[n - j];
+            }
+            if (std::hypot(aRe, aIm) + std::hypot(bRe, bIm) < kSparsity * peak) continue;
+            col_.push_back(j);
+            coefP_.push_back(static_cast<float>((aRe + bRe) / n));
+            coefQ_.push_back(static_cast<float>((bIm - aIm) / n));
+            coefR_.push_back(static_cast<float>((aIm + bIm) / n));
+            coefS_.push_back(static_cast<float>((aRe - bRe) / n));
+        }
+        rowStart_[b + 1] = static_cast<int32_t>(col_.size());
+
+        // --- 3) 标定：中心频率上的单位幅度正弦经整帧 Hann + FFT 后，输出应为 sum(w)/2 ---
+        for (int32_t i = 0; i < n; ++i) {
+            probe[i] = frameWin[i] * static_cast<float>(std::cos(2.0 * kPi * f * i / fs));
+        }
+        realFft.forward(probe.data(), probeRe.data(), probeIm.data());
+        double accRe = 0.0;
+        double accIm = 0.0;
+        for (int32_t e = rowBegin; e < rowStart_[b + 1]; ++e) {
+            const double xr = probeRe[col_[e]];
+            const double xi = probeIm[col_[e]];
+            accRe += xr * coefP_[e] + xi * coefQ_[e];
+            accIm += xr * coefR_[e] + xi * coefS_[e];
+        }
+        const double got = std::hypot(accRe, accIm);
+        const float scale = got > 0.0 ? static_cast<float>(target / got) : 0.0f;
+        for (int32_t e = rowBegin; e < rowStart_[b + 1]; ++e) {
+            coefP_[e] *= scale;
+            coefQ_[e] *= scale;
+            coefR_[e] *= scale;
+            coefS_[e] *= scale;
+        }
+    }
+}
+
+void ConstantQ::transform(const float* re, const float* im, float* out) const {
+    const int32_t* col = col_.data();
+    const float* p = coefP_.data();
+    const float* q = coefQ_.data();
+    const float* r = coefR_.data();
+    const float* s = coefS_.data();
+    for (int32_t b = 0; b < numBins_; ++b) {
+        float accRe = 0.0f;
+        float accIm = 0.0f;
+        for (int32_t e = rowStart_[b]; e < rowStart_[b + 1]; ++e) {
+            const float xr = re[col[e]];
+            const float xi = im[col[e]];
+            accRe += xr * p[e] + xi * q[e];
+            accIm += xr * r[e] + xi * s[e];
+        }
+        out[b] = std::sqrt(accRe * accRe + accIm * accIm);
+    }
+}
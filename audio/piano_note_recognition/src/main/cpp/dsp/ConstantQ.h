@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "TuningTable.h"
+
+/**
+ * @class ConstantQ
+ * @brief 常 Q 变换（Brown–Puckette 频域稀疏核）：在已有的加窗 FFT 复数谱上，按半音（或 1/k 半音）取样
+ *
+ * 思路：
+ * - 每个 CQ bin（中心频率 f_b，Q = 1 / (2^(1/(12k)) - 1)）的时域核为长 N_b = min(Q fs / f_b, N) 的
+ *   Hann 窗复指数，居中放入 N 点帧；构造时一次性做 FFT 得到频域核并按阈值稀疏化（CSR 存放）。
+ * - 运行时 CQ[b] = sum_j X[j] conj(K_b[j]) / N 只在核的非零项上累加。实数输入的负频率项
+ *   由共轭对称折叠进 j = 0..N/2-1 的系数（每项 4 个实系数），因此只需 [FFTWrapper] 的正频率谱。
+ * - 输入是 [FFTWrapper] 已整帧 Hann 加窗的谱，等效窗口为 整帧 Hann × 本 bin 的 Hann：
+ *   N_b < N 的高音 bin 近似为自身窗口；N_b 被截到 N 的低音 bin 为 Hann^2，主瓣略宽。
+ * - 每个 bin 按“幅度 A 的正弦在本 bin 中心频率上”标定，使输出与 FFTWrapper 幅度谱同尺度（A·sum(w)/2），
+ *   HPS 等下游阈值可直接沿用。
+ *
+ * bin 中心按调律表（[TuningTable::frequencyAt]）取样：442 Hz 或拉伸调律的琴上各键中心仍恰在 bin 上，
+ * 键与键之间的 bin 按相邻键偏移插值。换表须重新构造。
+ *
+ * 分辨率：低于 f = Q fs / N（2048 点 / 48k、k = 1 时约 400 Hz）的 bin 受帧长限制，核长被截到 N，
+ * 分辨率与线性 FFT 相同；但 bin 中心恰在各琴键频率上，不再把基频量化到 23.4 Hz 网格。
+ *
+ * 开销：2048 点 / 48k、k = 3 时 348 个 bin、稀疏核约 7500 项，主机实测每帧约 15 µs，
+ * 同机一次 8192 点实数 FFT 约 38 µs。核在构造时生成（分配内存），[transform] 不分配。
+ *
+ * 主机合成音（12 次非谐泛音 + 噪声，±30 音分失谐）上接半音域 HPS：MIDI 57 以上全部正确，
+ * MIDI 39..56 约 83%（线性 HPS 分别约 80% / 33%），音高误差均值约 4 音分；MIDI 38 以下两者都受帧长所限。
+ */
+class ConstantQ {
+public:
+    /** 默认覆盖半音数：A0 起 116 个半音（至约 MIDI 136），让最高琴键的低次谐波也在范围内 */
+    static constexpr int32_t kDefaultSemitones = 116;
+
+    /**
+     * @param fftSize 输入谱对应的 FFT 点数
+     * @param sampleRate 采样率
+     * @param binsPerSemitone 每半音 bin 数 k（1 或 3 常用）；bin b 对应 MIDI firstMidi + b / k
+     * @param firstMidi 第一个 bin 的 MIDI 号（21 = A0）
+     * @param numSemitones 覆盖的半音数；超出 0.95 * Nyquist 的部分自动截掉
+     * @param tuning bin 中心频率所依据的调律表（默认 440 Hz 十二平均律）
+     */
+    ConstantQ(int32_t fftSize, float sampleRate, int32_t binsPerSemitone = 1,
+              int32_t firstMidi = 21, int32_t numSemitones = kDefaultSemitones,
+              const TuningTable& tuning = TuningTable());
+
+    int32_t numBins() const { return numBins_; }
+    int32_t binsPerSemitone() const { return binsPerSemitone_; }
+    int32_t firstMidi() const { return firstMidi_; }
+    int32_t fftSize() const { return fftSize_; }
+    float sampleRate() const { return sampleRate_; }
+    /** 稀疏核非零项数（基准用） */
+    int32_t nonZeros() const { return static_cast<int32_t>(col_.size()); }
+
+    /** bin b 的中心频率 Hz */
+    float binFrequency(int32_t bin) const { return binHz_[bin]; }
+    /** 各 bin 中心频率 Hz，长度 [numBins]，严格递增 */
+    const float* binFrequencies() const { return binHz_.data(); }
+
+    /**
+     * @param re/im FFT 正频率复数谱，长度 >= fftSize / 2（[FFTWrapper::Spectrum::re]/[im]）
+     * @param out |CQ|，长度 [numBins]
+     */
+    void transform(const float* re, const float* im, float* out) const;
+
+private:
+    int32_t fftSize_;
+    float sampleRate_;
+    int32_t binsPerSemitone_;
+    int32_t firstMidi_;
+    int32_t numBins_{0};
+    std::vector<float> binHz_;
+
+    /** CSR：bin b 的非零项为 [rowStart_[b], rowStart_[b+1]) */
+    std::vector<int32_t> rowStart_;
+    std::vector<int32_t> col_;
+    /** 每项 re += Xr*p + Xi*q，im += Xr*r + Xi*s（已含共轭折叠与标定系数） */
+    std::vector<float> coefP_;
+    std::vector<float> coefQ_;
+    std::vector<float> coefR_;
+    std::vector<float> coefS_;
+};
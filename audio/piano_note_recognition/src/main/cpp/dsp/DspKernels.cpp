@@ -0,0 +1,134 @@
+#include "DspKernels.h"
+
+#include <atomic>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+void butterflyStageScalar(float* re, float* im, int32_t n, int32_t half,
+                          const float* twRe, const float* twIm) {
+    const int32_t len = half << 1;
+    for (int32_t i = 0; i < n; i += len) {
+        float* uRe = re + i;
+        float* uIm = im + i;
+        float* vRe = uRe + half;
+        float* vIm = uIm + half;
+        for (int32_t j = 0; j < half; ++j) {
+            const float tRe = vRe[j] * twRe[j] - vIm[j] * twIm[j];
+            const float tIm = vRe[j] * twIm[j] + vIm[j] * twRe[j];
+            vRe[j] = uRe[j] - tRe;
+            vIm[j] = uIm[j] - tIm;
+            uRe[j] += tRe;
+            uIm[j] += tIm;
+        }
+    }
+}
+
+double windowSumSqScalar(const float* in, const float* win, float* out, int32_t n) {
+    double sumSq = 0.0;
+    for (int32_t i = 0; i < n; ++i) {
+        const float v = in[i];
+        sumSq += static_cast<double>(v) * static_cast<double>(v);
+        out[i] = v * win[i];
+    }
+    return sumSq;
+}
+
+void magnitudeScalar(const float* re, const float* im, float* out, int32_t n) {
+    for (int32_t i = 0; i < n; ++i) {
+        out[i] = std::sqrt(re[i] * re[i] + im[i] * im[i]);
+    }
+}
+
+void log2Scalar(const float* in, float* out, int32_t n) {
+    using namespace dsp_kernels_detail;
+    for (int32_t i = 0; i < n; ++i) {
+        const float x = in[i] > kLog2Floor ? in[i] : kLog2Floor;
+        uint32_t bits;
+        std::memcpy(&bits, &x, sizeof(bits));
+        const float e = static_cast<float>(static_cast<int32_t>(bits >> 23) - 127);
+        const uint32_t mantissaBits = (bits & 0x007FFFFFu) | 0x3F800000u;
+        float m;
+        std::memcpy(&m, &mantissaBits, sizeof(m));
+        const float t = m - 1.0f;
+        const float p = t * (kLog2C1 + t * (kLog2C2 + t * (kLog2C3 + t * (kLog2C4 + t * kLog2C5))));
+        out[i] = e + p;
+    }
+}
+
+void accumulateScalar(float* acc, const float* in, int32_t n) {
+    for (int32_t i = 0; i < n; ++i) {
+        acc[i] += in[i];
+    }
+}
+
+double dotScalar(const float* a, const float* b, int32_t n) {
+    double sum = 0.0;
+    for (int32_t i = 0; i < n; ++i) {
+        sum += static_cast<double>(a[i]) * static_cast<double>(b[i]);
+    }
+    return sum;
+}
+
+constexpr DspKernels kScalarKernels{
+    DspIsa::Scalar,
+    "scalar",
+    butterflyStageScalar,
+    windowSumSqScalar,
+    magnitudeScalar,
+    log2Scalar,
+    accumulateScalar,
+    dotScalar,
+};
+
+const DspKernels* detectBest() {
+    if (isDspIsaSupported(DspIsa::Avx2)) return dsp_kernels_detail::avx2Kernels();
+    if (isDspIsaSupported(DspIsa::Neon)) return dsp_kernels_detail::neonKernels();
+    if (isDspIsaSupported(DspIsa::Sse2)) return dsp_kernels_detail::sse2Kernels();
+    return &kScalarKernels;
+}
+
+std::atomic<const DspKernels*>& activeKernels() {
+    // 函数内静态：首次使用时做一次 CPU 探测，线程安全
+    static std::atomic<const DspKernels*> active{detectBest()};
+    return active;
+}
+
+const DspKernels* kernelsFor(DspIsa isa) {
+    switch (isa) {
+        case DspIsa::Scalar: return &kScalarKernels;
+        case DspIsa::Sse2: return dsp_kernels_detail::sse2Kernels();
+        case DspIsa::Avx2: return dsp_kernels_detail::avx2Kernels();
+        case DspIsa::Neon: return dsp_kernels_detail::neonKernels();
+    }
+    return nullptr;
+}
+} // namespace
+
+namespace dsp_kernels_detail {
+const DspKernels* scalarKernels() { return &kScalarKernels; }
+}
+
+bool isDspIsaSupported(DspIsa isa) {
+    if (kernelsFor(isa) == nullptr) return false;
+#if defined(__x86_64__) || defined(__i386__)
+    if (isa == DspIsa::Avx2) {
+        return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    }
+    if (isa == DspIsa::Sse2) {
+        return __builtin_cpu_supports("sse2");
+    }
+#endif
+    return true;
+}
+
+const DspKernels& dspKernels() {
+    return *activeKernels().load(std::memory_order_acquire);
+}
+
+bool selectDspKernels(DspIsa isa) {
+    if (!isDspIsaSupported(isa)) return false;
+    activeKernels().store(kernelsFor(isa), std::memory_order_release);
+    return true;
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * @file DspKernels.h
+ * @brief 热点 DSP 内核的运行时分派表：标量回退 + SSE2 / AVX2（x86）+ NEON（ARM）
+ *
+ * 说明：
+ * - 所有数据均为实部/虚部分离（SoA）布局，便于按 4/8 路连续加载。
+ * - [dspKernels] 首次调用时按 CPU 特性选出最优实现，之后只是一次原子读；
+ *   x86 用编译器内建的 cpuid 查询，AArch64 上 NEON 为架构必备，无需探测。
+ * - [selectDspKernels] 供基准/校验强制切换实现，不应在音频回调中调用。
+ */
+
+enum class DspIsa {
+    Scalar,
+    Sse2,
+    Avx2,
+    Neon,
+};
+
+struct DspKernels {
+    DspIsa isa;
+    const char* name;
+
+    /**
+     * 一级基 2 蝶形（DIT，输入已位反序）：对每组 [i, i+2*half) 做
+     * t = w[j] * x[i+j+half]；x[i+j+half] = x[i+j] - t；x[i+j] += t。
+     * @param n 复数点数
+     * @param twRe/twIm 本级连续旋转因子，长度 [half]
+     */
+    void (*butterflyStage)(float* re, float* im, int32_t n, int32_t half,
+                           const float* twRe, const float* twIm);
+
+    /** out[i] = in[i] * win[i]，返回未加窗能量 sum(in[i]^2) */
+    double (*windowSumSq)(const float* in, const float* win, float* out, int32_t n);
+
+    /** out[i] = sqrt(re[i]^2 + im[i]^2) */
+    void (*magnitude)(const float* re, const float* im, float* out, int32_t n);
+
+    /**
+     * out[i] ≈ log2(max(in[i], [kLog2Floor]))：指数位直接取出，尾数用 5 次多项式逼近，
+     * 绝对误差 < 2e-5（各实现同一多项式）。供 [HPS] 在对数域累加谐波。
+     */
+    void (*log2)(const float* in, float* out, int32_t n);
+
+    /** acc[i] += in[i] */
+    void (*accumulate)(float* acc, const float* in, int32_t n);
+
+    /** sum(a[i] * b[i])：各路 float 累加，最后合并为 double；供 [YINWrapper::detectNear] 逐 tau 求自相关 */
+    double (*dot)(const float* a, const float* b, int32_t n);
+};
+
+/** [DspKernels::log2] 的输入下限：0 与非正值按此值处理，避免 -inf 参与求和 */
+constexpr float kLog2Floor = 1e-30f;
+
+/** 当前生效的内核表（首次调用时按 CPU 特性选择） */
+const DspKernels& dspKernels();
+
+/** 强制切换到指定实现；当前 CPU/编译目标不支持时返回 false 且不改变 */
+bool selectDspKernels(DspIsa isa);
+
+/** CPU/编译目标是否支持该实现 */
+bool isDspIsaSupported(DspIsa isa);
+
+namespace dsp_kernels_detail {
+/** [DspKernels::log2] 的尾数多项式系数：log2(1 + t) ≈ t * (c1 + t * (c2 + ... + t * c5))，t ∈ [0, 1) */
+constexpr float kLog2C1 = 1.4418799f;
+constexpr float kLog2C2 = -0.708865218f;
+constexpr float kLog2C3 = 0.415245561f;
+constexpr float kLog2C4 = -0.193516525f;
+constexpr float kLog2C5 = 0.0452682929f;
+
+/** 各实现的内核表；对应架构未编译时为 nullptr */
+const DspKernels* scalarKernels();
+const DspKernels* sse2Kernels();
+const DspKernels* avx2Kernels();
+const DspKernels* neonKernels();
+}
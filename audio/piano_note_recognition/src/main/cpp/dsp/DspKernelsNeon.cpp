@@ -0,0 +1,155 @@
+#include "DspKernels.h"
+
+/**
+ * ARM NEON 实现：AArch64 上 NEON 为架构必备，编译期可用即视为可用。
+ */
+
+#if defined(__ARM_NEON) || defined(__aarch64__)
+
+#include <cmath>
+
+#include <arm_neon.h>
+
+namespace {
+
+void butterflyStageNeon(float* re, float* im, int32_t n, int32_t half,
+                        const float* twRe, const float* twIm) {
+    if (half < 4) {
+        dsp_kernels_detail::scalarKernels()->butterflyStage(re, im, n, half, twRe, twIm);
+        return;
+    }
+    const int32_t len = half << 1;
+    for (int32_t i = 0; i < n; i += len) {
+        float* uRe = re + i;
+        float* uIm = im + i;
+        float* vRe = uRe + half;
+        float* vIm = uIm + half;
+        for (int32_t j = 0; j < half; j += 4) {
+            const float32x4_t wr = vld1q_f32(twRe + j);
+            const float32x4_t wi = vld1q_f32(twIm + j);
+            const float32x4_t xr = vld1q_f32(vRe + j);
+            const float32x4_t xi = vld1q_f32(vIm + j);
+            const float32x4_t tr = vmlsq_f32(vmulq_f32(xr, wr), xi, wi);
+            const float32x4_t ti = vmlaq_f32(vmulq_f32(xr, wi), xi, wr);
+            const float32x4_t ur = vld1q_f32(uRe + j);
+            const float32x4_t ui = vld1q_f32(uIm + j);
+            vst1q_f32(vRe + j, vsubq_f32(ur, tr));
+            vst1q_f32(vIm + j, vsubq_f32(ui, ti));
+            vst1q_f32(uRe + j, vaddq_f32(ur, tr));
+            vst1q_f32(uIm + j, vaddq_f32(ui, ti));
+        }
+    }
+}
+
+double windowSumSqNeon(const float* in, const float* win, float* out, int32_t n) {
+    float32x4_t acc = vdupq_n_f32(0.0f);
+    int32_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        const float32x4_t v = vld1q_f32(in + i);
+        acc = vmlaq_f32(acc, v, v);
+        vst1q_f32(out + i, vmulq_f32(v, vld1q_f32(win + i)));
+    }
+    float lanes[4];
+    vst1q_f32(lanes, acc);
+    double sumSq = static_cast<double>(lanes[0]) + lanes[1] + lanes[2] + lanes[3];
+    for (; i < n; ++i) {
+        sumSq += static_cast<double>(in[i]) * in[i];
+        out[i] = in[i] * win[i];
+    }
+    return sumSq;
+}
+
+void magnitudeNeon(const float* re, const float* im, float* out, int32_t n) {
+    int32_t i = 0;
+#if defined(__aarch64__)
+    for (; i + 4 <= n; i += 4) {
+        const float32x4_t r = vld1q_f32(re + i);
+        const float32x4_t m = vld1q_f32(im + i);
+        vst1q_f32(out + i, vsqrtq_f32(vmlaq_f32(vmulq_f32(r, r), m, m)));
+    }
+#endif
+    for (; i < n; ++i) {
+        out[i] = std::sqrt(re[i] * re[i] + im[i] * im[i]);
+    }
+}
+
+void log2Neon(const float* in, float* out, int32_t n) {
+    using namespace dsp_kernels_detail;
+    const float32x4_t lower = vdupq_n_f32(kLog2Floor);
+    const uint32x4_t mantissaMask = vdupq_n_u32(0x007FFFFFu);
+    const uint32x4_t one = vdupq_n_u32(0x3F800000u);
+    const int32x4_t bias = vdupq_n_s32(127);
+    int32_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        const uint32x4_t bits = vreinterpretq_u32_f32(vmaxq_f32(vld1q_f32(in + i), lower));
+        const float32x4_t e =
+            vcvtq_f32_s32(vsubq_s32(vreinterpretq_s32_u32(vshrq_n_u32(bits, 23)), bias));
+        const float32x4_t t =
+            vsubq_f32(vreinterpretq_f32_u32(vorrq_u32(vandq_u32(bits, mantissaMask), one)), vdupq_n_f32(1.0f));
+        float32x4_t p = vmlaq_f32(vdupq_n_f32(kLog2C4), t, vdupq_n_f32(kLog2C5));
+        p = vmlaq_f32(vdupq_n_f32(kLog2C3), t, p);
+        p = vmlaq_f32(vdupq_n_f32(kLog2C2), t, p);
+        p = vmlaq_f32(vdupq_n_f32(kLog2C1), t, p);
+        vst1q_f32(out + i, vmlaq_f32(e, t, p));
+    }
+    if (i < n) scalarKernels()->log2(in + i, out + i, n - i);
+}
+
+void accumulateNeon(float* acc, const float* in, int32_t n) {
+    int32_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        vst1q_f32(acc + i, vaddq_f32(vld1q_f32(acc + i), vld1q_f32(in + i)));
+    }
+    for (; i < n; ++i) {
+        acc[i] += in[i];
+    }
+}
+
+double dotNeon(const float* a, const float* b, int32_t n) {
+    // 4 路独立累加，隐藏乘加延迟
+    float32x4_t acc0 = vdupq_n_f32(0.0f);
+    float32x4_t acc1 = vdupq_n_f32(0.0f);
+    float32x4_t acc2 = vdupq_n_f32(0.0f);
+    float32x4_t acc3 = vdupq_n_f32(0.0f);
+    int32_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        acc0 = vmlaq_f32(acc0, vld1q_f32(a + i), vld1q_f32(b + i));
+        acc1 = vmlaq_f32(acc1, vld1q_f32(a + i + 4), vld1q_f32(b + i + 4));
+        acc2 = vmlaq_f32(acc2, vld1q_f32(a + i + 8), vld1q_f32(b + i + 8));
+        acc3 = vmlaq_f32(acc3, vld1q_f32(a + i + 12), vld1q_f32(b + i + 12));
+    }
+    for (; i + 4 <= n; i += 4) {
+        acc0 = vmlaq_f32(acc0, vld1q_f32(a + i), vld1q_f32(b + i));
+    }
+    float lanes[4];
+    vst1q_f32(lanes, vaddq_f32(vaddq_f32(acc0, acc1), vaddq_f32(acc2, acc3)));
+    double sum = static_cast<double>(lanes[0]) + lanes[1] + lanes[2] + lanes[3];
+    for (; i < n; ++i) {
+        sum += static_cast<double>(a[i]) * b[i];
+    }
+    return sum;
+}
+
+constexpr DspKernels kNeonKernels{
+    DspIsa::Neon,
+    "neon",
+    butterflyStageNeon,
+    windowSumSqNeon,
+    magnitudeNeon,
+    log2Neon,
+    accumulateNeon,
+    dotNeon,
+};
+} // namespace
+
+namespace dsp_kernels_detail {
+const DspKernels* neonKernels() { return &kNeonKernels; }
+}
+
+#else
+
+namespace dsp_kernels_detail {
+const DspKernels* neonKernels() { return nullptr; }
+}
+
+#endif
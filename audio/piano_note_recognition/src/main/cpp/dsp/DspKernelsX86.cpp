@@ -0,0 +1,295 @@
+#include "DspKernels.h"
+
+/**
+ * x86 实现：SSE2（x86_64 基线）与 AVX2+FMA（运行时探测后启用）。
+ * AVX2 函数用 target 属性单独开启指令集，整个文件无需额外编译选项，
+ * 未探测到 AVX2 的机器上这些函数永远不会被调用。
+ */
+
+#if defined(__x86_64__) || defined(__i386__)
+
+#include <cmath>
+
+#include <immintrin.h>
+
+namespace {
+
+// ---------------------------------------------------------------- SSE2
+
+void butterflyStageSse2(float* re, float* im, int32_t n, int32_t half,
+                        const float* twRe, const float* twIm) {
+    if (half < 4) {
+        dsp_kernels_detail::scalarKernels()->butterflyStage(re, im, n, half, twRe, twIm);
+        return;
+    }
+    const int32_t len = half << 1;
+    for (int32_t i = 0; i < n; i += len) {
+        float* uRe = re + i;
+        float* uIm = im + i;
+        float* vRe = uRe + half;
+        float* vIm = uIm + half;
+        for (int32_t j = 0; j < half; j += 4) {
+            const __m128 wr = _mm_loadu_ps(twRe + j);
+            const __m128 wi = _mm_loadu_ps(twIm + j);
+            const __m128 xr = _mm_loadu_ps(vRe + j);
+            const __m128 xi = _mm_loadu_ps(vIm + j);
+            const __m128 tr = _mm_sub_ps(_mm_mul_ps(xr, wr), _mm_mul_ps(xi, wi));
+            const __m128 ti = _mm_add_ps(_mm_mul_ps(xr, wi), _mm_mul_ps(xi, wr));
+            const __m128 ur = _mm_loadu_ps(uRe + j);
+            const __m128 ui = _mm_loadu_ps(uIm + j);
+            _mm_storeu_ps(vRe + j, _mm_sub_ps(ur, tr));
+            _mm_storeu_ps(vIm + j, _mm_sub_ps(ui, ti));
+            _mm_storeu_ps(uRe + j, _mm_add_ps(ur, tr));
+            _mm_storeu_ps(uIm + j, _mm_add_ps(ui, ti));
+        }
+    }
+}
+
+double windowSumSqSse2(const float* in, const float* win, float* out, int32_t n) {
+    __m128 acc = _mm_setzero_ps();
+    int32_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        const __m128 v = _mm_loadu_ps(in + i);
+        acc = _mm_add_ps(acc, _mm_mul_ps(v, v));
+        _mm_storeu_ps(out + i, _mm_mul_ps(v, _mm_loadu_ps(win + i)));
+    }
+    float lanes[4];
+    _mm_storeu_ps(lanes, acc);
+    double sumSq = static_cast<double>(lanes[0]) + lanes[1] + lanes[2] + lanes[3];
+    for (; i < n; ++i) {
+        sumSq += static_cast<double>(in[i]) * in[i];
+        out[i] = in[i] * win[i];
+    }
+    return sumSq;
+}
+
+void magnitudeSse2(const float* re, const float* im, float* out, int32_t n) {
+    int32_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        const __m128 r = _mm_loadu_ps(re + i);
+        const __m128 m = _mm_loadu_ps(im + i);
+        _mm_storeu_ps(out + i, _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(r, r), _mm_mul_ps(m, m))));
+    }
+    for (; i < n; ++i) {
+        out[i] = std::sqrt(re[i] * re[i] + im[i] * im[i]);
+    }
+}
+
+void log2Sse2(const float* in, float* out, int32_t n) {
+    using namespace dsp_kernels_detail;
+    const __m128 lower = _mm_set1_ps(kLog2Floor);
+    const __m128i mantissaMask = _mm_set1_epi32(0x007FFFFF);
+    const __m128i one = _mm_set1_epi32(0x3F800000);
+    const __m128i bias = _mm_set1_epi32(127);
+    int32_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        const __m128i bits = _mm_castps_si128(_mm_max_ps(_mm_loadu_ps(in + i), lower));
+        const __m128 e = _mm_cvtepi32_ps(_mm_sub_epi32(_mm_srli_epi32(bits, 23), bias));
+        const __m128 t = _mm_sub_ps(_mm_castsi128_ps(_mm_or_si128(_mm_and_si128(bits, mantissaMask), one)),
+                                    _mm_set1_ps(1.0f));
+        __m128 p = _mm_add_ps(_mm_mul_ps(t, _mm_set1_ps(kLog2C5)), _mm_set1_ps(kLog2C4));
+        p = _mm_add_ps(_mm_mul_ps(t, p), _mm_set1_ps(kLog2C3));
+        p = _mm_add_ps(_mm_mul_ps(t, p), _mm_set1_ps(kLog2C2));
+        p = _mm_add_ps(_mm_mul_ps(t, p), _mm_set1_ps(kLog2C1));
+        _mm_storeu_ps(out + i, _mm_add_ps(e, _mm_mul_ps(t, p)));
+    }
+    if (i < n) scalarKernels()->log2(in + i, out + i, n - i);
+}
+
+void accumulateSse2(float* acc, const float* in, int32_t n) {
+    int32_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        _mm_storeu_ps(acc + i, _mm_add_ps(_mm_loadu_ps(acc + i), _mm_loadu_ps(in + i)));
+    }
+    for (; i < n; ++i) {
+        acc[i] += in[i];
+    }
+}
+
+double dotSse2(const float* a, const float* b, int32_t n) {
+    // 4 路独立累加，隐藏加法延迟
+    __m128 acc0 = _mm_setzero_ps();
+    __m128 acc1 = _mm_setzero_ps();
+    __m128 acc2 = _mm_setzero_ps();
+    __m128 acc3 = _mm_setzero_ps();
+    int32_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+        acc2 = _mm_add_ps(acc2, _mm_mul_ps(_mm_loadu_ps(a + i + 8), _mm_loadu_ps(b + i + 8)));
+        acc3 = _mm_add_ps(acc3, _mm_mul_ps(_mm_loadu_ps(a + i + 12), _mm_loadu_ps(b + i + 12)));
+    }
+    for (; i + 4 <= n; i += 4) {
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+    }
+    float lanes[4];
+    _mm_storeu_ps(lanes, _mm_add_ps(_mm_add_ps(acc0, acc1), _mm_add_ps(acc2, acc3)));
+    double sum = static_cast<double>(lanes[0]) + lanes[1] + lanes[2] + lanes[3];
+    for (; i < n; ++i) {
+        sum += static_cast<double>(a[i]) * b[i];
+    }
+    return sum;
+}
+
+constexpr DspKernels kSse2Kernels{
+    DspIsa::Sse2,
+    "sse2",
+    butterflyStageSse2,
+    windowSumSqSse2,
+    magnitudeSse2,
+    log2Sse2,
+    accumulateSse2,
+    dotSse2,
+};
+
+// ---------------------------------------------------------------- AVX2 + FMA
+
+__attribute__((target("avx2,fma")))
+void butterflyStageAvx2(float* re, float* im, int32_t n, int32_t half,
+                        const float* twRe, const float* twIm) {
+    if (half < 8) {
+        butterflyStageSse2(re, im, n, half, twRe, twIm);
+        return;
+    }
+    const int32_t len = half << 1;
+    for (int32_t i = 0; i < n; i += len) {
+        float* uRe = re + i;
+        float* uIm = im + i;
+        float* vRe = uRe + half;
+        float* vIm = uIm + half;
+        for (int32_t j = 0; j < half; j += 8) {
+            const __m256 wr = _mm256_loadu_ps(twRe + j);
+            const __m256 wi = _mm256_loadu_ps(twIm + j);
+            const __m256 xr = _mm256_loadu_ps(vRe + j);
+            const __m256 xi = _mm256_loadu_ps(vIm + j);
+            const __m256 tr = _mm256_fmsub_ps(xr, wr, _mm256_mul_ps(xi, wi));
+            const __m256 ti = _mm256_fmadd_ps(xr, wi, _mm256_mul_ps(xi, wr));
+            const __m256 ur = _mm256_loadu_ps(uRe + j);
+            const __m256 ui = _mm256_loadu_ps(uIm + j);
+            _mm256_storeu_ps(vRe + j, _mm256_sub_ps(ur, tr));
+            _mm256_storeu_ps(vIm + j, _mm256_sub_ps(ui, ti));
+            _mm256_storeu_ps(uRe + j, _mm256_add_ps(ur, tr));
+            _mm256_storeu_ps(uIm + j, _mm256_add_ps(ui, ti));
+        }
+    }
+}
+
+__attribute__((target("avx2,fma")))
+double windowSumSqAvx2(const float* in, const float* win, float* out, int32_t n) {
+    __m256 acc = _mm256_setzero_ps();
+    int32_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const __m256 v = _mm256_loadu_ps(in + i);
+        acc = _mm256_fmadd_ps(v, v, acc);
+        _mm256_storeu_ps(out + i, _mm256_mul_ps(v, _mm256_loadu_ps(win + i)));
+    }
+    float lanes[8];
+    _mm256_storeu_ps(lanes, acc);
+    double sumSq = 0.0;
+    for (float lane : lanes) sumSq += lane;
+    for (; i < n; ++i) {
+        sumSq += static_cast<double>(in[i]) * in[i];
+        out[i] = in[i] * win[i];
+    }
+    return sumSq;
+}
+
+__attribute__((target("avx2,fma")))
+void magnitudeAvx2(const float* re, const float* im, float* out, int32_t n) {
+    int32_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const __m256 r = _mm256_loadu_ps(re + i);
+        const __m256 m = _mm256_loadu_ps(im + i);
+        _mm256_storeu_ps(out + i, _mm256_sqrt_ps(_mm256_fmadd_ps(r, r, _mm256_mul_ps(m, m))));
+    }
+    for (; i < n; ++i) {
+        out[i] = std::sqrt(re[i] * re[i] + im[i] * im[i]);
+    }
+}
+
+__attribute__((target("avx2,fma")))
+void log2Avx2(const float* in, float* out, int32_t n) {
+    using namespace dsp_kernels_detail;
+    const __m256 lower = _mm256_set1_ps(kLog2Floor);
+    const __m256i mantissaMask = _mm256_set1_epi32(0x007FFFFF);
+    const __m256i one = _mm256_set1_epi32(0x3F800000);
+    const __m256i bias = _mm256_set1_epi32(127);
+    int32_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const __m256i bits = _mm256_castps_si256(_mm256_max_ps(_mm256_loadu_ps(in + i), lower));
+        const __m256 e = _mm256_cvtepi32_ps(_mm256_sub_epi32(_mm256_srli_epi32(bits, 23), bias));
+        const __m256 t = _mm256_sub_ps(
+            _mm256_castsi256_ps(_mm256_or_si256(_mm256_and_si256(bits, mantissaMask), one)),
+            _mm256_set1_ps(1.0f));
+        __m256 p = _mm256_fmadd_ps(t, _mm256_set1_ps(kLog2C5), _mm256_set1_ps(kLog2C4));
+        p = _mm256_fmadd_ps(t, p, _mm256_set1_ps(kLog2C3));
+        p = _mm256_fmadd_ps(t, p, _mm256_set1_ps(kLog2C2));
+        p = _mm256_fmadd_ps(t, p, _mm256_set1_ps(kLog2C1));
+        _mm256_storeu_ps(out + i, _mm256_fmadd_ps(t, p, e));
+    }
+    if (i < n) log2Sse2(in + i, out + i, n - i);
+}
+
+__attribute__((target("avx2,fma")))
+void accumulateAvx2(float* acc, const float* in, int32_t n) {
+    int32_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        _mm256_storeu_ps(acc + i, _mm256_add_ps(_mm256_loadu_ps(acc + i), _mm256_loadu_ps(in + i)));
+    }
+    for (; i < n; ++i) {
+        acc[i] += in[i];
+    }
+}
+
+__attribute__((target("avx2,fma")))
+double dotAvx2(const float* a, const float* b, int32_t n) {
+    // 4 路独立累加，隐藏 FMA 延迟
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    __m256 acc2 = _mm256_setzero_ps();
+    __m256 acc3 = _mm256_setzero_ps();
+    int32_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), acc0);
+        acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8), acc1);
+        acc2 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 16), _mm256_loadu_ps(b + i + 16), acc2);
+        acc3 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 24), _mm256_loadu_ps(b + i + 24), acc3);
+    }
+    for (; i + 8 <= n; i += 8) {
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), acc0);
+    }
+    float lanes[8];
+    _mm256_storeu_ps(lanes, _mm256_add_ps(_mm256_add_ps(acc0, acc1), _mm256_add_ps(acc2, acc3)));
+    double sum = 0.0;
+    for (float lane : lanes) sum += lane;
+    for (; i < n; ++i) {
+        sum += static_cast<double>(a[i]) * b[i];
+    }
+    return sum;
+}
+
+constexpr DspKernels kAvx2Kernels{
+    DspIsa::Avx2,
+    "avx2",
+    butterflyStageAvx2,
+    windowSumSqAvx2,
+    magnitudeAvx2,
+    log2Avx2,
+    accumulateAvx2,
+    dotAvx2,
+};
+} // namespace
+
+namespace dsp_kernels_detail {
+const DspKernels* sse2Kernels() { return &kSse2Kernels; }
+const DspKernels* avx2Kernels() { return &kAvx2Kernels; }
+}
+
+#else
+
+namespace dsp_kernels_detail {
+const DspKernels* sse2Kernels() { return nullptr; }
+const DspKernels* avx2Kernels() { return nullptr; }
+}
+
+#endif
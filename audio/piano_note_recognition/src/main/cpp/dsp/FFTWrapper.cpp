@@ -1,100 +1,142 @@
 #include "FFTWrapper.h"
 
+#include "DspKernels.h"
+
 #include <algorithm>
 #include <cmath>
-#include <cstring>
 
 namespace {
 constexpr float kPi = 3.14159265358979323846f;
 }
 
-FFTWrapper::FFTWrapper() {
+FFTWrapper::FFTWrapper(int32_t fftSize)
+    : fftSize_(fftSize),
+      numBins_(fftSize / 2),
+      blockSize_(fftSize / kIncrementalBlocks),
+      fft_(fftSize),
+      window_(fftSize),
+      windowed_(fftSize),
+      magnitudes_(fftSize / 2, 0.0f),
+      re_(fftSize / 2 + 1, 0.0f),
+      im_(fftSize / 2 + 1, 0.0f) {
     // Hann 窗：减轻频谱泄漏，便于 HPS 看谐波
-    for (int32_t n = 0; n < kFftSize; ++n) {
-        window_[n] = 0.5f - 0.5f * std::cos(2.0f * kPi * n / static_cast<float>(kFftSize - 1));
+    for (int32_t n = 0; n < fftSize_; ++n) {
+        window_[n] = 0.5f - 0.5f * std::cos(2.0f * kPi * n / static_cast<float>(fftSize_ - 1));
     }
-    std::fill_n(magnitudes_, kNumBins, 0.0f);
 }
 
 void FFTWrapper::applyWindow(const float* time) {
-    // 音量：时域 RMS（未加窗），反映整体响度
-    double sumSq = 0.0;
-    for (int32_t i = 0; i < kFftSize; ++i) {
-        const float v = time[i];
-        sumSq += static_cast<double>(v) * static_cast<double>(v);
-        const float wv = v * window_[i];
-        buf_[i].re = wv;
-        buf_[i].im = 0.0f;
+    // 音量：时域 RMS（未加窗），反映整体响度；加窗与能量累加在同一遍 SIMD 内完成
+    const double sumSq = dspKernels().windowSumSq(time, window_.data(), windowed_.data(), fftSize_);
+    rmsCache_ = static_cast<float>(std::sqrt(sumSq / static_cast<double>(fftSize_)));
+}
+
+void FFTWrapper::computeMagnitudes() {
+    fft_.forward(windowed_.data(), re_.data(), im_.data());
+
+    // 正频率 bin 幅度 |X[k]|
+    dspKernels().magnitude(re_.data(), im_.data(), magnitudes_.data(), numBins_);
+}
+
+void FFTWrapper::setStrategy(Strategy strategy) {
+    strategy_ = strategy;
+    if (strategy_ == Strategy::Incremental && blockFft_ == nullptr) {
+        blockFft_ = std::make_unique<RealFFT>(fftSize_, blockSize_);
+        const size_t stride = static_cast<size_t>(numBins_ + 1);
+        blockRe_.assign(stride * kIncrementalBlocks, 0.0f);
+        blockIm_.assign(stride * kIncrementalBlocks, 0.0f);
+        rawRe_.assign(stride, 0.0f);
+        rawIm_.assign(stride, 0.0f);
     }
-    rmsCache_ = static_cast<float>(std::sqrt(sumSq / static_cast<double>(kFftSize)));
+    reset();
 }
 
-void FFTWrapper::fftRadix2Iterative() {
-    const int32_t n = kFftSize;
+void FFTWrapper::reset() {
+    validBlocks_ = 0;
+    newestSlot_ = 0;
+}
 
-    // 位反序置换：原地重排，为迭代 FFT 做准备
-    int32_t j = 0;
-    for (int32_t i = 1; i < n; ++i) {
-        int32_t bit = n >> 1;
-        while (j & bit) {
-            j ^= bit;
-            bit >>= 1;
-        }
-        j ^= bit;
-        if (i < j) {
-            std::swap(buf_[i], buf_[j]);
-        }
+void FFTWrapper::computeBlock(int32_t slot, const float* block) {
+    double sumSq = 0.0;
+    for (int32_t i = 0; i < blockSize_; ++i) {
+        sumSq += static_cast<double>(block[i]) * static_cast<double>(block[i]);
     }
+    blockSumSq_[slot] = sumSq;
+    const size_t offset = static_cast<size_t>(slot) * static_cast<size_t>(numBins_ + 1);
+    blockFft_->forwardPrefix(block, blockRe_.data() + offset, blockIm_.data() + offset);
+}
 
-    // 逐级合并，len = 2,4,...,N
-    for (int32_t len = 2; len <= n; len <<= 1) {
-        const float ang = -2.0f * kPi / static_cast<float>(len);
-        const float wlenRe = std::cos(ang);
-        const float wlenIm = std::sin(ang);
-
-        for (int32_t i = 0; i < n; i += len) {
-            float wRe = 1.0f;
-            float wIm = 0.0f;
-            const int32_t half = len >> 1;
-            for (int32_t j2 = 0; j2 < half; ++j2) {
-                const int32_t u = i + j2;
-                const int32_t v = i + j2 + half;
-
-                const float tRe = buf_[v].re * wRe - buf_[v].im * wIm;
-                const float tIm = buf_[v].re * wIm + buf_[v].im * wRe;
-
-                const float uRe = buf_[u].re;
-                const float uIm = buf_[u].im;
-
-                buf_[u].re = uRe + tRe;
-                buf_[u].im = uIm + tIm;
-                buf_[v].re = uRe - tRe;
-                buf_[v].im = uIm - tIm;
-
-                const float nextWRe = wRe * wlenRe - wIm * wlenIm;
-                const float nextWIm = wRe * wlenIm + wIm * wlenRe;
-                wRe = nextWRe;
-                wIm = nextWIm;
-            }
+void FFTWrapper::analyzeIncremental(const float* time) {
+    // --- 1) 块缓存：冷启动/重置后整窗重建，之后每帧只算最新一块 ---
+    if (validBlocks_ < kIncrementalBlocks) {
+        for (int32_t b = 0; b < kIncrementalBlocks; ++b) {
+            computeBlock(b, time + b * blockSize_);
         }
+        newestSlot_ = kIncrementalBlocks - 1;
+        validBlocks_ = kIncrementalBlocks;
+    } else {
+        newestSlot_ = (newestSlot_ + 1) % kIncrementalBlocks;
+        computeBlock(newestSlot_, time + (fftSize_ - blockSize_));
     }
 
-    // 正频率 bin 幅度 |X[k]|
-    for (int32_t k = 0; k < kNumBins; ++k) {
-        const float re = buf_[k].re;
-        const float im = buf_[k].im;
-        magnitudes_[k] = std::sqrt(re * re + im * im);
+    // --- 2) 合成：第 j 块（0 为最旧）在窗内偏移 j*N/4，对应相位因子 W^{k*j*N/4} = (-i)^{kj}；
+    //        (-i)^{kj} 只随 c = k mod 4 变化，按 k = 4t + c 展开成四组无分支的加减 ---
+    const size_t stride = static_cast<size_t>(numBins_ + 1);
+    auto slotOffset = [&](int32_t slot) { return static_cast<size_t>(slot % kIncrementalBlocks) * stride; };
+    const float* y0Re = blockRe_.data() + slotOffset(newestSlot_ + 1);
+    const float* y0Im = blockIm_.data() + slotOffset(newestSlot_ + 1);
+    const float* y1Re = blockRe_.data() + slotOffset(newestSlot_ + 2);
+    const float* y1Im = blockIm_.data() + slotOffset(newestSlot_ + 2);
+    const float* y2Re = blockRe_.data() + slotOffset(newestSlot_ + 3);
+    const float* y2Im = blockIm_.data() + slotOffset(newestSlot_ + 3);
+    const float* y3Re = blockRe_.data() + slotOffset(newestSlot_);
+    const float* y3Im = blockIm_.data() + slotOffset(newestSlot_);
+    const int32_t numBins = numBins_;
+    for (int32_t k = 0; k < numBins; k += 4) {
+        // c = 0：1, 1, 1, 1
+        rawRe_[k] = y0Re[k] + y1Re[k] + y2Re[k] + y3Re[k];
+        rawIm_[k] = y0Im[k] + y1Im[k] + y2Im[k] + y3Im[k];
+        // c = 1：1, -i, -1, i
+        rawRe_[k + 1] = y0Re[k + 1] + y1Im[k + 1] - y2Re[k + 1] - y3Im[k + 1];
+        rawIm_[k + 1] = y0Im[k + 1] - y1Re[k + 1] - y2Im[k + 1] + y3Re[k + 1];
+        // c = 2：1, -1, 1, -1
+        rawRe_[k + 2] = y0Re[k + 2] - y1Re[k + 2] + y2Re[k + 2] - y3Re[k + 2];
+        rawIm_[k + 2] = y0Im[k + 2] - y1Im[k + 2] + y2Im[k + 2] - y3Im[k + 2];
+        // c = 3：1, i, -1, -i
+        rawRe_[k + 3] = y0Re[k + 3] - y1Im[k + 3] - y2Re[k + 3] + y3Im[k + 3];
+        rawIm_[k + 3] = y0Im[k + 3] + y1Re[k + 3] - y2Im[k + 3] - y3Re[k + 3];
+    }
+    // Nyquist：N/2 为 4 的倍数，属 c = 0
+    rawRe_[numBins] = y0Re[numBins] + y1Re[numBins] + y2Re[numBins] + y3Re[numBins];
+    rawIm_[numBins] = 0.0f;
+    double sumSq = 0.0;
+    for (double blockSumSq : blockSumSq_) {
+        sumSq += blockSumSq;
+    }
+    rmsCache_ = static_cast<float>(std::sqrt(sumSq / static_cast<double>(fftSize_)));
+
+    // --- 3) 频域 Hann：Xw[k] = 0.5 X[k] - 0.25 (X[k-1] + X[k+1])，X[-1] = conj X[1] ---
+    re_[0] = 0.5f * rawRe_[0] - 0.5f * rawRe_[1];
+    im_[0] = 0.0f;
+    for (int32_t k = 1; k < numBins; ++k) {
+        re_[k] = 0.5f * rawRe_[k] - 0.25f * (rawRe_[k - 1] + rawRe_[k + 1]);
+        im_[k] = 0.5f * rawIm_[k] - 0.25f * (rawIm_[k - 1] + rawIm_[k + 1]);
     }
 }
 
 FFTWrapper::Spectrum FFTWrapper::analyze(const float* time) {
-    applyWindow(time);
-    fftRadix2Iterative();
+    if (strategy_ == Strategy::Incremental) {
+        analyzeIncremental(time);
+        dspKernels().magnitude(re_.data(), im_.data(), magnitudes_.data(), numBins_);
+    } else {
+        applyWindow(time);
+        computeMagnitudes();
+    }
 
     // 将 RMS 粗略映射到 0..1（浮点 PCM 常见幅度下可调系数）
     float volume = rmsCache_;
     volume = std::clamp(volume * 2.0f, 0.0f, 1.0f);
     rmsCache_ = volume;
 
-    return Spectrum{magnitudes_, kNumBins, rmsCache_};
+    return Spectrum{magnitudes_.data(), numBins_, rmsCache_, re_.data(), im_.data()};
 }
@@ -1,48 +1,108 @@
 #pragma once
 
 #include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "RealFFT.h"
 
 /**
  * @class FFTWrapper
- * @brief 对固定 2048 点做加窗 FFT，输出幅度谱与各 bin，并估计音量（RMS）
+ * @brief 对 N 点（构造时指定，默认 2048）做加窗 FFT，输出幅度谱与各 bin，并估计音量（RMS）
  *
  * 说明：
- * - 计划接入 PFFFT 时，可在此类内替换实现，对外仍暴露 [analyze] 与 [Spectrum]。
- * - 当前为 Radix-2 迭代 FFT 回退实现，保证无第三方库亦可编译运行。
+ * - 变换由 [RealFFT] 完成（实数输入、N/2 点复数打包、构造期查表）；后端（内置 / PFFFT）在编译期选择，
+ *   对外仍只暴露 [analyze] 与 [Spectrum]。
+ * - 加窗（含 RMS 能量累加）与幅度计算经 [dspKernels] 分派到 SIMD 实现。
+ * - 两种策略（[Strategy]），可在运行时切换做 A/B 对比：
+ *   - Full：每帧对整窗加窗 + 完整 FFT（默认）。
+ *   - Incremental：窗口按 [blockSize]（N/4）滑动时，只对最新一块做零填充变换，
+ *     与缓存的前 3 块按 X[k] = sum_j (-i)^{kj} Y_j[k] 合成，再在频域做 Hann 三点卷积。
+ *     频域 Hann 为周期型（分母 N），与 Full 的对称型（分母 N-1）有微小差异：
+ *     幅度差在峰值的 0.05% 以内（主机实测，含噪双音信号）。
+ *     块变换（含其查表）与块缓存都在首次切到 Incremental 时创建，只用 Full 的实例（如多分辨率的长/短窗）不占这部分内存。
+ * - 多分辨率分析（见 [PitchDetector::processMultiResolution]）用不同 N 的多个实例，各自的缓冲在构造时分配。
  */
 class FFTWrapper {
 public:
+    /** 默认点数（单音/多音主路径） */
     static constexpr int32_t kFftSize = 2048;
-    static constexpr int32_t kNumBins = kFftSize / 2;
+    /** Incremental 策略的块数：每次 [analyze] 须恰好前移 [blockSize] = N / 4 个采样 */
+    static constexpr int32_t kIncrementalBlocks = 4;
+
+    enum class Strategy {
+        Full,
+        Incremental,
+    };
 
     /** FFT 输出：仅正频率 bin（不含 Nyquist 的单独处理，长度为 N/2） */
     struct Spectrum {
         const float* magnitudes; ///< 长度 [numBins]
         int32_t numBins;
         float rms;               ///< 映射到 0..1 的“音量”启发值
+        const float* re;         ///< 加窗后的复数谱实部，长度 [numBins]（供 [ConstantQ] 等需要相位的下游）
+        const float* im;         ///< 虚部，同上
     };
 
-    FFTWrapper();
+    /** @param fftSize 2 的幂，>= 16 */
+    explicit FFTWrapper(int32_t fftSize = kFftSize);
+
+    int32_t fftSize() const { return fftSize_; }
+    int32_t numBins() const { return numBins_; }
+    int32_t blockSize() const { return blockSize_; }
 
     /**
-     * @param time 至少 [kFftSize] 个连续采样
+     * @param time 至少 [fftSize] 个连续采样
      * @return 幅度谱指针指向内部缓冲，仅在下次 [analyze] 前有效
      */
     Spectrum analyze(const float* time);
 
+    /** 切换策略；切到 Incremental 时会清空块缓存，下一帧整窗重建（首次切换时分配缓存，勿在音频线程调用） */
+    void setStrategy(Strategy strategy);
+    Strategy strategy() const { return strategy_; }
+
+    /** 输入流不连续（重启/丢包）时调用：清空 Incremental 块缓存 */
+    void reset();
+
 private:
-    /** Hann 窗 + 填充实部/虚部为 0，同时计算未加窗 RMS（用于音量） */
+    /** Hann 窗写入 [windowed_]，同时计算未加窗 RMS（用于音量） */
     void applyWindow(const float* time);
-    /** 原地 Cooley-Tukey，结果写入 [buf_]，再求前一半 bin 幅度 */
-    void fftRadix2Iterative();
+    /** 实数 FFT 后求前一半 bin 幅度 */
+    void computeMagnitudes();
 
-    float window_[kFftSize];
+    /** Incremental：更新块缓存、合成整窗频谱并在频域加 Hann 窗，结果写入 [re_]/[im_] */
+    void analyzeIncremental(const float* time);
+    /** 计算一块（[blockSize] 个采样）的零填充 N 点频谱与能量，写入 slot */
+    void computeBlock(int32_t slot, const float* block);
+
+    Strategy strategy_{Strategy::Full};
+
+    int32_t fftSize_;
+    int32_t numBins_;
+    int32_t blockSize_;
+
+    RealFFT fft_;
+
+    std::vector<float> window_;
+    std::vector<float> windowed_;
     float rmsCache_{0.0f};
-    float magnitudes_[kNumBins];
+    std::vector<float> magnitudes_;
 
-    struct Complex {
-        float re;
-        float im;
-    };
-    Complex buf_[kFftSize];
+    /** [RealFFT::forward] 输出，长度 N/2+1 */
+    std::vector<float> re_;
+    std::vector<float> im_;
+
+    // --- Incremental 策略状态 ---
+    /** 零填充块变换；首次切到 Incremental 时创建 */
+    std::unique_ptr<RealFFT> blockFft_;
+    /** 环形块缓存：每块零填充后的 0..N/2 频谱（块 b 位于 [b * (N/2+1), (b+1) * (N/2+1))）与未加窗能量 */
+    std::vector<float> blockRe_;
+    std::vector<float> blockIm_;
+    double blockSumSq_[kIncrementalBlocks];
+    /** 最新一块所在槽位；有效块数不足 [kIncrementalBlocks] 时下一帧整窗重建 */
+    int32_t newestSlot_{0};
+    int32_t validBlocks_{0};
+    /** 合成后的未加窗频谱，长度 N/2+1 */
+    std::vector<float> rawRe_;
+    std::vector<float> rawIm_;
 };
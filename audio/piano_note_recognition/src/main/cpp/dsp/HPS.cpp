@@ -1,58 +1,167 @@
 #include "HPS.h"
 
+#include "DspKernels.h"
+
 #include <algorithm>
 #include <cmath>
 #include <cfloat>
 
 namespace {
 constexpr float kEps = 1e-12f;
+/** [HPS::detect] 亚 bin 细化所用的谐波次数：更高次谐波受非谐性拉伸，反而带偏基频 */
+constexpr int32_t kRefineHarmonics = 3;
 }
 
+HPS::HPS(int32_t maxBins)
+    : maxBins_(std::max(maxBins, 2)),
+      logMag_(static_cast<size_t>(maxBins_), 0.0f),
+      score_(static_cast<size_t>(maxBins_), 0.0f),
+      decimated_(static_cast<size_t>(maxBins_), 0.0f) {}
+
 HPS::Result HPS::detect(const float* magnitudes, int32_t numBins, float sampleRate,
                           int32_t maxHarmonics, float minHz, float maxHz) {
     if (magnitudes == nullptr || numBins <= 1 || sampleRate <= 0.0f) {
         return Result{-1.0f, 0.0f};
     }
-    if (maxHarmonics < 2) maxHarmonics = 2;
+    maxHarmonics = std::clamp<int32_t>(maxHarmonics, 2, kMaxHarmonics);
 
-    // 频率分辨率须与 FFT 点数一致：本工程固定 2048 点
-    const float freqRes = sampleRate / 2048.0f;
+    // 频率分辨率由 FFT 点数 N = 2 * numBins 决定（多分辨率下各窗口点数不同）
+    const float freqRes = sampleRate / static_cast<float>(2 * numBins);
+    const int32_t usableBins = std::min(numBins, maxBins_);
 
-    // 将 Hz 范围映射到 bin 索引范围 [kMin, kMax]
+    // 将 Hz 范围映射到 bin 索引范围 [kMin, kMax]；最高次谐波须落在谱内
+    const int32_t kLimit = (usableBins - 1) / maxHarmonics;
     const int32_t kMin = std::max<int32_t>(1, static_cast<int32_t>(std::floor(minHz / freqRes)));
-    const int32_t kMax = std::min<int32_t>(numBins - 1,
-                                           static_cast<int32_t>(std::ceil(maxHz / freqRes)));
+    const int32_t kMax = std::min<int32_t>(kLimit, static_cast<int32_t>(std::ceil(maxHz / freqRes)));
     if (kMax <= kMin) return Result{-1.0f, 0.0f};
 
-    // 归一化：避免多个小于 1 的数连乘下溢为 0
+    // 归一化只影响可信度：对数域求和不会下溢，最大值留到最后换算
     float maxMag = 0.0f;
-    for (int32_t k = kMin; k <= kMax && k < numBins; ++k) {
+    for (int32_t k = kMin; k <= kMax; ++k) {
         maxMag = std::max(maxMag, magnitudes[k]);
     }
-    const float invMax = 1.0f / (maxMag + kEps);
 
-    float bestScore = -1.0f;
-    int32_t bestK = -1;
+    // --- 1) 用到的幅度整段取 log2（两侧各多一个 bin，供细化时取邻点）；基频项直接作为初始得分 ---
+    const int32_t logLo = kMin - 1;
+    const int32_t logHi = std::min(usableBins - 1, kMax * maxHarmonics + 1);
+    const int32_t count = kMax - kMin + 1;
+    const DspKernels& kernels = dspKernels();
+    float* logMag = logMag_.data();
+    float* score = score_.data();
+    float* dec = decimated_.data();
+    kernels.log2(magnitudes + logLo, logMag + logLo, logHi - logLo + 1);
+    std::copy(logMag + kMin, logMag + kMax + 1, score);
 
-    for (int32_t k = kMin; k <= kMax; ++k) {
+    // --- 2) 逐谐波抽取连续的降采样谱 dec[j] = log2|X[(kMin + j) * h]| 并累加 ---
+    for (int32_t h = 2; h <= maxHarmonics; ++h) {
+        const float* src = logMag + static_cast<size_t>(kMin) * h;
+        for (int32_t j = 0; j < count; ++j) {
+            dec[j] = src[static_cast<size_t>(j) * h];
+        }
+        kernels.accumulate(score, dec, count);
+    }
+
+    int32_t bestJ = 0;
+    for (int32_t j = 1; j < count; ++j) {
+        if (score[j] > score[bestJ]) bestJ = j;
+    }
+    const float best = score[bestJ];
+
+    // --- 3) 亚 bin 细化：前几次谐波各自在 log 幅度谱上做抛物线插值，折算回基频后按幅度加权 ---
+    // 降采样谱上相邻候选对应第 h 次谐波相隔 h 个 bin，直接在得分上插值会被高次谐波的主瓣形状带偏
+    const int32_t bestK = kMin + bestJ;
+    const int32_t refineHarmonics = std::min(kRefineHarmonics, maxHarmonics);
+    double weightedK = 0.0;
+    double weightSum = 0.0;
+    for (int32_t h = 1; h <= refineHarmonics; ++h) {
+        // 基频在 bestK ± 0.5 内时，第 h 次谐波落在 bestK * h ± h / 2
+        const int32_t lo = std::max(logLo + 1, bestK * h - h / 2);
+        const int32_t hi = std::min(logHi - 1, bestK * h + h / 2);
+        if (hi < lo) continue;
+        int32_t peak = lo;
+        for (int32_t b = lo + 1; b <= hi; ++b) {
+            if (logMag[b] > logMag[peak]) peak = b;
+        }
+        const float l = logMag[peak - 1];
+        const float c = logMag[peak];
+        const float r = logMag[peak + 1];
+        const float denom = l - 2.0f * c + r;
+        const float delta = denom < 0.0f ? std::clamp(0.5f * (l - r) / denom, -0.5f, 0.5f) : 0.0f;
+        const double weight = magnitudes[peak];
+        weightedK += weight * (static_cast<double>(peak) + delta) / h;
+        weightSum += weight;
+    }
+    const float refinedK = weightSum > 0.0 ? static_cast<float>(weightedK / weightSum) : static_cast<float>(bestK);
+
+    // 可信度沿用归一化乘积：prod(|X[kh]| / max) = 2^(sum - H * log2(max))
+    const float frequencyHz = refinedK * freqRes;
+    const float logNorm = static_cast<float>(maxHarmonics) * std::log2(maxMag + kEps);
+    const float confidence = std::clamp(std::exp2(best - logNorm), 0.0f, 1.0f);
+    return Result{frequencyHz, confidence};
+}
+
+HPS::Result HPS::detectSemitone(const float* cq, const float* binHz, int32_t numBins, int32_t binsPerSemitone,
+                                int32_t maxHarmonics, float minHz, float maxHz) {
+    if (cq == nullptr || binHz == nullptr || numBins <= 2 || binsPerSemitone <= 0) {
+        return Result{-1.0f, 0.0f};
+    }
+    maxHarmonics = std::clamp<int32_t>(maxHarmonics, 2, kMaxHarmonics);
+
+    // 谐波相对基频的 bin 偏移：12k * log2(h)
+    int32_t offsets[kMaxHarmonics];
+    for (int32_t h = 1; h <= maxHarmonics; ++h) {
+        offsets[h - 1] = static_cast<int32_t>(
+            std::lround(12.0f * static_cast<float>(binsPerSemitone) * std::log2(static_cast<float>(h))));
+    }
+
+    // Hz 范围 -> bin 范围：两端各放宽到范围外的相邻 bin
+    const int32_t bMin = std::max<int32_t>(
+        0, static_cast<int32_t>(std::upper_bound(binHz, binHz + numBins, minHz) - binHz) - 1);
+    const int32_t bMax = std::min<int32_t>(
+        numBins - 1, static_cast<int32_t>(std::lower_bound(binHz, binHz + numBins, maxHz) - binHz));
+    if (bMax <= bMin) return Result{-1.0f, 0.0f};
+
+    float maxMag = 0.0f;
+    for (int32_t b = bMin; b < numBins; ++b) {
+        maxMag = std::max(maxMag, cq[b]);
+    }
+    const float invMax = 1.0f / (maxMag + kEps);
+
+    auto scoreAt = [&](int32_t b) {
         float score = 1.0f;
-        for (int32_t h = 1; h <= maxHarmonics; ++h) {
-            const int32_t kh = k * h;
-            if (kh >= numBins) {
-                score = 0.0f;
-                break;
-            }
-            score *= (magnitudes[kh] * invMax);
+        for (int32_t h = 0; h < maxHarmonics; ++h) {
+            const int32_t bh = b + offsets[h];
+            if (bh >= numBins) return 0.0f;
+            score *= cq[bh] * invMax;
         }
+        return score;
+    };
+
+    float bestScore = -1.0f;
+    int32_t bestB = -1;
+    for (int32_t b = bMin; b <= bMax; ++b) {
+        const float score = scoreAt(b);
         if (score > bestScore) {
             bestScore = score;
-            bestK = k;
+            bestB = b;
         }
     }
+    if (bestB < 0 || bestScore <= 0.0f) return Result{-1.0f, 0.0f};
 
-    if (bestK < 0) return Result{-1.0f, 0.0f};
+    // 抛物线插值（在得分上）求分数 bin
+    float delta = 0.0f;
+    if (bestB > 0 && bestB + 1 < numBins) {
+        const float l = scoreAt(bestB - 1);
+        const float r = scoreAt(bestB + 1);
+        const float denom = l - 2.0f * bestScore + r;
+        if (denom < 0.0f) {
+            delta = std::clamp(0.5f * (l - r) / denom, -0.5f, 0.5f);
+        }
+    }
 
-    const float frequencyHz = static_cast<float>(bestK) * freqRes;
+    // 分数 bin -> Hz：在偏移方向的相邻 bin 中心之间按对数频率插值
+    const int32_t neighbour = delta >= 0.0f ? std::min(bestB + 1, numBins - 1) : std::max(bestB - 1, 0);
+    const float frequencyHz = binHz[bestB] * std::pow(binHz[neighbour] / binHz[bestB], std::fabs(delta));
     const float confidence = std::clamp(bestScore, 0.0f, 1.0f);
     return Result{frequencyHz, confidence};
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstdint>
+#include <vector>
 
 /**
  * @class HPS
@@ -8,6 +9,16 @@
  *
  * 思路：对每个候选基频 bin k，把 |X[k]|*|X[2k]|*|X[3k]|*... 相乘（归一化后），
  * 得分最高的 k 对应基频 f = k * (sampleRate / fftSize)。
+ *
+ * [detect] 在对数域实现：每帧先把用到的幅度整段取 log2，再按 h = 2..H 抽取出连续的降采样谱
+ * dec_h[j] = log2|X[(kMin + j) * h]|，逐段 SIMD 累加（见 [DspKernels::log2] / [DspKernels::accumulate]），
+ * 取代逐候选的跨步访存与越界分支。得分最高的 bin 再经亚 bin 细化：前 3 次谐波各自在 log 幅度谱上
+ * 做抛物线插值、折算回基频后按幅度加权，频率不再量化到整 bin（bin 宽 23.4 Hz 的 2048 点谱上误差中位数约 0.5 音分）。
+ * 缓冲在构造时按 maxBins 分配，[detect] 不做堆分配。
+ *
+ * [detectSemitone] 为半音域版本：输入 [ConstantQ] 的对数频率谱，第 h 次谐波与基频的 bin 距离
+ * 恒为 round(12k log2 h)，乘积只需整数偏移（拉伸调律下谐波偏离该距离远小于一个 bin）；
+ * 峰值做抛物线插值，再按相邻 bin 的中心频率（来自调律表）几何插值得到 Hz。
  */
 class HPS {
 public:
@@ -16,13 +27,41 @@ public:
         float confidence;  ///< 0..1，来自归一化乘积的启发值
     };
 
+    /** 默认支持的最大 bin 数：多分辨率长窗 8192 点 FFT 的 N/2 */
+    static constexpr int32_t kDefaultMaxBins = 4096;
+    /** 参与乘积的最大谐波次数 */
+    static constexpr int32_t kMaxHarmonics = 16;
+
+    /** @param maxBins [detect] 支持的最大幅度长度；更长的谱只用前 maxBins 个 bin */
+    explicit HPS(int32_t maxBins = kDefaultMaxBins);
+
     /**
      * @param magnitudes FFT 幅度，下标 k 对应频率 k * sampleRate / fftSize
-     * @param numBins 幅度长度（通常为 N/2）
+     * @param numBins 幅度长度，须为 N/2（据此换算 bin 宽 sampleRate / N）
      * @param sampleRate 采样率
-     * @param maxHarmonics 参与乘积的最大谐波次数（含基频为 1）
+     * @param maxHarmonics 参与乘积的最大谐波次数（含基频为 1），2..[kMaxHarmonics]；
+     *        第 maxHarmonics 次谐波落在谱外的候选不参与搜索
      * @param minHz/maxHz 钢琴基频搜索范围
      */
     Result detect(const float* magnitudes, int32_t numBins, float sampleRate,
                    int32_t maxHarmonics, float minHz, float maxHz);
+
+    /**
+     * @param cq [ConstantQ::transform] 输出
+     * @param binHz 各 bin 中心频率（[ConstantQ::binFrequencies]，按调律表取样），长度 numBins，严格递增
+     * @param numBins cq 长度
+     * @param binsPerSemitone 每半音 bin 数
+     * @param maxHarmonics/minHz/maxHz 同 [detect]
+     */
+    Result detectSemitone(const float* cq, const float* binHz, int32_t numBins, int32_t binsPerSemitone,
+                          int32_t maxHarmonics, float minHz, float maxHz);
+
+private:
+    int32_t maxBins_;
+    /** 本帧幅度的 log2，按原 bin 下标存放 */
+    std::vector<float> logMag_;
+    /** 候选 bin 的对数得分，下标 j 对应 bin k0 + j */
+    std::vector<float> score_;
+    /** 当前谐波次数的降采样谱（连续存放，供 SIMD 累加） */
+    std::vector<float> decimated_;
 };
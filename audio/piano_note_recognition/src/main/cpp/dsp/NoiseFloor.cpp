@@ -0,0 +1,89 @@
+#include "NoiseFloor.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+NoiseFloor::NoiseFloor(int32_t maxBins)
+    : maxBins_(std::max(maxBins, 1)),
+      smoothed_(static_cast<size_t>(maxBins_), 0.0f),
+      currentMin_(static_cast<size_t>(maxBins_), FLT_MAX),
+      subWindowMin_(static_cast<size_t>(maxBins_) * kMaxSubWindows, FLT_MAX),
+      windowMin_(static_cast<size_t>(maxBins_), FLT_MAX),
+      floorMag_(static_cast<size_t>(maxBins_), 0.0f) {}
+
+void NoiseFloor::setConfig(const Config& config) {
+    config_ = config;
+    config_.smoothing = std::clamp(config_.smoothing, 0.0f, 0.99f);
+    config_.subWindowHops = std::max(config_.subWindowHops, 1);
+    config_.numSubWindows = std::clamp<int32_t>(config_.numSubWindows, 1, kMaxSubWindows);
+    reset();
+}
+
+void NoiseFloor::reset() {
+    numBins_ = 0;
+    hopsInSubWindow_ = 0;
+    completedSubWindows_ = 0;
+    nextSubWindow_ = 0;
+}
+
+void NoiseFloor::track(const float* magnitudes, int32_t numBins) {
+    numBins = std::min(numBins, maxBins_);
+    if (magnitudes == nullptr || numBins <= 0) return;
+
+    // --- 1) 平滑功率与当前子窗最小值；首帧或 bin 数变化时以本帧为初值 ---
+    const float a = config_.smoothing;
+    if (numBins != numBins_) {
+        reset();
+        numBins_ = numBins;
+        for (int32_t k = 0; k < numBins; ++k) {
+            smoothed_[k] = magnitudes[k] * magnitudes[k];
+            currentMin_[k] = smoothed_[k];
+            windowMin_[k] = FLT_MAX;
+        }
+    } else {
+        for (int32_t k = 0; k < numBins; ++k) {
+            const float p = a * smoothed_[k] + (1.0f - a) * magnitudes[k] * magnitudes[k];
+            smoothed_[k] = p;
+            currentMin_[k] = std::min(currentMin_[k], p);
+        }
+    }
+
+    // --- 2) 子窗满：存入环形子窗表，重算已完成子窗的逐 bin 最小值 ---
+    if (++hopsInSubWindow_ >= config_.subWindowHops) {
+        float* slot = subWindowMin_.data() + static_cast<size_t>(nextSubWindow_) * maxBins_;
+        std::copy(currentMin_.begin(), currentMin_.begin() + numBins, slot);
+        nextSubWindow_ = (nextSubWindow_ + 1) % config_.numSubWindows;
+        completedSubWindows_ = std::min(completedSubWindows_ + 1, config_.numSubWindows);
+        hopsInSubWindow_ = 0;
+
+        std::fill_n(windowMin_.begin(), numBins, FLT_MAX);
+        for (int32_t s = 0; s < completedSubWindows_; ++s) {
+            const float* sub = subWindowMin_.data() + static_cast<size_t>(s) * maxBins_;
+            for (int32_t k = 0; k < numBins; ++k) windowMin_[k] = std::min(windowMin_[k], sub[k]);
+        }
+        std::copy(smoothed_.begin(), smoothed_.begin() + numBins, currentMin_.begin());
+    }
+}
+
+float NoiseFloor::whiten(const float* magnitudes, float* out, int32_t numBins) {
+    numBins = std::min(numBins, maxBins_);
+    if (magnitudes == nullptr || out == nullptr || numBins <= 0) return 0.0f;
+    track(magnitudes, numBins);
+
+    // --- 3) 谱减白化，同时累计高出噪声底的幅度 ---
+    const float beta = config_.overSubtraction;
+    const float kappa = config_.spectralFloor;
+    double total = 0.0;
+    double excess = 0.0;
+    for (int32_t k = 0; k < numBins; ++k) {
+        const float m = magnitudes[k];
+        const float n = std::sqrt(std::min(windowMin_[k], currentMin_[k]));
+        floorMag_[k] = n;
+        const float e = m - beta * n;
+        total += m;
+        if (e > 0.0f) excess += e;
+        out[k] = std::max(e, kappa * m);
+    }
+    return total > 0.0 ? static_cast<float>(excess / total) : 0.0f;
+}
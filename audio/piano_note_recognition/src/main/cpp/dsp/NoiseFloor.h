@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * @class NoiseFloor
+ * @brief 逐 bin 噪声底跟踪（最小统计）+ 谱减白化：压掉风扇、空调、工频等稳态噪声对 HPS 乘积的偏置
+ *
+ * 跟踪（每次 [whiten] 或 [track] 更新一次）：
+ * - 各 bin 功率按 [Config::smoothing] 做一阶递归平滑；
+ * - 最小统计：每 [Config::subWindowHops] 帧为一个子窗，记录子窗内平滑功率的最小值，
+ *   保留最近 [Config::numSubWindows] 个子窗的最小值；噪声底 = 这些子窗与当前子窗的最小值。
+ *   噪声底因此在约 subWindowHops × numSubWindows 帧内跟上噪声变化，且不被短暂的音符抬高。
+ * - 冷启动（尚无完整子窗）时取已见帧的最小值。
+ *
+ * 白化（谱减 + 谱底）：out[k] = max(|X[k]| - β·N[k], κ·|X[k]|)，β 为 [Config::overSubtraction]，
+ * κ 为 [Config::spectralFloor]。高出噪声底的谐波几乎原样保留，噪声 bin 最多衰减到 κ 倍；
+ * 持续时间超过跟踪窗口的延音会被整体视为噪声底、各 bin 同比衰减到 κ 倍，HPS 按最大值归一后结果与未白化时相同。
+ *
+ * 内存：各状态数组在构造时按 maxBins 分配；bin 数变化时清空历史，不分配。
+ */
+class NoiseFloor {
+public:
+    struct Config {
+        float smoothing = 0.8f;       ///< 功率递归平滑系数（0..1，越大越平滑）
+        int32_t subWindowHops = 24;   ///< 子窗帧数
+        int32_t numSubWindows = 4;    ///< 子窗个数（1..[kMaxSubWindows]）；跟踪窗口约 1 s（@48k / 512）
+        float overSubtraction = 2.0f; ///< 过减因子 β：补偿最小统计对均值的低估
+        float spectralFloor = 0.1f;   ///< 谱底 κ：单个 bin 最多衰减到原幅度的该比例（-20 dB）
+    };
+
+    static constexpr int32_t kMaxSubWindows = 8;
+
+    /** @param maxBins 支持的最大 bin 数 */
+    explicit NoiseFloor(int32_t maxBins);
+
+    void setConfig(const Config& config);
+    const Config& config() const { return config_; }
+
+    /** 清空历史（输入不连续时调用） */
+    void reset();
+
+    /**
+     * 用本帧幅度更新噪声底，并把白化后的幅度写入 out（可与 magnitudes 相同，原地白化）。
+     * @param numBins 幅度长度（<= maxBins）
+     * @return 本帧高出噪声底的幅度占总幅度的比例 0..1（纯稳态噪声接近 0，清晰的音接近 1）
+     */
+    float whiten(const float* magnitudes, float* out, int32_t numBins);
+
+    /**
+     * 只用本帧幅度更新噪声底，不输出白化结果：供不做谱分析的帧（如起音门控下的静音 / 延音帧）
+     * 保持跟踪，使子窗按实际帧数轮换。
+     */
+    void track(const float* magnitudes, int32_t numBins);
+
+    /** 当前噪声底（幅度，未乘过减因子），长度为最近一次 [whiten] 的 numBins；[track] 不刷新 */
+    const float* floor() const { return floorMag_.data(); }
+
+private:
+    Config config_;
+    int32_t maxBins_;
+    int32_t numBins_{0};
+
+    /** 平滑功率 */
+    std::vector<float> smoothed_;
+    /** 当前子窗的最小功率 */
+    std::vector<float> currentMin_;
+    /** 已完成子窗的最小功率，按子窗连续存放（子窗 s 位于 [s * maxBins, (s + 1) * maxBins)） */
+    std::vector<float> subWindowMin_;
+    /** 已完成子窗最小值的逐 bin 最小值（子窗轮换时重算） */
+    std::vector<float> windowMin_;
+    std::vector<float> floorMag_;
+
+    int32_t hopsInSubWindow_{0};
+    int32_t completedSubWindows_{0};
+    int32_t nextSubWindow_{0};
+};
@@ -0,0 +1,116 @@
+#include "OnsetDetector.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+/** 对数压缩系数：log(1 + γ a)，a 为按正弦幅度归一的 bin 幅度 */
+constexpr float kCompression = 100.0f;
+
+/** 通量只统计该频率以下的 bin：钢琴能量集中于此，且 log 是门控路径上的主要开销 */
+constexpr float kFluxMaxHz = 6000.0f;
+
+/** 起音定位的小块长度 */
+constexpr int32_t kLocateBlock = 64;
+
+/** 音量相对上次分析时降到该比例以下即重新分析（尽快跟上释音 / 换到更弱的音） */
+constexpr float kReleaseRatio = 0.5f;
+constexpr double kEnergyEps = 1e-12;
+}
+
+OnsetDetector::OnsetDetector(int32_t maxBins) : prevLog_(static_cast<size_t>(std::max(maxBins, 1)), 0.0f) {}
+
+void OnsetDetector::reset() {
+    prevBins_ = 0;
+    historyCount_ = 0;
+    historyPos_ = 0;
+    lastFlux_ = 0.0f;
+    silent_ = true;
+    hopsSinceOnset_ = 0;
+    hopsSinceAnalysis_ = 0;
+    analyzedVolume_ = 0.0f;
+}
+
+OnsetDetector::Decision OnsetDetector::update(const float* magnitudes, int32_t numBins, int32_t fftSize,
+                                              float sampleRate, float volume) {
+    const int32_t maxBin = sampleRate > 0.0f
+                               ? static_cast<int32_t>(kFluxMaxHz * static_cast<float>(fftSize) / sampleRate)
+                               : numBins;
+    numBins = std::min<int32_t>({numBins, maxBin, static_cast<int32_t>(prevLog_.size())});
+
+    // --- 1) 谱通量：对数幅度的正向增量；bin 数变化（切换分辨率）时本帧只建立基线 ---
+    const float scale = kCompression * 4.0f / static_cast<float>(std::max(fftSize, 1));
+    float flux = 0.0f;
+    const bool havePrev = prevBins_ == numBins;
+    for (int32_t k = 0; k < numBins; ++k) {
+        const float c = std::log(1.0f + scale * magnitudes[k]);
+        if (havePrev) flux += std::max(0.0f, c - prevLog_[k]);
+        prevLog_[k] = c;
+    }
+    if (!havePrev) historyCount_ = 0;
+    prevBins_ = numBins;
+    flux /= static_cast<float>(std::max(numBins, 1));
+    lastFlux_ = flux;
+
+    // 自适应阈值取历史（不含本帧），再把本帧计入历史
+    float mean = 0.0f;
+    for (int32_t i = 0; i < historyCount_; ++i) mean += fluxHistory_[i];
+    if (historyCount_ > 0) mean /= static_cast<float>(historyCount_);
+    const float threshold = mean * config_.fluxMultiplier + config_.fluxDelta;
+    fluxHistory_[historyPos_] = flux;
+    historyPos_ = (historyPos_ + 1) % kHistory;
+    historyCount_ = std::min(historyCount_ + 1, kHistory);
+
+    // --- 2) 音量门 ---
+    if (volume < config_.silenceVolume) {
+        silent_ = true;
+        return Decision::Silent;
+    }
+
+    // --- 3) 起音：从静音恢复，或通量越过阈值 ---
+    const bool onset = silent_ || (havePrev && flux > threshold && hopsSinceOnset_ >= kMinOnsetIntervalHops);
+    silent_ = false;
+    if (onset) {
+        hopsSinceOnset_ = 0;
+        hopsSinceAnalysis_ = 0;
+        analyzedVolume_ = volume;
+        return Decision::Onset;
+    }
+
+    // --- 4) 起音后窗口填满前持续分析；之后定期刷新，或音量明显回落时刷新 ---
+    hopsSinceOnset_ = std::min(hopsSinceOnset_ + 1, config_.postOnsetHops + kMinOnsetIntervalHops);
+    ++hopsSinceAnalysis_;
+    if (hopsSinceOnset_ < config_.postOnsetHops || hopsSinceAnalysis_ >= config_.refreshHops ||
+        volume < kReleaseRatio * analyzedVolume_) {
+        hopsSinceAnalysis_ = 0;
+        analyzedVolume_ = volume;
+        return Decision::Analyze;
+    }
+    return Decision::Reuse;
+}
+
+int32_t OnsetDetector::locate(const float* window, int32_t windowSize, int32_t searchLength) {
+    searchLength = std::clamp<int32_t>(searchLength, kLocateBlock, windowSize - kLocateBlock);
+    const float* end = window + windowSize;
+
+    auto blockEnergy = [](const float* p) {
+        double e = 0.0;
+        for (int32_t i = 0; i < kLocateBlock; ++i) e += static_cast<double>(p[i]) * static_cast<double>(p[i]);
+        return e;
+    };
+
+    // 逐块与前一块比较能量，取比值最大的块起点；第一块的“前一块”在搜索段之外
+    int32_t bestLag = searchLength;
+    double bestRatio = 0.0;
+    double prev = blockEnergy(end - searchLength - kLocateBlock);
+    for (int32_t lag = searchLength; lag >= kLocateBlock; lag -= kLocateBlock) {
+        const double e = blockEnergy(end - lag);
+        const double ratio = e / (prev + kEnergyEps);
+        if (ratio > bestRatio) {
+            bestRatio = ratio;
+            bestLag = lag;
+        }
+        prev = e;
+    }
+    return bestLag;
+}
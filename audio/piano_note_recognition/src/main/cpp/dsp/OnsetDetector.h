@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * @class OnsetDetector
+ * @brief 起音 / 新颖度检测：决定本帧是否需要跑 HPS / YIN，静音或稳定延音时复用上一帧结果
+ *
+ * 判决（每帧一次 [update]）：
+ * - 音量门：[FFTWrapper::Spectrum::rms]（加窗时顺带算出的能量）低于 [Config::silenceVolume] -> Silent。
+ * - 谱通量：对数压缩幅度 log(1 + γ|X|) 相对上一帧的正向增量之和（只统计 6 kHz 以下，按 bin 数归一），
+ *   超过“最近 [kHistory] 帧通量均值 × [Config::fluxMultiplier] + [Config::fluxDelta]”即为起音；
+ *   从静音恢复也算起音。两次起音至少间隔 [kMinOnsetIntervalHops] 帧。
+ * - 起音后 [Config::postOnsetHops] 帧内（窗口尚未被新音填满）全部分析 -> Analyze，
+ *   保证与不做门控相比识别时延不变；之后 -> Reuse，每 [Config::refreshHops] 帧强制分析一次，
+ *   兜住无明显通量的连奏换音与缓慢变化；音量降到上次分析时的一半以下也立即分析（释音）。
+ *
+ * 起音定位：[locate] 在窗口末端一段内按 64 点小块能量比找出能量突增处，换算为距窗口末端的样本数，
+ * 由调用方（[AudioEngine]）转为输入帧号，作为 note-on 时间戳。
+ *
+ * 内存：上一帧对数谱在构造时按 maxBins 分配；bin 数变化（切换分辨率）时清空历史，不分配。
+ */
+class OnsetDetector {
+public:
+    enum class Decision {
+        Silent,  ///< 低于音量门：无音
+        Onset,   ///< 起音帧：须分析
+        Analyze, ///< 起音后或定期刷新：须分析
+        Reuse,   ///< 稳定延音：可复用上一帧结果
+    };
+
+    struct Config {
+        float silenceVolume = 0.004f; ///< 音量门（映射后的 0..1 音量，约 -54 dBFS）
+        float fluxMultiplier = 1.5f;  ///< 自适应阈值倍数
+        float fluxDelta = 0.02f;      ///< 自适应阈值偏置
+        int32_t postOnsetHops = 5;    ///< 起音后连续分析的帧数（2048 窗 / 512 hop + 1）
+        int32_t refreshHops = 8;      ///< 延音期间强制分析的间隔
+    };
+
+    /** 自适应阈值的历史帧数 */
+    static constexpr int32_t kHistory = 8;
+    static constexpr int32_t kMinOnsetIntervalHops = 2;
+
+    /** @param maxBins 支持的最大幅度谱长度 */
+    explicit OnsetDetector(int32_t maxBins = 4096);
+
+    void setConfig(const Config& config) { config_ = config; }
+    const Config& config() const { return config_; }
+
+    /** 清空历史；下一帧有声即判为起音 */
+    void reset();
+
+    /**
+     * @param magnitudes 本帧幅度谱，长度 numBins（<= maxBins）
+     * @param fftSize 幅度谱对应的 FFT 点数（用于幅度归一）
+     * @param sampleRate 采样率（用于截取统计频段）
+     * @param volume 本帧音量 0..1（[FFTWrapper::Spectrum::rms]）
+     */
+    Decision update(const float* magnitudes, int32_t numBins, int32_t fftSize, float sampleRate, float volume);
+
+    /** 最近一帧的谱通量（调参 / 基准用） */
+    float lastFlux() const { return lastFlux_; }
+
+    /**
+     * 在 window 末尾 searchLength 个样本内定位起音（能量突增的 64 点小块起点）。
+     * @return 起音点距窗口末端的样本数（1..searchLength）
+     */
+    static int32_t locate(const float* window, int32_t windowSize, int32_t searchLength);
+
+private:
+    Config config_;
+
+    std::vector<float> prevLog_;
+    int32_t prevBins_{0};
+
+    float fluxHistory_[kHistory] = {};
+    int32_t historyCount_{0};
+    int32_t historyPos_{0};
+    float lastFlux_{0.0f};
+
+    bool silent_{true};
+    int32_t hopsSinceOnset_{0};
+    int32_t hopsSinceAnalysis_{0};
+    /** 上次判为须分析时的音量 */
+    float analyzedVolume_{0.0f};
+};
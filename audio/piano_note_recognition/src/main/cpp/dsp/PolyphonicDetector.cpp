@@ -0,0 +1,208 @@
+#include "PolyphonicDetector.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+constexpr float kEps = 1e-12f;
+
+/** Klapuri 谐波权重 g(h) = (f0 + α) / (h * f0 + β)：高次谐波与高音区的权重递减 */
+constexpr float kWeightAlphaHz = 27.0f;
+constexpr float kWeightBetaHz = 320.0f;
+
+/** 搜索区间上沿按 h^2 放宽，覆盖典型非谐系数 B <= 4e-4（f_h = h f0 sqrt(1 + B h^2)） */
+constexpr float kStretchPerH2 = 2e-4f;
+
+/** 相减时处理的主瓣半宽（Hann 主瓣 ±2 bin） */
+constexpr int32_t kLobeHalfWidth = 2;
+
+/**
+ * 基频可分辨（>= 该 bin）的键要求基频处确有能量：不低于其最强谐波的该比例。
+ * 否则几个音的公共谐波会拼出一个并不存在的低八度/低五度“虚拟基频”。
+ */
+constexpr int32_t kMinResolvableBin = 3;
+constexpr float kMinFundamentalRatio = 0.1f;
+}
+
+PolyphonicDetector::PolyphonicDetector() {
+    std::fill_n(numHarmonics_, kNumKeys, 0);
+    std::fill_n(weightSum_, kNumKeys, 0.0f);
+    std::fill_n(residual_, kMaxBins, 0.0f);
+    std::fill_n(keySalience_, kNumKeys, 0.0f);
+    const TuningTable equalTemperament;
+    for (int32_t key = 0; key < kNumKeys; ++key) keyHz_[key] = equalTemperament.centerHz(key + kFirstMidi);
+}
+
+void PolyphonicDetector::setConfig(const Config& config) {
+    config_ = config;
+    config_.maxNotes = std::clamp(config_.maxNotes, 1, kMaxNotes);
+}
+
+void PolyphonicDetector::prepare(int32_t fftSize, float sampleRate) {
+    if (fftSize == fftSize_ && sampleRate == sampleRate_) return;
+    fftSize_ = fftSize;
+    sampleRate_ = sampleRate;
+    numBins_ = std::min<int32_t>(fftSize / 2, kMaxBins);
+    rebuild();
+}
+
+void PolyphonicDetector::setTuning(const TuningTable& tuning) {
+    for (int32_t key = 0; key < kNumKeys; ++key) keyHz_[key] = tuning.centerHz(key + kFirstMidi);
+    if (fftSize_ > 0) rebuild();
+}
+
+void PolyphonicDetector::rebuild() {
+    const float binHz = sampleRate_ / static_cast<float>(fftSize_);
+    for (int32_t key = 0; key < kNumKeys; ++key) {
+        const float f0 = keyHz_[key];
+        int32_t count = 0;
+        float sum = 0.0f;
+        for (int32_t h = 1; h <= kMaxHarmonics; ++h) {
+            const float center = static_cast<float>(h) * f0 / binHz;
+            const float stretched = center * (1.0f + kStretchPerH2 * static_cast<float>(h * h));
+            // 区间只覆盖 [最近 bin, 拉伸后最近 bin]：放宽到 ±1 会让低音区的亚谐波键“蹭”到相邻谐波
+            const int32_t lo = std::max<int32_t>(1, static_cast<int32_t>(std::lround(center)));
+            const int32_t hi = std::max<int32_t>(lo, static_cast<int32_t>(std::lround(stretched)));
+            // 主瓣须整体落在谱内，否则后续谐波一律舍弃
+            if (hi + kLobeHalfWidth >= numBins_) break;
+            const float w = (f0 + kWeightAlphaHz) / (static_cast<float>(h) * f0 + kWeightBetaHz);
+            harmLo_[key][count] = lo;
+            harmHi_[key][count] = hi;
+            harmWeight_[key][count] = w;
+            sum += w;
+            ++count;
+        }
+        numHarmonics_[key] = count;
+        weightSum_[key] = sum;
+    }
+}
+
+float PolyphonicDetector::salience(int32_t key) const {
+    float s = 0.0f;
+    float fundamental = 0.0f;
+    float strongest = 0.0f;
+    for (int32_t i = 0; i < numHarmonics_[key]; ++i) {
+        const float peak = *std::max_element(residual_ + harmLo_[key][i], residual_ + harmHi_[key][i] + 1);
+        s += harmWeight_[key][i] * peak;
+        if (i == 0) fundamental = peak;
+        strongest = std::max(strongest, peak);
+    }
+    if (harmLo_[key][0] >= kMinResolvableBin && fundamental < kMinFundamentalRatio * strongest) {
+        return 0.0f;
+    }
+    return s;
+}
+
+float PolyphonicDetector::subtract(int32_t key) {
+    const int32_t count = numHarmonics_[key];
+    float amp[kMaxHarmonics];
+    int32_t peakBin[kMaxHarmonics];
+    for (int32_t i = 0; i < count; ++i) {
+        float* begin = residual_ + harmLo_[key][i];
+        float* peak = std::max_element(begin, residual_ + harmHi_[key][i] + 1);
+        amp[i] = *peak;
+        peakBin[i] = static_cast<int32_t>(peak - residual_);
+    }
+
+    // 谱平滑：本音在第 i 次谐波上的幅度不超过相邻三次谐波的均值，超出部分视为其它音的共享谐波而保留
+    //（八度、五度等上方音的基频恰落在本音谐波上，平滑后才能在下一轮被检出）
+    float energy = 0.0f;
+    for (int32_t i = 0; i < count; ++i) {
+        if (amp[i] <= kEps) continue;
+        const float prev = (i > 0) ? amp[i - 1] : amp[i];
+        const float next = (i + 1 < count) ? amp[i + 1] : amp[i];
+        const float own = std::min(amp[i], (prev + amp[i] + next) / 3.0f);
+        energy += own * own;
+
+        // 主瓣按比例缩小，保持瓣形；相邻谐波主瓣可能重叠，重复缩放只会更保守
+        const float keep = 1.0f - own / amp[i];
+        const int32_t from = std::max<int32_t>(0, peakBin[i] - kLobeHalfWidth);
+        const int32_t to = std::min<int32_t>(numBins_ - 1, peakBin[i] + kLobeHalfWidth);
+        for (int32_t b = from; b <= to; ++b) {
+            residual_[b] *= keep;
+        }
+    }
+    return energy;
+}
+
+float PolyphonicDetector::residualMedian() {
+    const int32_t n = numBins_ - 1;
+    std::copy(residual_ + 1, residual_ + numBins_, scratch_);
+    std::nth_element(scratch_, scratch_ + n / 2, scratch_ + n);
+    return scratch_[n / 2];
+}
+
+int32_t PolyphonicDetector::detect(const float* magnitudes, int32_t numBins, Note* out) {
+    if (magnitudes == nullptr || out == nullptr || numBins != numBins_ || numBins_ <= 1) {
+        return 0;
+    }
+
+    std::copy(magnitudes, magnitudes + numBins_, residual_);
+    const float median = residualMedian();
+    const float binHz = sampleRate_ / static_cast<float>(fftSize_);
+    // 正弦幅度 A 在 Hann 加窗谱峰上约为 A * N / 4
+    const float ampScale = 4.0f / static_cast<float>(fftSize_);
+
+    bool taken[kNumKeys] = {};
+    float firstSalience = 0.0f;
+    int32_t found = 0;
+
+    for (int32_t iter = 0; iter < config_.maxNotes; ++iter) {
+        // --- 1) 残差谱上求各键显著度，取最大者 ---
+        int32_t bestKey = -1;
+        float bestSalience = 0.0f;
+        for (int32_t key = 0; key < kNumKeys; ++key) {
+            if (taken[key] || numHarmonics_[key] == 0) continue;
+            keySalience_[key] = salience(key);
+            if (keySalience_[key] > bestSalience) {
+                bestSalience = keySalience_[key];
+                bestKey = key;
+            }
+        }
+        if (bestKey < 0 || bestSalience <= kEps) break;
+
+        // --- 2) 终止判据：相对首音过弱，或相对背景不可信 ---
+        if (found == 0) firstSalience = bestSalience;
+        if (bestSalience < config_.relativeStop * firstSalience) break;
+        const float background = median * weightSum_[bestKey] * kBackgroundScale;
+        const float confidence = bestSalience / (bestSalience + background + kEps);
+        if (confidence < config_.minConfidence) break;
+
+        // --- 3) 基频细化：最强谐波峰抛物线插值后除以谐波次数 ---
+        int32_t strongest = 0;
+        int32_t strongestBin = harmLo_[bestKey][0];
+        float strongestAmp = -1.0f;
+        for (int32_t i = 0; i < numHarmonics_[bestKey]; ++i) {
+            for (int32_t b = harmLo_[bestKey][i]; b <= harmHi_[bestKey][i]; ++b) {
+                if (residual_[b] > strongestAmp) {
+                    strongestAmp = residual_[b];
+                    strongest = i;
+                    strongestBin = b;
+                }
+            }
+        }
+        float bin = static_cast<float>(strongestBin);
+        if (strongestBin > 0 && strongestBin + 1 < numBins_) {
+            const float s0 = residual_[strongestBin - 1];
+            const float s1 = residual_[strongestBin];
+            const float s2 = residual_[strongestBin + 1];
+            const float denom = 2.0f * s1 - s0 - s2;
+            if (s1 >= s0 && s1 >= s2 && std::fabs(denom) > kEps) {
+                bin += (s2 - s0) / (2.0f * denom);
+            }
+        }
+        const float frequencyHz = bin * binHz / static_cast<float>(strongest + 1);
+
+        // --- 4) 相减并折算音量 ---
+        const float energy = subtract(bestKey);
+        const float rms = std::sqrt(energy * 0.5f) * ampScale;
+
+        taken[bestKey] = true;
+        Note& note = out[found++];
+        note.midiNote = bestKey + kFirstMidi;
+        note.frequencyHz = frequencyHz;
+        note.confidence = std::clamp(confidence, 0.0f, 1.0f);
+        note.volume = std::clamp(rms * 2.0f, 0.0f, 1.0f);
+    }
+    return found;
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstdint>
+
+#include "TuningTable.h"
+
+/**
+ * @class PolyphonicDetector
+ * @brief 多音检测：在 Hann 加窗幅度谱上做迭代谐波相减，每帧最多输出 [kMaxNotes] 个同时发声的琴键
+ *
+ * 思路（Klapuri 式谐波求和 + 相减的简化版）：
+ * 1) 对 88 个琴键，按预计算的谐波表求显著度 s = sum_h w_h * max(R[lo_h .. hi_h])，R 为残差谱；
+ *    区间从 h*f0 的最近 bin 向上放宽到按非谐性拉伸后的 bin（钢琴弦高次泛音略偏高）。
+ *    基频可分辨的键还要求基频处确有能量，排除公共谐波拼出的“虚拟基频”。
+ * 2) 取显著度最大的键作为一个音；其各次谐波幅度按相邻谐波均值做谱平滑后从残差中减去
+ *    （主瓣 ±2 bin），从而保留与其它音共享的谐波（八度、五度），再回到 1)。
+ * 3) 显著度低于首音的 [Config::relativeStop] 或可信度低于 [Config::minConfidence] 时停止。
+ *
+ * 可信度：s / (s + 背景)，背景为残差谱中位数在同一谐波模板下的显著度（乘 [kBackgroundScale]），
+ * 纯音接近 1，白噪声约 0.5。音量按谐波能量折算为正弦 RMS，再沿用单音路径 clamp(rms * 2) 的映射。
+ *
+ * 开销有界：每轮 88 键 × [kMaxHarmonics] 次谐波的小窗取最大值，轮数 <= maxNotes（<= [kMaxNotes]）；
+ * 2048 点 / 48k 下主机实测含 FFT 每帧约 30~50 µs，远低于 10.7 ms 的 hop 周期。
+ *
+ * 主机合成音（12 次非谐泛音 + 噪声）实测：MIDI 40 以上单音全部正确且无多检；
+ * 三/四音和弦约 73% 的音被检出，多检主要是低音区半音邻键与八度。
+ *
+ * 琴键基频取自调律表（[setTuning]，默认 440 Hz 十二平均律），442 Hz 或拉伸调律的琴上谐波区间仍对准实际音高。
+ *
+ * 内存：谐波表与残差谱为定长数组，[prepare] / [setTuning] 只改写数值，构造后不分配。
+ * 分辨率：2048 点时 bin 宽 23.4 Hz，约 MIDI 40 以下相邻键的低次谐波落在同一 bin，只能依靠高次谐波区分，
+ * 该区域结果不可靠。
+ */
+class PolyphonicDetector {
+public:
+    static constexpr int32_t kNumKeys = 88;
+    static constexpr int32_t kFirstMidi = 21;
+    static constexpr int32_t kMaxNotes = 8;
+    static constexpr int32_t kMaxHarmonics = 10;
+    /** 支持的最大 bin 数（N/2），对应 8192 点 FFT */
+    static constexpr int32_t kMaxBins = 4096;
+
+    struct Config {
+        int32_t maxNotes = 6;        ///< 每帧最多输出的音数，1..[kMaxNotes]
+        float minConfidence = 0.7f;  ///< 低于此可信度的候选不输出并终止迭代
+        float relativeStop = 0.25f;  ///< 候选显著度低于首音的该比例时终止迭代
+    };
+
+    struct Note {
+        int32_t midiNote;  ///< 21..108
+        float frequencyHz; ///< 峰值 bin 抛物线插值后的基频估计
+        float confidence;  ///< 0..1
+        float volume;      ///< 0..1
+    };
+
+    PolyphonicDetector();
+
+    /** 按 FFT 点数与采样率重建谐波表；参数未变时直接返回。不分配内存 */
+    void prepare(int32_t fftSize, float sampleRate);
+
+    /** 按调律表的各键中心频率重建谐波表（已 [prepare] 时立即生效）。不分配内存 */
+    void setTuning(const TuningTable& tuning);
+
+    void setConfig(const Config& config);
+    const Config& config() const { return config_; }
+
+    /**
+     * @param magnitudes Hann 加窗后的幅度谱，长度 numBins（须与 [prepare] 的 fftSize / 2 一致）
+     * @param out 输出，容量至少 [Config::maxNotes]；按检出顺序（显著度降序）
+     * @return 检出的音数
+     */
+    int32_t detect(const float* magnitudes, int32_t numBins, Note* out);
+
+private:
+    /** 按 [fftSize_] / [sampleRate_] / [keyHz_] 重算谐波表 */
+    void rebuild();
+    /** 第 key 个琴键在残差谱上的显著度 */
+    float salience(int32_t key) const;
+    /** 按谐波表把第 key 个琴键从残差中减去，返回其谐波幅度平方和 */
+    float subtract(int32_t key);
+    /** 残差谱中位数（用于背景显著度） */
+    float residualMedian();
+
+    Config config_;
+
+    int32_t fftSize_{0};
+    float sampleRate_{0.0f};
+    int32_t numBins_{0};
+    /** 各琴键基频 Hz（[setTuning]） */
+    float keyHz_[kNumKeys];
+
+    /** 每键有效谐波数与各次谐波的搜索区间 [lo, hi]、权重 */
+    int32_t numHarmonics_[kNumKeys];
+    int32_t harmLo_[kNumKeys][kMaxHarmonics];
+    int32_t harmHi_[kNumKeys][kMaxHarmonics];
+    float harmWeight_[kNumKeys][kMaxHarmonics];
+    /** 每键权重和，背景显著度 = 中位数 * 权重和 * [kBackgroundScale] */
+    float weightSum_[kNumKeys];
+
+    float residual_[kMaxBins];
+    float scratch_[kMaxBins];
+    float keySalience_[kNumKeys];
+
+    static constexpr float kBackgroundScale = 4.0f;
+};
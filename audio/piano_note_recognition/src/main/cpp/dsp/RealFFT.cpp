@@ -0,0 +1,168 @@
+#include "RealFFT.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+constexpr double kPi = 3.14159265358979323846;
+}
+
+RealFFT::RealFFT(int32_t size, int32_t prefixSize)
+    : size_(size), half_(size / 2), core_(size / 2) {
+    // --- 拆分旋转因子：double 直接求值 ---
+    splitTwRe_.resize(half_);
+    splitTwIm_.resize(half_);
+    for (int32_t k = 0; k < half_; ++k) {
+        const double ang = -2.0 * kPi * k / static_cast<double>(size_);
+        splitTwRe_[k] = static_cast<float>(std::cos(ang));
+        splitTwIm_[k] = static_cast<float>(std::sin(ang));
+    }
+    workRe_.resize(half_);
+    workIm_.resize(half_);
+
+    if (prefixSize > 0 && prefixSize * 4 <= size_) {
+        prefixSize_ = prefixSize;
+        prefixRe_.resize(prefixSize / 2);
+        prefixIm_.resize(prefixSize / 2);
+    }
+
+#if defined(PIANO_NOTE_USE_PFFFT)
+    // PFFFT 对实数变换有点数约束（32 的倍数），不满足时返回 nullptr，自动回落内置实现
+    pffftSetup_ = pffft_new_setup(size_, PFFFT_REAL);
+    if (pffftSetup_ != nullptr) {
+        const size_t bytes = static_cast<size_t>(size_) * sizeof(float);
+        pffftIn_ = static_cast<float*>(pffft_aligned_malloc(bytes));
+        pffftOut_ = static_cast<float*>(pffft_aligned_malloc(bytes));
+        pffftWork_ = static_cast<float*>(pffft_aligned_malloc(bytes));
+    }
+#endif
+}
+
+RealFFT::~RealFFT() {
+#if defined(PIANO_NOTE_USE_PFFFT)
+    if (pffftSetup_ != nullptr) {
+        pffft_aligned_free(pffftIn_);
+        pffft_aligned_free(pffftOut_);
+        pffft_aligned_free(pffftWork_);
+        pffft_destroy_setup(pffftSetup_);
+    }
+#endif
+}
+
+const char* RealFFT::backendName() {
+#if defined(PIANO_NOTE_USE_PFFFT)
+    return "pffft";
+#else
+    return "builtin";
+#endif
+}
+
+void RealFFT::splitToBins(float* outRe, float* outIm) const {
+    // E[k] = (Z[k] + conj Z[M-k]) / 2，O[k] = -i (Z[k] - conj Z[M-k]) / 2，X[k] = E[k] + W^k O[k]
+    outRe[0] = workRe_[0] + workIm_[0];
+    outIm[0] = 0.0f;
+    outRe[half_] = workRe_[0] - workIm_[0];
+    outIm[half_] = 0.0f;
+    for (int32_t k = 1; k < half_; ++k) {
+        const float aRe = workRe_[k];
+        const float aIm = workIm_[k];
+        // b 取共轭
+        const float bRe = workRe_[half_ - k];
+        const float bIm = workIm_[half_ - k];
+        const float eRe = 0.5f * (aRe + bRe);
+        const float eIm = 0.5f * (aIm - bIm);
+        const float oRe = 0.5f * (aIm + bIm);
+        const float oIm = -0.5f * (aRe - bRe);
+        const float wRe = splitTwRe_[k];
+        const float wIm = splitTwIm_[k];
+        outRe[k] = eRe + (wRe * oRe - wIm * oIm);
+        outIm[k] = eIm + (wRe * oIm + wIm * oRe);
+    }
+}
+
+void RealFFT::forward(const float* in, float* outRe, float* outIm) {
+#if defined(PIANO_NOTE_USE_PFFFT)
+    if (pffftSetup_ != nullptr) {
+        std::copy(in, in + size_, pffftIn_);
+        pffft_transform_ordered(pffftSetup_, pffftIn_, pffftOut_, pffftWork_, PFFFT_FORWARD);
+        outRe[0] = pffftOut_[0];
+        outIm[0] = 0.0f;
+        outRe[half_] = pffftOut_[1];
+        outIm[half_] = 0.0f;
+        for (int32_t k = 1; k < half_; ++k) {
+            outRe[k] = pffftOut_[2 * k];
+            outIm[k] = pffftOut_[2 * k + 1];
+        }
+        return;
+    }
+#endif
+
+    // --- 1) 打包：z[n] = x[2n] + i*x[2n+1]，一次 N/2 点复数 FFT 完成两路实序列 ---
+    for (int32_t i = 0; i < half_; ++i) {
+        workRe_[i] = in[2 * i];
+        workIm_[i] = in[2 * i + 1];
+    }
+    core_.forward(workRe_.data(), workIm_.data());
+
+    // --- 2) 拆分 ---
+    splitToBins(outRe, outIm);
+}
+
+void RealFFT::forwardPrefix(const float* in, float* outRe, float* outIm) {
+    if (prefixSize_ <= 0) return;
+
+    // --- 1) 打包非零部分，其余视为 0，由裁剪变换直接铺满 N/2 点 ---
+    const int32_t q = prefixSize_ / 2;
+    for (int32_t i = 0; i < q; ++i) {
+        prefixRe_[i] = in[2 * i];
+        prefixIm_[i] = in[2 * i + 1];
+    }
+    core_.forwardPrefix(prefixRe_.data(), prefixIm_.data(), q, workRe_.data(), workIm_.data());
+
+    // --- 2) 拆分 ---
+    splitToBins(outRe, outIm);
+}
+
+void RealFFT::inverse(const float* inRe, const float* inIm, float* out) {
+#if defined(PIANO_NOTE_USE_PFFFT)
+    if (pffftSetup_ != nullptr) {
+        pffftIn_[0] = inRe[0];
+        pffftIn_[1] = inRe[half_];
+        for (int32_t k = 1; k < half_; ++k) {
+            pffftIn_[2 * k] = inRe[k];
+            pffftIn_[2 * k + 1] = inIm[k];
+        }
+        pffft_transform_ordered(pffftSetup_, pffftIn_, pffftOut_, pffftWork_, PFFFT_BACKWARD);
+        std::copy(pffftOut_, pffftOut_ + size_, out);
+        return;
+    }
+#endif
+
+    // --- 1) 合并：Z[k] = (X[k] + conj X[M-k]) + i * W^{-k} (X[k] - conj X[M-k])，已含 2 倍缩放 ---
+    //        逆变换借助共轭：IFFT(Z) = conj(FFT(conj Z))，因此这里直接写入 conj Z
+    for (int32_t k = 0; k < half_; ++k) {
+        const float aRe = inRe[k];
+        const float aIm = (k == 0) ? 0.0f : inIm[k];
+        const float bRe = inRe[half_ - k];
+        const float bIm = (k == 0) ? 0.0f : -inIm[half_ - k];
+        const float eRe = aRe + bRe;
+        const float eIm = aIm + bIm;
+        const float dRe = aRe - bRe;
+        const float dIm = aIm - bIm;
+        // W^{-k} = conj(splitTw[k])
+        const float wRe = splitTwRe_[k];
+        const float wIm = splitTwIm_[k];
+        const float oRe = dRe * wRe + dIm * wIm;
+        const float oIm = dIm * wRe - dRe * wIm;
+        // Z = E + i*O
+        workRe_[k] = eRe - oIm;
+        workIm_[k] = -(eIm + oRe);
+    }
+    core_.forward(workRe_.data(), workIm_.data());
+
+    // --- 2) 解包：x[2n] = Re z[n]，x[2n+1] = Im z[n]（再取一次共轭） ---
+    for (int32_t i = 0; i < half_; ++i) {
+        out[2 * i] = workRe_[i];
+        out[2 * i + 1] = -workIm_[i];
+    }
+}
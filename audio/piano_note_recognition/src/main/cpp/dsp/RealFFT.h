@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "ComplexFFT.h"
+
+#if defined(PIANO_NOTE_USE_PFFFT)
+#include "pffft/pffft.h"
+#endif
+
+/**
+ * @class RealFFT
+ * @brief 实数输入 FFT 引擎：N 点实序列打包成 N/2 点复序列变换，再拆分得到 k = 0..N/2 频点
+ *
+ * 说明：
+ * - 复数核心为 [ComplexFFT]；拆分旋转因子在构造时用 double 求值后一次性存表；
+ *   [forward]/[inverse] 内不再调用三角函数，也不分配内存。
+ * - 工作缓冲与旋转因子均为实部/虚部分离布局，蝶形经 [dspKernels] 分派到 NEON / SSE2 / AVX2 / 标量实现。
+ * - 编译期后端：定义 PIANO_NOTE_USE_PFFFT（CMake 检测到 libpffft.a 时自动定义）且 PFFFT
+ *   支持该点数时走 pffft_transform_ordered，否则走内置实现；两者对外结果一致。
+ * - 非线程安全：工作缓冲随实例持有，每个线程各用一个实例。
+ */
+class RealFFT {
+public:
+    /**
+     * @param size 变换点数，须为 2 的幂且 >= 4
+     * @param prefixSize 若 > 0，启用 [forwardPrefix]；须为 2 的幂且 <= size/4
+     */
+    explicit RealFFT(int32_t size, int32_t prefixSize = 0);
+    ~RealFFT();
+
+    RealFFT(const RealFFT&) = delete;
+    RealFFT& operator=(const RealFFT&) = delete;
+
+    int32_t size() const { return size_; }
+
+    /** 输出频点数 N/2+1（含 DC 与 Nyquist） */
+    int32_t numBins() const { return half_ + 1; }
+
+    /**
+     * 正变换 X[k] = sum_n x[n] * e^{-2πikn/N}。
+     * @param in 长度 [size] 的实数序列
+     * @param outRe/outIm 长度 [numBins]
+     */
+    void forward(const float* in, float* outRe, float* outIm);
+
+    /**
+     * 零填充正变换：只有前 prefixSize 个样本非零（构造时指定）。
+     * 打包后的 N/2 点序列仅前 prefixSize/2 个非零，交给 [ComplexFFT::forwardPrefix]
+     * 省去位反序交换与前 log2(N/prefixSize) 级蝶形。
+     * @param in 长度 prefixSize
+     */
+    void forwardPrefix(const float* in, float* outRe, float* outIm);
+
+    /**
+     * 逆变换（不归一化，输出为 N * x[n]）；只使用 k = 0..N/2 的输入，负频率按共轭对称补全。
+     * @param inRe/inIm 长度 [numBins]
+     * @param out 长度 [size]
+     */
+    void inverse(const float* inRe, const float* inIm, float* out);
+
+    /** 当前编译启用的后端名（日志/基准用） */
+    static const char* backendName();
+
+private:
+    /** 把 [workRe_]/[workIm_] 中的 N/2 点复数谱拆分为实序列的 0..N/2 频点 */
+    void splitToBins(float* outRe, float* outIm) const;
+
+    int32_t size_;
+    int32_t half_;
+
+    ComplexFFT core_;
+
+    /** 长度 half_：e^{-2πik/N}，实数拆分/合并用 */
+    std::vector<float> splitTwRe_;
+    std::vector<float> splitTwIm_;
+    /** 复数工作缓冲，实部/虚部分离（SoA） */
+    std::vector<float> workRe_;
+    std::vector<float> workIm_;
+
+    /** [forwardPrefix] 用：非零样本数与打包缓冲（长度 prefixSize/2） */
+    int32_t prefixSize_{0};
+    std::vector<float> prefixRe_;
+    std::vector<float> prefixIm_;
+
+#if defined(PIANO_NOTE_USE_PFFFT)
+    PFFFT_Setup* pffftSetup_{nullptr};
+    float* pffftIn_{nullptr};
+    float* pffftOut_{nullptr};
+    float* pffftWork_{nullptr};
+#endif
+};
@@ -0,0 +1,54 @@
+#include "StageStats.h"
+
+#include <algorithm>
+
+int32_t StageStats::bucketOf(uint64_t v) {
+    constexpr uint64_t kSub = 1u << kSubBucketBits;
+    if (v < kSub) return static_cast<int32_t>(v);
+    const int32_t e = 63 - __builtin_clzll(v);
+    const int32_t bucket = ((e - kSubBucketBits + 1) << kSubBucketBits) +
+                           static_cast<int32_t>((v >> (e - kSubBucketBits)) & (kSub - 1));
+    return std::min(bucket, kNumBuckets - 1);
+}
+
+uint64_t StageStats::bucketUpper(int32_t bucket) {
+    constexpr int32_t kSub = 1 << kSubBucketBits;
+    if (bucket < kSub) return static_cast<uint64_t>(bucket);
+    const int32_t e = (bucket >> kSubBucketBits) + kSubBucketBits - 1;
+    const uint64_t sub = static_cast<uint64_t>(bucket & (kSub - 1));
+    return ((kSub + sub + 1) << (e - kSubBucketBits)) - 1;
+}
+
+StageStats::Summary StageStats::summary(Stage stage) const {
+    Summary out{0, 0, 0, 0};
+    const Histogram& h = histograms_[static_cast<int32_t>(stage)];
+
+    uint64_t counts[kNumBuckets];
+    uint64_t total = 0;
+    for (int32_t b = 0; b < kNumBuckets; ++b) {
+        counts[b] = h.buckets[b].load(std::memory_order_relaxed);
+        total += counts[b];
+    }
+    if (total == 0) return out;
+
+    out.count = total;
+    out.maxNs = h.max.load(std::memory_order_relaxed);
+    auto percentile = [&](uint64_t rank) {
+        uint64_t seen = 0;
+        for (int32_t b = 0; b < kNumBuckets; ++b) {
+            seen += counts[b];
+            if (seen >= rank) return std::min(bucketUpper(b), out.maxNs);
+        }
+        return out.maxNs;
+    };
+    out.p50Ns = percentile((total + 1) / 2);
+    out.p99Ns = percentile((total * 99 + 99) / 100);
+    return out;
+}
+
+void StageStats::reset() {
+    for (Histogram& h : histograms_) {
+        for (auto& b : h.buckets) b.store(0, std::memory_order_relaxed);
+        h.max.store(0, std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,158 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+/**
+ * @file StageStats.h
+ * @brief 识别流水线逐级耗时直方图：音频 / 分析线程上记录，任意线程无锁读取快照
+ *
+ * 说明：
+ * - 定义 PIANO_NOTE_STAGE_STATS 时（CMake 选项 -DPIANO_NOTE_STAGE_STATS=ON，默认开启）才计时；
+ *   未定义时 [StageTimer] 不读时钟、[StageStats::record] 为空，调用处编译为空操作，快照计数恒为 0。
+ * - 直方图为对数线性分桶：每个 2 的幂区间再分 4 桶，相对误差 < 25%，覆盖 1 ns..约 68 s；
+ *   p50 / p99 报告所在桶的上界（偏保守），max 为精确值。
+ * - 每个直方图只有一个写线程（检测器同一时刻只在一个线程上运行；引擎的回调级与交付级分属音频 / 检测线程），
+ *   计数用 relaxed load + store，不用原子读改写；读端 relaxed 读取，快照各项之间可能差一帧，不影响统计意义。
+ * - 定长数组，构造后不分配，可在 [RealtimeScope] 内使用。
+ */
+class StageStats {
+public:
+    /** 计时的各级；检测器记录 Fft..Detect，[AudioEngine] 记录 AudioCallback..EndToEnd */
+    enum class Stage : int32_t {
+        Fft,           ///< FFTWrapper::analyze（多分辨率为长 + 短窗之和）
+        Hps,           ///< 噪声底白化（及常 Q 前端）+ HPS::detect
+        Yin,           ///< 融合中的窄带 / 全范围 YIN
+        Polyphonic,    ///< 多音模式的迭代谐波相减
+        Detect,        ///< 一帧检测总耗时（process / processMultiResolution / processPolyphonic）
+        AudioCallback, ///< 输入源数据回调总耗时（Inline 含检测；Pipelined 只含入队）
+        Dispatch,      ///< 结果交付：逐帧回调与批量事件回调（JNI 调用 Kotlin）
+        EndToEnd,      ///< 窗口末样本的采集时刻 -> 结果开始交付
+    };
+
+    static constexpr int32_t kNumStages = 8;
+    static constexpr int32_t kSubBucketBits = 2;
+    static constexpr int32_t kNumBuckets = 36 << kSubBucketBits;
+
+    /** 一级的快照；count 为 0 时其余为 0 */
+    struct Summary {
+        uint64_t count;
+        uint64_t p50Ns;
+        uint64_t p99Ns;
+        uint64_t maxNs;
+    };
+
+    /** 计时是否编译启用 */
+    static constexpr bool enabled() {
+#if defined(PIANO_NOTE_STAGE_STATS)
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    static int64_t nowNs() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+    }
+
+    /** 记录一次耗时；只能由写线程调用 */
+    void record(Stage stage, int64_t ns) {
+#if defined(PIANO_NOTE_STAGE_STATS)
+        Histogram& h = histograms_[static_cast<int32_t>(stage)];
+        const uint64_t v = ns > 0 ? static_cast<uint64_t>(ns) : 0;
+        bump(h.buckets[bucketOf(v)]);
+        if (v > h.max.load(std::memory_order_relaxed)) h.max.store(v, std::memory_order_relaxed);
+#else
+        (void)stage;
+        (void)ns;
+#endif
+    }
+
+    /** 某一级的快照；可在任意线程调用 */
+    Summary summary(Stage stage) const;
+
+    /** 清零；写线程停止时调用 */
+    void reset();
+
+    /** 值所在桶：< 4 直接对应，其余按最高位指数 e 与其后 2 位分桶 */
+    static int32_t bucketOf(uint64_t v);
+    /** 桶上界（含） */
+    static uint64_t bucketUpper(int32_t bucket);
+
+private:
+    struct Histogram {
+        std::atomic<uint64_t> buckets[kNumBuckets];
+        std::atomic<uint64_t> max;
+    };
+
+    static void bump(std::atomic<uint64_t>& v) {
+        v.store(v.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    Histogram histograms_[kNumStages]{};
+};
+
+/**
+ * @class StageTimer
+ * @brief 一帧的分级计时：构造时起表，[lap] 把上次打点以来的耗时计入某级，析构时按级记录并记录总耗时
+ *
+ * 同一级可多次 [lap]（如多分辨率的长、短窗 FFT），按帧累加后只记录一次；[skip] 丢弃两级之间不计入任何级的耗时。
+ * 未启用 PIANO_NOTE_STAGE_STATS 时全部为空操作。
+ */
+class StageTimer {
+public:
+    /** @param total 析构时记录总耗时的级 */
+    StageTimer(StageStats& stats, StageStats::Stage total)
+#if defined(PIANO_NOTE_STAGE_STATS)
+        : stats_(stats), total_(total), start_(StageStats::nowNs()), last_(start_) {
+    }
+#else
+    {
+        (void)stats;
+        (void)total;
+    }
+#endif
+
+    ~StageTimer() {
+#if defined(PIANO_NOTE_STAGE_STATS)
+        for (int32_t i = 0; i < StageStats::kNumStages; ++i) {
+            if (touched_ & (1u << i)) stats_.record(static_cast<StageStats::Stage>(i), elapsed_[i]);
+        }
+        stats_.record(total_, StageStats::nowNs() - start_);
+#endif
+    }
+
+    StageTimer(const StageTimer&) = delete;
+    StageTimer& operator=(const StageTimer&) = delete;
+
+    void lap(StageStats::Stage stage) {
+#if defined(PIANO_NOTE_STAGE_STATS)
+        const int64_t now = StageStats::nowNs();
+        const auto i = static_cast<int32_t>(stage);
+        elapsed_[i] += now - last_;
+        touched_ |= 1u << i;
+        last_ = now;
+#else
+        (void)stage;
+#endif
+    }
+
+    void skip() {
+#if defined(PIANO_NOTE_STAGE_STATS)
+        last_ = StageStats::nowNs();
+#endif
+    }
+
+private:
+#if defined(PIANO_NOTE_STAGE_STATS)
+    StageStats& stats_;
+    StageStats::Stage total_;
+    int64_t start_;
+    int64_t last_;
+    int64_t elapsed_[StageStats::kNumStages]{};
+    uint32_t touched_{0};
+#endif
+};
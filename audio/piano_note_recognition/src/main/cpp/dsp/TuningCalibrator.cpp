@@ -0,0 +1,96 @@
+#include "TuningCalibrator.h"
+
+#include <algorithm>
+#include <cmath>
+
+void TuningCalibrator::reset() {
+    for (auto& row : histogram_) std::fill_n(row, kNumBins, 0u);
+    std::fill_n(counts_, TuningTable::kNumKeys, 0u);
+}
+
+void TuningCalibrator::observe(int32_t midi, float cents, float confidence) {
+    if (midi < TuningTable::kFirstMidi || midi > TuningTable::kLastMidi) return;
+    if (!(confidence >= config_.minConfidence) || !std::isfinite(cents)) return;
+    const int32_t key = midi - TuningTable::kFirstMidi;
+    const auto bin = static_cast<int32_t>(std::lround(std::clamp(cents, -static_cast<float>(kMaxCents),
+                                                                 static_cast<float>(kMaxCents)))) + kMaxCents;
+    ++histogram_[key][bin];
+    ++counts_[key];
+}
+
+uint32_t TuningCalibrator::framesObserved(int32_t midi) const {
+    if (midi < TuningTable::kFirstMidi || midi > TuningTable::kLastMidi) return 0;
+    return counts_[midi - TuningTable::kFirstMidi];
+}
+
+int32_t TuningCalibrator::measuredKeys() const {
+    const auto minFrames = static_cast<uint32_t>(std::max(config_.minFrames, 1));
+    return static_cast<int32_t>(std::count_if(counts_, counts_ + TuningTable::kNumKeys,
+                                              [minFrames](uint32_t n) { return n >= minFrames; }));
+}
+
+float TuningCalibrator::medianCents(int32_t key) const {
+    // 累计到一半所在的桶，桶内按 [-0.5, 0.5) 线性插值
+    const double half = 0.5 * counts_[key];
+    double seen = 0.0;
+    for (int32_t b = 0; b < kNumBins; ++b) {
+        const double n = histogram_[key][b];
+        if (n > 0.0 && seen + n >= half) {
+            return static_cast<float>(b - kMaxCents - 0.5 + (half - seen) / n);
+        }
+        seen += n;
+    }
+    return 0.0f;
+}
+
+bool TuningCalibrator::build(const TuningTable& active, TuningTable& out) const {
+    const auto minFrames = static_cast<uint32_t>(std::max(config_.minFrames, 1));
+
+    // --- 1) 已测键相对当前参考音高十二平均律的总偏移 ---
+    float total[TuningTable::kNumKeys];
+    bool measured[TuningTable::kNumKeys];
+    int32_t numMeasured = 0;
+    for (int32_t k = 0; k < TuningTable::kNumKeys; ++k) {
+        measured[k] = counts_[k] >= minFrames;
+        total[k] = measured[k] ? active.offsetsCents()[k] + medianCents(k) : 0.0f;
+        numMeasured += measured[k] ? 1 : 0;
+    }
+    if (numMeasured == 0) return false;
+
+    // --- 2) 参考偏移：中音区已测键的中位数，没有则取全部已测键 ---
+    float reference[TuningTable::kNumKeys];
+    int32_t numReference = 0;
+    for (int32_t k = kReferenceLowMidi - TuningTable::kFirstMidi; k <= kReferenceHighMidi - TuningTable::kFirstMidi; ++k) {
+        if (measured[k]) reference[numReference++] = total[k];
+    }
+    if (numReference == 0) {
+        for (int32_t k = 0; k < TuningTable::kNumKeys; ++k) {
+            if (measured[k]) reference[numReference++] = total[k];
+        }
+    }
+    std::sort(reference, reference + numReference);
+    const float shift = numReference % 2 == 1
+                            ? reference[numReference / 2]
+                            : 0.5f * (reference[numReference / 2 - 1] + reference[numReference / 2]);
+
+    // --- 3) 逐键偏移：已测键直接取，未测键插值 / 沿用最近已测键 ---
+    float offsets[TuningTable::kNumKeys];
+    int32_t prev = -1;
+    for (int32_t k = 0; k < TuningTable::kNumKeys; ++k) {
+        if (!measured[k]) continue;
+        offsets[k] = total[k] - shift;
+        if (prev < 0) {
+            std::fill_n(offsets, k, offsets[k]);
+        } else {
+            for (int32_t j = prev + 1; j < k; ++j) {
+                const float t = static_cast<float>(j - prev) / static_cast<float>(k - prev);
+                offsets[j] = offsets[prev] + t * (offsets[k] - offsets[prev]);
+            }
+        }
+        prev = k;
+    }
+    std::fill(offsets + prev + 1, offsets + TuningTable::kNumKeys, offsets[prev]);
+
+    out.set(active.referenceHz() * std::exp2(shift / 1200.0f), offsets);
+    return true;
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+
+#include "TuningTable.h"
+
+/**
+ * @class TuningCalibrator
+ * @brief 校准：从一次校准演奏（逐键弹奏或任意曲目）的逐帧结果学出参考音高与逐键拉伸偏移，生成新的 [TuningTable]
+ *
+ * 采集（[observe]，检测线程逐帧调用）：可信度不低于 [Config::minConfidence] 的帧，按键把相对当前调律表的音分偏差
+ * 计入 1 音分分辨率的直方图（±[kMaxCents]），不分配、不加锁。
+ *
+ * 生成（[build]，采集结束后在控制线程调用）：
+ * - 每个至少有 [Config::minFrames] 帧的键取偏差中位数（桶内线性插值），与当前表的偏移相加得到该键相对十二平均律的总偏移；
+ * - 参考音高：A3..A5（MIDI 57..81）内已测键总偏移的中位数（该区间没有已测键时取全部已测键），换算为新的 A4；
+ * - 逐键偏移 = 总偏移 - 参考偏移；未测键在相邻已测键之间按键号线性插值，两端之外沿用最近的已测键。
+ *
+ * 偏差超过半个半音的键会被当前表归到相邻键，无法一次学出；此时以新表重复校准即可逐步收敛。
+ */
+class TuningCalibrator {
+public:
+    /** 直方图覆盖的偏差范围（音分）：拉伸后相邻键间距最大约 190 音分，键内偏差不超过其一半 */
+    static constexpr int32_t kMaxCents = 100;
+    static constexpr int32_t kNumBins = 2 * kMaxCents + 1;
+    /** 参考音高取自该区间内的已测键 */
+    static constexpr int32_t kReferenceLowMidi = 57;
+    static constexpr int32_t kReferenceHighMidi = 81;
+
+    struct Config {
+        float minConfidence = 0.6f; ///< 低于此可信度的帧不计入
+        int32_t minFrames = 8;      ///< 一个键至少多少帧才算已测
+    };
+
+    TuningCalibrator() = default;
+    explicit TuningCalibrator(const Config& config) : config_(config) {}
+
+    void setConfig(const Config& config) { config_ = config; }
+    const Config& config() const { return config_; }
+
+    /** 清空采集结果 */
+    void reset();
+
+    /**
+     * 计入一帧结果；无效键或低可信度帧忽略。
+     * @param cents 相对采集时所用调律表该键中心的偏差（[TuningTable::Lookup::cents]）
+     */
+    void observe(int32_t midi, float cents, float confidence);
+
+    /** 某键已计入的帧数 */
+    uint32_t framesObserved(int32_t midi) const;
+
+    /** 已测键数 */
+    int32_t measuredKeys() const;
+
+    /**
+     * 由采集结果生成新表。
+     * @param active 采集期间使用的调律表（偏差相对它计算）
+     * @return 没有任何已测键时返回 false，out 不变
+     */
+    bool build(const TuningTable& active, TuningTable& out) const;
+
+private:
+    /** 某键偏差直方图的中位数（音分） */
+    float medianCents(int32_t key) const;
+
+    Config config_;
+    uint32_t histogram_[TuningTable::kNumKeys][kNumBins] = {};
+    uint32_t counts_[TuningTable::kNumKeys] = {};
+};
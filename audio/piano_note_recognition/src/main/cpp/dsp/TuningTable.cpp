@@ -0,0 +1,65 @@
+#include "TuningTable.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+/** 1200 / ln 2：自然对数 -> 音分 */
+constexpr float kCentsPerNeper = 1731.2340491f;
+} // namespace
+
+TuningTable::TuningTable() {
+    rebuild();
+}
+
+void TuningTable::set(float referenceA4Hz, const float* offsetsCents) {
+    referenceHz_ = std::isfinite(referenceA4Hz) ? std::clamp(referenceA4Hz, kMinReferenceHz, kMaxReferenceHz) : 440.0f;
+    for (int32_t i = 0; i < kNumKeys; ++i) {
+        const float offset = offsetsCents != nullptr ? offsetsCents[i] : 0.0f;
+        offsetsCents_[i] = std::isfinite(offset) ? std::clamp(offset, -kMaxOffsetCents, kMaxOffsetCents) : 0.0f;
+    }
+    rebuild();
+}
+
+void TuningTable::rebuild() {
+    for (int32_t i = 0; i < kNumKeys; ++i) {
+        const double semitones = static_cast<double>(i + kFirstMidi - 69) + offsetsCents_[i] / 100.0;
+        centerHz_[i] = static_cast<float>(referenceHz_ * std::exp2(semitones / 12.0));
+    }
+    const double halfSemitone = std::exp2(1.0 / 24.0);
+    boundaryHz_[0] = static_cast<float>(centerHz_[0] / halfSemitone);
+    for (int32_t i = 1; i < kNumKeys; ++i) {
+        boundaryHz_[i] = static_cast<float>(std::sqrt(static_cast<double>(centerHz_[i - 1]) * centerHz_[i]));
+    }
+    boundaryHz_[kNumKeys] = static_cast<float>(centerHz_[kNumKeys - 1] * halfSemitone);
+}
+
+double TuningTable::frequencyAt(double midi) const {
+    // 偏移按相邻键线性插值（相邻键偏移差 < 100 音分，插值后仍单调），范围外取端点键
+    const double position = std::clamp(midi - kFirstMidi, 0.0, static_cast<double>(kNumKeys - 1));
+    const auto lower = std::min(static_cast<int32_t>(position), kNumKeys - 2);
+    const double t = position - lower;
+    const double offset = (1.0 - t) * offsetsCents_[lower] + t * offsetsCents_[lower + 1];
+    return referenceHz_ * std::exp2((midi - 69.0 + offset / 100.0) / 12.0);
+}
+
+float TuningTable::ratioToCents(float ratio) {
+    // ln r = 2 atanh(u)，u = (r - 1) / (r + 1)；r 在 1/2..2 内 |u| <= 1/3，取到 u^9 项
+    const float u = (ratio - 1.0f) / (ratio + 1.0f);
+    const float u2 = u * u;
+    const float series = u * (1.0f + u2 * (1.0f / 3.0f + u2 * (1.0f / 5.0f + u2 * (1.0f / 7.0f + u2 * (1.0f / 9.0f)))));
+    return 2.0f * kCentsPerNeper * series;
+}
+
+TuningTable::Lookup TuningTable::lookup(float frequencyHz) const {
+    if (!(frequencyHz >= boundaryHz_[0]) || frequencyHz >= boundaryHz_[kNumKeys]) return Lookup{-1, 0.0f};
+    // 第一个大于 f 的分界之前一个即为所在键
+    const float* upper = std::upper_bound(boundaryHz_, boundaryHz_ + kNumKeys + 1, frequencyHz);
+    const auto key = static_cast<int32_t>(upper - boundaryHz_) - 1;
+    return Lookup{key + kFirstMidi, ratioToCents(frequencyHz / centerHz_[key])};
+}
+
+float TuningTable::centsFrom(int32_t midi, float frequencyHz) const {
+    if (midi < kFirstMidi || midi > kLastMidi || frequencyHz <= 0.0f) return 0.0f;
+    return ratioToCents(frequencyHz / centerHz_[midi - kFirstMidi]);
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * @class TuningTable
+ * @brief 88 键调律表：按参考音高与逐键拉伸偏移（音分）预先算出各键中心频率与相邻键的分界频率，
+ *        基频 -> MIDI 为一次二分查找，同时给出相对该键中心的音分偏差
+ *
+ * - 中心频率：center[k] = referenceA4Hz · 2^((k - 69) / 12 + offset[k] / 1200)，默认 440 Hz 十二平均律（偏移全 0）。
+ * - 分界：相邻两键中心的几何平均（音分意义上的中点）；最低 / 最高键外侧各延伸半个半音。
+ *   对 442 Hz 或拉伸调律的琴，分界随实际音高移动，按 440 Hz 取整时落在半音边界附近的闪烁随之消失。
+ * - 查找：[lookup] 在 89 个分界上二分，音分用 ln 的 atanh 级数计算（频率比在 1/2..2 内误差 < 0.01 音分），不调用 log2。
+ * - 偏移限制在 ±[kMaxOffsetCents]，保证中心频率严格递增；参考音高限制在 [kMinReferenceHz, kMaxReferenceHz]。
+ * - 连续音高（[frequencyAt]）：分数 MIDI 的偏移在相邻键之间按音分线性插值、钢琴范围外沿用端点键的偏移，
+ *   整数 MIDI 恰为键中心；供常 Q bin 中心、多音模板等按调律表而非 440 Hz 十二平均律取样。
+ *
+ * 定长数组，可按值拷贝；[lookup] 不分配，可在 [RealtimeScope] 内使用。修改后须在检测线程之外替换（见 [PitchDetector::setTuning]）。
+ */
+class TuningTable {
+public:
+    static constexpr int32_t kFirstMidi = 21;
+    static constexpr int32_t kLastMidi = 108;
+    static constexpr int32_t kNumKeys = kLastMidi - kFirstMidi + 1;
+    static constexpr float kMaxOffsetCents = 45.0f;
+    static constexpr float kMinReferenceHz = 400.0f;
+    static constexpr float kMaxReferenceHz = 480.0f;
+
+    /** 查找结果；midiNote 为 -1 表示超出钢琴范围 */
+    struct Lookup {
+        int32_t midiNote;
+        float cents; ///< 相对该键中心频率的偏差，约 -50..50（拉伸时按相邻键间距略有出入）
+    };
+
+    /** 440 Hz 十二平均律 */
+    TuningTable();
+
+    /**
+     * 设置参考音高（A4，Hz）与逐键偏移；越界值被裁剪。
+     * @param offsetsCents 长度 [kNumKeys]，下标 0 为 A0（MIDI 21）；为空表示全 0（不拉伸）
+     */
+    void set(float referenceA4Hz, const float* offsetsCents);
+
+    float referenceHz() const { return referenceHz_; }
+    /** 键 midi（21..108）相对参考音高十二平均律的偏移（音分） */
+    float offsetCents(int32_t midi) const { return offsetsCents_[midi - kFirstMidi]; }
+    const float* offsetsCents() const { return offsetsCents_; }
+    /** 键 midi（21..108）的中心频率 Hz */
+    float centerHz(int32_t midi) const { return centerHz_[midi - kFirstMidi]; }
+
+    /** 分数 MIDI（可超出 21..108）-> Hz，单调递增；整数 MIDI 在钢琴范围内时等于 [centerHz] */
+    double frequencyAt(double midi) const;
+
+    /** 基频 -> 所在键与音分偏差；非正频率或超出钢琴范围返回 {-1, 0} */
+    Lookup lookup(float frequencyHz) const;
+
+    /** 相对键 midi（21..108）中心频率的音分偏差（键由调用方给定，如多音检测的琴键） */
+    float centsFrom(int32_t midi, float frequencyHz) const;
+
+    /** 频率比的音分值，ratio 须在 1 附近（约 1/2..2）；不调用 log2 */
+    static float ratioToCents(float ratio);
+
+private:
+    /** 由参考音高与偏移重算中心与分界 */
+    void rebuild();
+
+    float referenceHz_{440.0f};
+    float offsetsCents_[kNumKeys] = {};
+    float centerHz_[kNumKeys] = {};
+    /** boundaryHz_[i] 为第 i 键的下界、第 i - 1 键的上界，共 kNumKeys + 1 个，严格递增 */
+    float boundaryHz_[kNumKeys + 1] = {};
+};
@@ -1,44 +1,106 @@
 #include "YINWrapper.h"
 
+#include "DspKernels.h"
+
 #include <algorithm>
 #include <cfloat>
 #include <cmath>
-#include <vector>
 
 namespace {
 constexpr float kEps = 1e-12f;
 
+/** 钢琴 A0~C8：tau 与频率关系 f = sampleRate / tau */
+constexpr float kMinHz = 27.5f;
+constexpr float kMaxHz = 4186.0f;
+
 /** YIN 论文中的绝对阈值，越小越“挑剔”（漏检多）；越大越宽松（误检多） */
 constexpr float kDefaultThreshold = 0.15f;
+
+/** 线性自相关须零填充到 >= 2N，避免循环卷积回绕 */
+int32_t fftSizeFor(int32_t maxSamples) {
+    int32_t n = 4;
+    while (n < 2 * maxSamples) n <<= 1;
+    return n;
+}
+}
+
+YINWrapper::YINWrapper(int32_t maxSamples, float maxSampleRate)
+    : maxSamples_(maxSamples), fft_(fftSizeFor(maxSamples)) {
+    const int32_t maxTau = std::min<int32_t>(static_cast<int32_t>(std::floor(maxSampleRate / kMinHz)),
+                                             maxSamples_ - 1);
+    tauCapacity_ = std::max<int32_t>(maxTau, 2) + 1;
+    diff_.assign(tauCapacity_, 0.0f);
+    cmnd_.assign(tauCapacity_, 0.0f);
+    padded_.assign(fft_.size(), 0.0f);
+    acf_.assign(fft_.size(), 0.0f);
+    specRe_.assign(fft_.numBins(), 0.0f);
+    specIm_.assign(fft_.numBins(), 0.0f);
+    energy_.assign(maxSamples_ + 1, 0.0);
+}
+
+void YINWrapper::differenceDirect(const float* time, int32_t numSamples,
+                                  int32_t tauMin, int32_t tauMax, float* diff) {
+    for (int32_t tau = tauMin; tau <= tauMax; ++tau) {
+        double sum = 0.0;
+        for (int32_t i = 0; i < numSamples - tau; ++i) {
+            const float delta = time[i] - time[i + tau];
+            sum += static_cast<double>(delta) * static_cast<double>(delta);
+        }
+        diff[tau] = static_cast<float>(sum);
+    }
 }
 
-YINWrapper::YINWrapper() = default;
+void YINWrapper::differenceFft(const float* time, int32_t numSamples,
+                               int32_t tauMin, int32_t tauMax, float* diff) {
+    // --- 能量前缀和：E(a, b) = energy_[b] - energy_[a] ---
+    energy_[0] = 0.0;
+    for (int32_t i = 0; i < numSamples; ++i) {
+        energy_[i + 1] = energy_[i] + static_cast<double>(time[i]) * static_cast<double>(time[i]);
+    }
+
+    // --- 自相关 r(tau) = sum_{i<N-tau} x[i] x[i+tau] = IFFT(|X|^2)[tau] / fftSize ---
+    const int32_t fftSize = fft_.size();
+    std::copy(time, time + numSamples, padded_.begin());
+    std::fill(padded_.begin() + numSamples, padded_.end(), 0.0f);
+    fft_.forward(padded_.data(), specRe_.data(), specIm_.data());
+    for (int32_t k = 0; k < fft_.numBins(); ++k) {
+        specRe_[k] = specRe_[k] * specRe_[k] + specIm_[k] * specIm_[k];
+        specIm_[k] = 0.0f;
+    }
+    fft_.inverse(specRe_.data(), specIm_.data(), acf_.data());
+
+    // --- d(tau) = E(0, N-tau) + E(tau, N) - 2 r(tau)；舍入可能得到极小负值，截到 0 ---
+    const double invSize = 1.0 / static_cast<double>(fftSize);
+    const double total = energy_[numSamples];
+    for (int32_t tau = tauMin; tau <= tauMax; ++tau) {
+        const double e = energy_[numSamples - tau] + (total - energy_[tau]);
+        const double d = e - 2.0 * static_cast<double>(acf_[tau]) * invSize;
+        diff[tau] = static_cast<float>(std::max(d, 0.0));
+    }
+}
 
 YINWrapper::Result YINWrapper::detect(const float* time, int32_t numSamples, float sampleRate) {
     if (time == nullptr || numSamples <= 0 || sampleRate <= 0.0f) {
         return Result{-1.0f, 0.0f};
     }
 
-    // 延迟 tau 与频率关系：f = sampleRate / tau；限制在钢琴 A0~C8
-    const float minHz = 27.5f;
-    const float maxHz = 4186.0f;
+    // 延迟 tau 与频率关系：f = sampleRate / tau；限制在钢琴 A0~C8，且不超过预分配缓冲
+    const float minHz = kMinHz;
+    const float maxHz = kMaxHz;
     int32_t tauMin = static_cast<int32_t>(std::floor(sampleRate / maxHz));
     int32_t tauMax = static_cast<int32_t>(std::min<double>(std::floor(sampleRate / minHz), numSamples - 1));
+    tauMax = std::min<int32_t>(tauMax, tauCapacity_ - 1);
     if (tauMin < 2) tauMin = 2;
     if (tauMax <= tauMin) return Result{-1.0f, 0.0f};
 
-    const int32_t size = tauMax + 1;
-    std::vector<float> diff(size, 0.0f);
-    std::vector<float> cmnd(size, 0.0f);
+    float* diff = diff_.data();
+    float* cmnd = cmnd_.data();
 
     // --- 1) 差分函数 d(tau) = sum_i (x[i]-x[i+tau])^2 ---
-    for (int32_t tau = tauMin; tau <= tauMax; ++tau) {
-        double sum = 0.0;
-        for (int32_t i = 0; i < numSamples - tau; ++i) {
-            const float delta = time[i] - time[i + tau];
-            sum += static_cast<double>(delta) * static_cast<double>(delta);
-        }
-        diff[tau] = static_cast<float>(sum);
+    if (method_ == DifferenceMethod::Fft && numSamples <= maxSamples_) {
+        differenceFft(time, numSamples, tauMin, tauMax, diff);
+    } else {
+        differenceDirect(time, numSamples, tauMin, tauMax, diff);
     }
 
     // --- 2) 累积均值归一化差分 d'(tau) ---
@@ -101,3 +163,71 @@ YINWrapper::Result YINWrapper::detect(const float* time, int32_t numSamples, flo
     }
     return Result{pitchHz, confidence};
 }
+
+bool YINWrapper::prepareNarrow(const float* time, int32_t numSamples) {
+    narrowTime_ = nullptr;
+    narrowSamples_ = 0;
+    if (time == nullptr || numSamples <= 0 || numSamples > maxSamples_) return false;
+    narrowTime_ = time;
+    narrowSamples_ = numSamples;
+    narrowEnergy_ = dspKernels().dot(time, time, numSamples);
+    return true;
+}
+
+YINWrapper::Result YINWrapper::detectNear(float sampleRate, float expectedHz, float tolerance) {
+    const float* time = narrowTime_;
+    const int32_t numSamples = narrowSamples_;
+    if (time == nullptr || sampleRate <= 0.0f || expectedHz <= 0.0f) {
+        return Result{-1.0f, 0.0f};
+    }
+
+    // 邻域 [tauLo, tauHi]，两侧各多算一个 tau 供抛物线插值
+    const float tau0 = sampleRate / expectedHz;
+    const int32_t tauLimit = std::min<int32_t>(numSamples - 1, tauCapacity_ - 1);
+    const int32_t tauLo = std::max<int32_t>(2, static_cast<int32_t>(std::floor(tau0 * (1.0f - tolerance))));
+    const int32_t tauHi = std::min<int32_t>(tauLimit - 1, static_cast<int32_t>(std::ceil(tau0 * (1.0f + tolerance))));
+    if (tauHi < tauLo) return Result{-1.0f, 0.0f};
+
+    // --- 1) 逐 tau 点积：d(tau) = E(0, N-tau) + E(tau, N) - 2 r(tau)，按能量项归一化 ---
+    //    能量项只在邻域内需要：首尾各 tau 个样本的能量由一次点积起算，之后逐 tau 递推（不做整窗前缀和）
+    const DspKernels& kernels = dspKernels();
+    const double total = narrowEnergy_;
+    const int32_t first = tauLo - 1;
+    double head = kernels.dot(time, time, first);                                            // E(0, tau)
+    double tail = kernels.dot(time + numSamples - first, time + numSamples - first, first);  // E(N-tau, N)
+    float* norm = cmnd_.data();
+    for (int32_t tau = first; tau <= tauHi + 1; ++tau) {
+        const double e = (total - tail) + (total - head);
+        const double r = kernels.dot(time, time + tau, numSamples - tau);
+        norm[tau] = e > 0.0 ? static_cast<float>(std::max(e - 2.0 * r, 0.0) / e) : 1.0f;
+        head += static_cast<double>(time[tau]) * time[tau];
+        tail += static_cast<double>(time[numSamples - 1 - tau]) * time[numSamples - 1 - tau];
+    }
+
+    // --- 2) 邻域内最小值；落在边缘说明真正的谷在邻域外 ---
+    int32_t tauEstimate = tauLo;
+    for (int32_t tau = tauLo + 1; tau <= tauHi; ++tau) {
+        if (norm[tau] < norm[tauEstimate]) tauEstimate = tau;
+    }
+    if ((tauEstimate == tauLo && norm[tauLo - 1] < norm[tauLo]) ||
+        (tauEstimate == tauHi && norm[tauHi + 1] < norm[tauHi])) {
+        return Result{-1.0f, 0.0f};
+    }
+
+    // --- 3) 抛物线插值细化 tau（同 [detect]） ---
+    float betterTau = static_cast<float>(tauEstimate);
+    const float s0 = norm[tauEstimate - 1];
+    const float s1 = norm[tauEstimate];
+    const float s2 = norm[tauEstimate + 1];
+    const float denom = (2.0f * s1 - s0 - s2);
+    if (std::fabs(denom) > kEps) {
+        betterTau = betterTau + (s2 - s0) / (2.0f * denom);
+    }
+
+    const float pitchHz = sampleRate / (betterTau + kEps);
+    const float confidence = 1.0f - std::clamp(s1, 0.0f, 1.0f);
+    if (pitchHz < kMinHz || pitchHz > kMaxHz) {
+        return Result{-1.0f, 0.0f};
+    }
+    return Result{pitchHz, confidence};
+}
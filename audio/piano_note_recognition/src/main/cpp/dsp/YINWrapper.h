@@ -1,12 +1,25 @@
 #pragma once
 
 #include <cstdint>
+#include <vector>
+
+#include "RealFFT.h"
 
 /**
  * @class YINWrapper
  * @brief 时域 YIN 类基频检测（计划由 Aubio 替代；当前为可编译回退实现）
  *
  * 输出 pitchHz 与 confidence；与 [PitchDetector] 中阈值 0.85 配合决定融合优先级。
+ *
+ * 差分函数 d(tau) 两种算法（[DifferenceMethod]）：
+ * - Direct：逐 tau 逐样本累加，O(N * tauMax)，作为参考实现保留。
+ * - Fft（默认）：d(tau) = E(0, N-tau) + E(tau, N) - 2 r(tau)，其中能量项由前缀和 O(1) 取得，
+ *   自相关 r(tau) 由零填充到 2N 的 [RealFFT] 做 |X|^2 再逆变换得到，整体 O(N log N)。
+ *   与 Direct 的误差来自 float FFT 舍入，量级为 1e-6 * (E(0, N-tau) + E(tau, N))；
+ *   主机实测 88 键合成音（6 次谐波 + 噪声）基频相对差 < 2e-6，confidence 差 < 1e-6。
+ *
+ * 内存：全部暂存缓冲（d(tau)、CMND、FFT 缓冲、能量前缀和）在构造时按 maxSamples 与 maxSampleRate
+ * 一次分配，[detect] 在音频回调线程上不做任何堆分配。
  */
 class YINWrapper {
 public:
@@ -15,12 +28,72 @@ public:
         float confidence; ///< 0..1，由 CMND 谷值启发映射
     };
 
-    YINWrapper();
+    enum class DifferenceMethod {
+        Direct,
+        Fft,
+    };
 
     /**
-     * @param time 时域缓冲（本工程为 2048）
+     * @param maxSamples Fft 算法支持的最大窗口长度，决定内部 FFT 点数（>= 2 * maxSamples 的 2 的幂）
+     * @param maxSampleRate 支持的最高采样率；与 maxSamples 一起决定 tau 上限，
+     *        即 d(tau)/CMND 缓冲长度 min(maxSampleRate / 27.5, maxSamples - 1) + 1
+     */
+    explicit YINWrapper(int32_t maxSamples = 2048, float maxSampleRate = 48000.0f);
+
+    void setDifferenceMethod(DifferenceMethod method) { method_ = method; }
+    DifferenceMethod differenceMethod() const { return method_; }
+
+    /**
+     * @param time 时域缓冲（本工程为 2048）；超过 maxSamples 时自动退回 Direct
      * @param numSamples 样本数
-     * @param sampleRate Hz
+     * @param sampleRate Hz；超过 maxSampleRate 时 tau 上限被截到缓冲长度，可检测的最低频率相应升高
      */
     Result detect(const float* time, int32_t numSamples, float sampleRate);
+
+    /**
+     * 为随后的 [detectNear] 设定输入窗口并算好总能量；同一窗口的多次窄带查询只算一次。
+     * time 须在这些查询结束前保持有效。
+     * @return numSamples 超过 maxSamples 时返回 false（须改用 [detect]）
+     */
+    bool prepareNarrow(const float* time, int32_t numSamples);
+
+    /**
+     * 窄带 YIN：在 [prepareNarrow] 设定的窗口上，只在 tau = sampleRate / expectedHz 的 ±tolerance 邻域内求差分，
+     * 用于确认 / 细化已有候选。d(tau) 由邻域内递推的能量项与逐 tau 点积（[DspKernels::dot]）直接算出，
+     * 开销与邻域宽度成正比，不做整窗 FFT 自相关；累积均值归一化在邻域外不可得，改用能量归一化
+     * d(tau) / (E(0, N-tau) + E(tau, N))，在周期附近与 CMND 近似相等（均值中的自相关项在一个周期上平均为 0）。
+     * 谷落在邻域边缘（真正的谷在邻域外）时返回无效。
+     * @param tolerance 相对宽度，如 0.03 即 ±3%
+     * @return confidence 含义同 [detect]（1 - 谷值）
+     */
+    Result detectNear(float sampleRate, float expectedHz, float tolerance);
+
+private:
+    /** d(tau)，tau in [tauMin, tauMax]，逐样本直接累加 */
+    static void differenceDirect(const float* time, int32_t numSamples,
+                                 int32_t tauMin, int32_t tauMax, float* diff);
+    /** d(tau)，tau in [tauMin, tauMax]，前缀和能量 + FFT 自相关 */
+    void differenceFft(const float* time, int32_t numSamples,
+                       int32_t tauMin, int32_t tauMax, float* diff);
+
+    DifferenceMethod method_{DifferenceMethod::Fft};
+    int32_t maxSamples_;
+
+    RealFFT fft_;
+    /** 零填充输入 / 自相关输出，长度 fft_.size() */
+    std::vector<float> padded_;
+    std::vector<float> acf_;
+    /** 频谱，长度 fft_.numBins() */
+    std::vector<float> specRe_;
+    std::vector<float> specIm_;
+    /** d(tau) 与 CMND，长度 [tauCapacity_]，下标即 tau */
+    int32_t tauCapacity_;
+    std::vector<float> diff_;
+    std::vector<float> cmnd_;
+    /** 能量前缀和 energy_[m] = sum_{i<m} x[i]^2，长度 maxSamples + 1 */
+    std::vector<double> energy_;
+    /** [prepareNarrow] 设定的窗口及其总能量 */
+    const float* narrowTime_{nullptr};
+    int32_t narrowSamples_{0};
+    double narrowEnergy_{0.0};
 };
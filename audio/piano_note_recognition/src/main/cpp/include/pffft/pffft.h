@@ -6,22 +6,38 @@
  *
  * 接入步骤（概要）：
  * - 将 libpffft.a 放到 cpp/lib/${ANDROID_ABI}/
- * - 在 [FFTWrapper] 中用 pffft_new_setup / pffft_transform_ordered 等替换当前 Radix-2 回退实现
- * - CMake 在检测到 libpffft.a 存在时会自动链接 imported target `pffft`
+ * - CMake 在检测到 libpffft.a 存在时会自动链接 imported target `pffft`，并定义 PIANO_NOTE_USE_PFFFT
+ * - [RealFFT] 在该宏开启时改用 pffft_new_setup / pffft_transform_ordered 做实数变换
+ *
+ * 以下声明与官方 pffft.h 的公开 API 保持一致，便于直接替换。
  */
 
+#include <stddef.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-typedef struct pffft_plan_t pffft_plan;
+typedef struct PFFFT_Setup PFFFT_Setup;
+
+typedef enum { PFFFT_FORWARD, PFFFT_BACKWARD } pffft_direction_t;
+typedef enum { PFFFT_REAL, PFFFT_COMPLEX } pffft_transform_t;
+
+/** 创建 N 点变换计划；实数变换要求 N 为 32 的倍数，不支持时返回 NULL */
+PFFFT_Setup* pffft_new_setup(int N, pffft_transform_t transform);
+void pffft_destroy_setup(PFFFT_Setup* setup);
+
+/**
+ * 有序输出的变换。实数正变换输出布局：
+ * out[0] = X[0].re, out[1] = X[N/2].re, out[2k], out[2k+1] = X[k].re, X[k].im（k = 1..N/2-1）。
+ * 逆变换不归一化（结果为 N * x）。work 为 N 个 float 的对齐缓冲。
+ */
+void pffft_transform_ordered(PFFFT_Setup* setup, const float* input, float* output,
+                             float* work, pffft_direction_t direction);
 
-/** 创建 n 点 FFT 计划（flags 依 PFFFT 文档） */
-pffft_plan* pffft_new_setup(int n, int flags);
-void pffft_destroy_setup(pffft_plan* plan);
-/** direction 等参数以实际 PFFFT API 为准，此处仅为占位签名 */
-void pffft_transform_ordered(pffft_plan* plan, const float* in, float* out,
-                            float* tmp, int direction);
+/** SIMD 对齐分配，输入/输出/work 缓冲须由此分配 */
+void* pffft_aligned_malloc(size_t nb_bytes);
+void pffft_aligned_free(void* p);
 
 #ifdef __cplusplus
 }
@@ -3,143 +3,388 @@
  * @brief JNI 桥接层：Kotlin [PianoNoteRecognizer] <-> C++ [AudioEngine]
  *
  * 关键设计：
- * - 全局互斥 [gMutex]：nativeStart/nativeStop 与资源释放串行化，避免与音频线程竞态导致 UAF。
- * - Java 全局引用 [gJavaObjGlobal]：音频回调线程需要调用 Kotlin 实例方法，不能用局部 jobject。
- * - 重复 nativeStart：若 [gRunning] 已为 true，先 [stopLocked] 释放旧 Oboe/引擎/GlobalRef（应对 JVM 异常后重入）。
- * - [getJNIEnv]：音频线程可能未 Attach，使用 AttachCurrentThread（注意后续可考虑 Detach 策略）。
+ * - 句柄：每个 Kotlin 实例在构造时 nativeCreate 得到一个 [NativeRecognizer]（jlong 即其指针），
+ *   之后的 nativeStart/nativeStop/查询都带上该句柄；实例之间不共享流、引擎、回调与事件存储，
+ *   同一进程内可同时运行多路（多麦克风 / 多乐器）。nativeDestroy 先停止再释放，之后句柄失效。
+ * - 实例互斥 [NativeRecognizer::mutex]：同一实例的 start/stop 与资源释放串行化，避免与音频线程竞态导致 UAF。
+ * - Java 全局引用 [NativeRecognizer::javaObj]：音频回调线程需要调用 Kotlin 实例方法，不能用局部 jobject。
+ * - 重复 nativeStart：若实例已在运行，先 [stopLocked] 释放旧 Oboe/引擎/GlobalRef（应对 JVM 异常后重入）；
+ *   启动中途失败同样 [stopLocked]，返回 false 时不持有 GlobalRef。
+ * - [getJNIEnv]：回调线程（Oboe 音频线程、分析线程池）首次回调时 AttachCurrentThreadAsDaemon 一次，JNIEnv 缓存在
+ *   thread_local 中，之后每次回调不再 GetEnv；线程退出时由 [gDetachKey] 的 pthread_key 析构函数 Detach
+ *   （Oboe 断连后重建回调线程也不会留下已附加的旧线程）。daemon 线程不阻止 JVM 退出。
+ * - 方法 ID：[JNI_OnLoad] 时对 PianoNoteRecognizer 类解析一次（[gOnNoteDetected] / [gOnNoteEvents]），各实例共用。
+ * - Pipelined 模式：所有实例的分析工作挂到进程内共享的定长 [AnalysisPool]（[sharedPool]），
+ *   线程数不随实例数增长；Inline 模式仍在各自的 Oboe 回调线程内检测。
+ * - 批量事件：[NativeRecognizer::eventStorage] 随实例分配，启动时包成 direct ByteBuffer（eventBuffer），
+ *   每批 memcpy 后一次 onNoteEvents(ByteBuffer, count)，Kotlin 在回调内同步读完。
+ * - 调律：[NativeRecognizer::tuning] 与校准器随实例保存，nativeStart 时交给新建的引擎；校准在引擎运行期间采集，
+ *   nativeFinishCalibration 须在停止后调用（采集只由检测线程写，停止后才可读）。
+ * - 离线分析：nativeAnalyzePcm / nativeAnalyzeFile 与实时流无关，不需要句柄，在调用线程阻塞直到完成，
+ *   全部事件以与批量回调相同的 32 字节布局拼成一个 byte[] 返回。
  */
 
 #include <jni.h>
+#include <pthread.h>
 
 #include <mutex>
+#include <algorithm>
 #include <atomic>
+#include <cstdint>
+#include <cstring>
 #include <new>
+#include <vector>
 
+#include "audio/AnalysisPool.h"
 #include "audio/AudioEngine.h"
+#include "audio/OboeInputSource.h"
+#include "audio/OfflineAnalyzer.h"
+#include "dsp/TuningCalibrator.h"
+#include "dsp/TuningTable.h"
 
 namespace {
-/** 保护 JNI 全局状态与 Engine 生命周期的互斥锁 */
-std::mutex gMutex;
-/** 与 Kotlin isRunning 语义对齐：native 侧是否已成功启动流 */
-std::atomic<bool> gRunning{false};
-
 JavaVM* gVm = nullptr;
-/** Kotlin PianoNoteRecognizer 实例的全局引用，供音频线程回调 */
-jobject gJavaObjGlobal = nullptr;
+
+/** Kotlin 回调的方法 ID：[JNI_OnLoad] 解析，类不卸载即一直有效 */
 jmethodID gOnNoteDetected = nullptr;
+jmethodID gOnNoteEvents = nullptr;
+
+/** 由本文件 Attach 的线程以该 key 登记，线程退出时析构函数 Detach */
+pthread_key_t gDetachKey;
+bool gDetachKeyCreated = false;
+/** 当前线程缓存的 JNIEnv：只缓存本文件 Attach 的线程（其附加状态由本文件管理） */
+thread_local JNIEnv* tEnv = nullptr;
+
+/** 一个 Kotlin [PianoNoteRecognizer] 实例的 native 状态；nativeCreate 返回其指针作为句柄 */
+struct NativeRecognizer {
+    /** 保护本实例 JNI 引用与 Engine 生命周期的互斥锁 */
+    std::mutex mutex;
+    /** 与 Kotlin isRunning 语义对齐：本实例是否已成功启动流 */
+    std::atomic<bool> running{false};
+
+    /** Kotlin 实例的全局引用，供音频线程回调 */
+    jobject javaObj = nullptr;
+
+    /** 批量事件存储与其 direct ByteBuffer 全局引用；仅在批量模式下创建 */
+    NoteEvent eventStorage[NoteEventBatcher::kMaxBatchEvents];
+    jobject eventBuffer = nullptr;
+
+    AudioEngine* engine = nullptr;
+    /** Oboe 输入流；引擎每次启动时打开、stop 时关闭，随实例复用 */
+    OboeInputSource input;
+
+    /** 调律表，每次启动时交给引擎 */
+    TuningTable tuning;
+    /** 校准采集；calibrating 时每次启动前清空并挂到引擎上 */
+    TuningCalibrator calibrator;
+    bool calibrating = false;
+};
+
+NativeRecognizer* fromHandle(jlong handle) {
+    return reinterpret_cast<NativeRecognizer*>(static_cast<intptr_t>(handle));
+}
+
+/**
+ * 所有实例共享的分析线程池：首次以 Pipelined 模式启动时创建，线程数固定（硬件并发数 - 1）。
+ * 进程内常驻、不析构：避免静态析构时 join 仍附加在 JVM 上的线程。
+ */
+AnalysisPool& sharedPool() {
+    static AnalysisPool* pool = new AnalysisPool();
+    return *pool;
+}
+
+/** 与 Kotlin ProcessingMode.nativeValue 对应 */
+constexpr jint kModeInline = 0;
+constexpr jint kModePipelinedDropOldest = 1;
+constexpr jint kModePipelinedCoalesce = 2;
 
-AudioEngine* gEngine = nullptr;
+/** pthread_key 析构：线程退出时 Detach（value 非空才会被调用） */
+void detachThread(void* /*env*/) {
+    if (gVm != nullptr) {
+        gVm->DetachCurrentThread();
+    }
+}
 
 /**
  * 获取当前线程可用的 JNIEnv。
- * - 已附加：直接返回
- * - 未附加（常见于 Oboe 回调线程）：AttachCurrentThread
+ * - 已缓存：直接返回（回调热路径只有一次 thread_local 读）
+ * - 已由他人附加（如 stop 时交付剩余事件的 JNI 调用线程）：直接返回，不缓存（附加状态不归本文件管理），不负责 Detach
+ * - 未附加（Oboe 回调线程、分析线程池）：AttachCurrentThreadAsDaemon 一次并登记 [gDetachKey]
  */
 JNIEnv* getJNIEnv() {
+    if (tEnv != nullptr) return tEnv;
     if (gVm == nullptr) return nullptr;
     JNIEnv* env = nullptr;
     const jint res = gVm->GetEnv(reinterpret_cast<void**>(&env), JNI_VERSION_1_6);
     if (res == JNI_OK) return env;
-    if (res == JNI_EDETACHED) {
-        if (gVm->AttachCurrentThread(&env, nullptr) == JNI_OK) {
-            return env;
-        }
-    }
-    return nullptr;
+    if (res != JNI_EDETACHED || !gDetachKeyCreated) return nullptr;
+
+    JavaVMAttachArgs args{JNI_VERSION_1_6, "piano_note_native", nullptr};
+    if (gVm->AttachCurrentThreadAsDaemon(&env, &args) != JNI_OK) return nullptr;
+    pthread_setspecific(gDetachKey, env);
+    tEnv = env;
+    return env;
 }
 
 /** 释放全局引用，避免泄漏 */
-void clearJavaRef(JNIEnv* env) {
-    if (gJavaObjGlobal != nullptr) {
-        env->DeleteGlobalRef(gJavaObjGlobal);
-        gJavaObjGlobal = nullptr;
+void clearJavaRef(JNIEnv* env, NativeRecognizer& r) {
+    if (r.javaObj != nullptr) {
+        env->DeleteGlobalRef(r.javaObj);
+        r.javaObj = nullptr;
+    }
+    if (r.eventBuffer != nullptr) {
+        env->DeleteGlobalRef(r.eventBuffer);
+        r.eventBuffer = nullptr;
     }
 }
 
 /**
- * 在已持有 [gMutex] 的前提下：停止引擎、释放 C++ 对象、清理 JNI 引用。
+ * 在已持有 [NativeRecognizer::mutex] 的前提下：停止引擎、释放 C++ 对象、清理 JNI 引用。
  */
-void stopLocked(JNIEnv* env) {
-    if (gEngine != nullptr) {
-        gEngine->stop();
-        delete gEngine;
-        gEngine = nullptr;
+void stopLocked(JNIEnv* env, NativeRecognizer& r) {
+    if (r.engine != nullptr) {
+        r.engine->stop();
+        delete r.engine;
+        r.engine = nullptr;
     }
-    clearJavaRef(env);
-    gOnNoteDetected = nullptr;
-    gRunning.store(false);
+    clearJavaRef(env, r);
+    r.running.store(false);
 }
 
 /**
  * 从音频线程把一帧识别结果回调到 Kotlin。
  * 关键：CallVoidMethod 可能抛 Java 异常，在 native 侧 Clear，避免异常挂起影响后续回调。
  */
-void callbackToJava(const AudioEngine::NoteResult& res) {
-    if (!gRunning.load()) return;
-    if (gJavaObjGlobal == nullptr || gOnNoteDetected == nullptr) return;
+void callbackToJava(void* user, const AudioEngine::NoteResult& res) {
+    NativeRecognizer& r = *static_cast<NativeRecognizer*>(user);
+    if (!r.running.load()) return;
+    if (r.javaObj == nullptr) return;
     JNIEnv* env = getJNIEnv();
     if (env == nullptr) return;
 
-    env->CallVoidMethod(gJavaObjGlobal, gOnNoteDetected,
+    env->CallVoidMethod(r.javaObj, gOnNoteDetected,
                          static_cast<jint>(res.midiNote),
                          static_cast<jfloat>(res.volume),
                          static_cast<jfloat>(res.confidence),
-                         static_cast<jfloat>(res.frequencyHz));
+                         static_cast<jfloat>(res.frequencyHz),
+                         static_cast<jfloat>(res.cents));
     if (env->ExceptionCheck()) {
         env->ExceptionClear();
     }
 }
+
+/**
+ * 把一批事件拷入本实例的 ByteBuffer 并回调 Kotlin；由检测线程（或 stop 时的 JNI 线程）调用。
+ * Kotlin 须在 onNoteEvents 返回前读完，下一批会覆盖同一存储。
+ */
+void eventsToJava(void* user, const NoteEvent* events, int32_t count) {
+    NativeRecognizer& r = *static_cast<NativeRecognizer*>(user);
+    if (!r.running.load()) return;
+    if (r.javaObj == nullptr || r.eventBuffer == nullptr) return;
+    JNIEnv* env = getJNIEnv();
+    if (env == nullptr) return;
+
+    const int32_t n = std::min<int32_t>(count, NoteEventBatcher::kMaxBatchEvents);
+    std::memcpy(r.eventStorage, events, static_cast<size_t>(n) * sizeof(NoteEvent));
+    env->CallVoidMethod(r.javaObj, gOnNoteEvents, r.eventBuffer, static_cast<jint>(n));
+    if (env->ExceptionCheck()) {
+        env->ExceptionClear();
+    }
+}
+
+/** 离线分析参数：与实时路径的同名开关含义一致 */
+OfflineAnalyzer::Config offlineConfig(jboolean polyphonic, jint maxNotes, jboolean multiResolution,
+                                      jboolean onsetGating, jboolean noiseWhitening,
+                                      jint smoothingHops, jint minNoteMs, jint hopSize, jint numThreads) {
+    OfflineAnalyzer::Config config;
+    config.polyphonic = polyphonic;
+    config.maxNotes = maxNotes;
+    config.multiResolution = multiResolution;
+    config.onsetGating = onsetGating;
+    config.noiseWhitening = noiseWhitening;
+    config.tracking.smoothingHops = smoothingHops;
+    config.tracking.minNoteMs = minNoteMs;
+    if (hopSize > 0) config.hopSize = hopSize;
+    config.numThreads = numThreads;
+    return config;
+}
+
+/** 调律表 -> float[]：参考音高（Hz）之后为 88 键偏移（音分）；分配失败返回 null */
+jfloatArray tuningToArray(JNIEnv* env, const TuningTable& tuning) {
+    jfloatArray out = env->NewFloatArray(1 + TuningTable::kNumKeys);
+    if (out == nullptr) return nullptr;
+    const jfloat reference = tuning.referenceHz();
+    env->SetFloatArrayRegion(out, 0, 1, &reference);
+    env->SetFloatArrayRegion(out, 1, TuningTable::kNumKeys, tuning.offsetsCents());
+    return out;
+}
+
+/** float[]（布局同 [tuningToArray]）-> 调律表；null 为 440 Hz 十二平均律，长度不符返回 false */
+bool tuningFromArray(JNIEnv* env, jfloatArray values, TuningTable& out) {
+    out = TuningTable();
+    if (values == nullptr) return true;
+    if (env->GetArrayLength(values) != 1 + TuningTable::kNumKeys) return false;
+    float buffer[1 + TuningTable::kNumKeys];
+    env->GetFloatArrayRegion(values, 0, 1 + TuningTable::kNumKeys, buffer);
+    out.set(buffer[0], buffer + 1);
+    return true;
+}
+
+/** 事件数组 -> byte[]（每条 sizeof(NoteEvent) 字节，本机字节序）；分配失败返回 null */
+jbyteArray eventsToByteArray(JNIEnv* env, const std::vector<NoteEvent>& events) {
+    const jsize bytes = static_cast<jsize>(events.size() * sizeof(NoteEvent));
+    jbyteArray out = env->NewByteArray(bytes);
+    if (out == nullptr) return nullptr;
+    env->SetByteArrayRegion(out, 0, bytes, reinterpret_cast<const jbyte*>(events.data()));
+    return out;
+}
 } // namespace
 
 /**
- * JNI：启动识别。
- * 流程：缓存 JavaVM -> 若已在运行则先释放 -> NewGlobalRef(thiz) -> GetMethodID -> new AudioEngine -> start
+ * 库加载：缓存 JavaVM、创建线程 Detach 用的 pthread_key、解析 Kotlin 回调的方法 ID。
+ * 由 PianoNoteRecognizer 伴生对象中的 System.loadLibrary 触发，此时可用应用的类加载器 FindClass。
  */
-extern "C" JNIEXPORT jboolean JNICALL
-Java_com_soul_piano_1note_1recognition_PianoNoteRecognizer_nativeStart(JNIEnv* env, jobject thiz) {
-    std::lock_guard<std::mutex> lock(gMutex);
+extern "C" JNIEXPORT jint JNICALL JNI_OnLoad(JavaVM* vm, void* /*reserved*/) {
+    gVm = vm;
+    JNIEnv* env = nullptr;
+    if (vm->GetEnv(reinterpret_cast<void**>(&env), JNI_VERSION_1_6) != JNI_OK) return JNI_ERR;
 
-    if (gVm == nullptr) {
-        env->GetJavaVM(&gVm);
+    gDetachKeyCreated = pthread_key_create(&gDetachKey, &detachThread) == 0;
+
+    jclass cls = env->FindClass("com/soul/piano_note_recognition/PianoNoteRecognizer");
+    if (cls != nullptr) {
+        // Kotlin: fun onNoteDetected(midiNote: Int, volume: Float, confidence: Float, frequency: Float, cents: Float)
+        gOnNoteDetected = env->GetMethodID(cls, "onNoteDetected", "(IFFFF)V");
+        // Kotlin: fun onNoteEvents(buffer: ByteBuffer, count: Int)
+        gOnNoteEvents = env->GetMethodID(cls, "onNoteEvents", "(Ljava/nio/ByteBuffer;I)V");
+        env->DeleteLocalRef(cls);
     }
+    // 解析失败只让 nativeStart 返回 false，不影响离线分析
+    if (env->ExceptionCheck()) {
+        env->ExceptionClear();
+    }
+    return JNI_VERSION_1_6;
+}
 
-    // JVM 层崩溃/重入时可能再次 start：必须先拆掉旧资源，防止 Oboe 流与 GlobalRef 泄漏
-    if (gRunning.load()) {
-        stopLocked(env);
+/**
+ * JNI：创建一个识别实例，返回句柄；分配失败返回 0。
+ */
+extern "C" JNIEXPORT jlong JNICALL
+Java_com_soul_piano_1note_1recognition_PianoNoteRecognizer_nativeCreate(JNIEnv* /*env*/, jobject /*thiz*/) {
+    auto* r = new (std::nothrow) NativeRecognizer();
+    return static_cast<jlong>(reinterpret_cast<intptr_t>(r));
+}
+
+/**
+ * JNI：停止并释放实例；之后句柄失效。Kotlin 保证不与同一实例的其它调用并发。
+ */
+extern "C" JNIEXPORT void JNICALL
+Java_com_soul_piano_1note_1recognition_PianoNoteRecognizer_nativeDestroy(JNIEnv* env, jobject /*thiz*/,
+                                                                         jlong handle) {
+    NativeRecognizer* r = fromHandle(handle);
+    if (r == nullptr) return;
+    {
+        std::lock_guard<std::mutex> lock(r->mutex);
+        stopLocked(env, *r);
     }
+    delete r;
+}
+
+/**
+ * JNI：启动识别。
+ * 流程：若已在运行则先释放 -> NewGlobalRef(thiz) -> （批量时）包装事件存储 -> new AudioEngine -> start
+ */
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_soul_piano_1note_1recognition_PianoNoteRecognizer_nativeStart(JNIEnv* env, jobject thiz, jlong handle,
+                                                                       jint mode, jboolean batched,
+                                                                       jint flushIntervalMs, jint maxBatchEvents,
+                                                                       jboolean polyphonic, jint maxNotes,
+                                                                       jboolean multiResolution, jboolean onsetGating,
+                                                                       jboolean noiseWhitening, jint smoothingHops,
+                                                                       jint minNoteMs, jint sampleRate, jint hopSize,
+                                                                       jint deviceId) {
+    NativeRecognizer* r = fromHandle(handle);
+    if (r == nullptr) return JNI_FALSE;
+    // 方法 ID 在 JNI_OnLoad 解析；缺失说明类被混淆或签名不符
+    if (gOnNoteDetected == nullptr || (batched && gOnNoteEvents == nullptr)) return JNI_FALSE;
+    std::lock_guard<std::mutex> lock(r->mutex);
 
-    clearJavaRef(env);
-    gJavaObjGlobal = env->NewGlobalRef(thiz);
-    if (gJavaObjGlobal == nullptr) {
+    // JVM 层崩溃/重入时可能再次 start：必须先拆掉旧资源，防止 Oboe 流与 GlobalRef 泄漏。
+    // 之后任一步失败同样经 stopLocked 释放已建的引擎与 GlobalRef，失败返回时 native 侧不再引用 Kotlin 实例
+    stopLocked(env, *r);
+    r->javaObj = env->NewGlobalRef(thiz);
+    if (r->javaObj == nullptr) {
         return JNI_FALSE;
     }
 
-    jclass cls = env->GetObjectClass(thiz);
-    if (cls == nullptr) {
-        return JNI_FALSE;
+    if (batched) {
+        jobject buffer = env->NewDirectByteBuffer(r->eventStorage, static_cast<jlong>(sizeof(r->eventStorage)));
+        if (buffer == nullptr) {
+            stopLocked(env, *r);
+            return JNI_FALSE;
+        }
+        r->eventBuffer = env->NewGlobalRef(buffer);
+        env->DeleteLocalRef(buffer);
+        if (r->eventBuffer == nullptr) {
+            stopLocked(env, *r);
+            return JNI_FALSE;
+        }
     }
-    // Kotlin: fun onNoteDetected(midiNote: Int, volume: Float, confidence: Float, frequency: Float)
-    gOnNoteDetected = env->GetMethodID(cls, "onNoteDetected", "(IFFF)V");
-    if (gOnNoteDetected == nullptr) {
+
+    AudioEngine* engine = new (std::nothrow) AudioEngine();
+    if (engine == nullptr) {
+        stopLocked(env, *r);
         return JNI_FALSE;
     }
-
-    if (gEngine != nullptr) {
-        delete gEngine;
-        gEngine = nullptr;
+    r->engine = engine;
+    if (mode == kModePipelinedDropOldest) {
+        engine->setProcessingMode(AudioEngine::ProcessingMode::Pipelined, AudioEngine::BackPressure::DropOldest);
+    } else if (mode == kModePipelinedCoalesce) {
+        engine->setProcessingMode(AudioEngine::ProcessingMode::Pipelined, AudioEngine::BackPressure::Coalesce);
+    }
+    if (mode != kModeInline) {
+        // 各实例共用定长线程池，不再各起一个分析线程
+        engine->setAnalysisPool(&sharedPool());
+    }
+    if (polyphonic) {
+        engine->setPolyphonic(true, maxNotes);
+    }
+    if (multiResolution) {
+        engine->setMultiResolution(true);
+    }
+    if (onsetGating) {
+        engine->setOnsetGating(true);
+    }
+    engine->setNoiseWhitening(noiseWhitening);
+    // 0 表示跟随设备：原生采样率与 burst 对齐的帧移、系统默认输入
+    engine->setStreamConfig(sampleRate, hopSize);
+    engine->setInputDevice(deviceId);
+    engine->setInputSource(&r->input);
+    engine->setTuning(r->tuning);
+    if (r->calibrating) {
+        r->calibrator.reset();
+        engine->setCalibrator(&r->calibrator);
     }
 
-    gEngine = new (std::nothrow) AudioEngine();
-    if (gEngine == nullptr) {
+    AudioEngine::Callbacks callbacks;
+    callbacks.user = r;
+    if (batched) {
+        NoteEventBatcher::Config config;
+        config.flushIntervalMs = flushIntervalMs;
+        config.maxBatchEvents = maxBatchEvents;
+        config.tracking.smoothingHops = smoothingHops;
+        config.tracking.minNoteMs = minNoteMs;
+        engine->setEventBatchConfig(config);
+        callbacks.onEvents = &eventsToJava;
+    } else {
+        callbacks.onNote = &callbackToJava;
+    }
+    if (!engine->start(callbacks)) {
+        stopLocked(env, *r);
         return JNI_FALSE;
     }
-
-    const bool ok = gEngine->start([](const AudioEngine::NoteResult& res) {
-        callbackToJava(res);
-    });
-
-    gRunning.store(ok);
-    return ok ? JNI_TRUE : JNI_FALSE;
+    r->running.store(true);
+    return JNI_TRUE;
 }
 
 /**
@@ -147,9 +392,201 @@ Java_com_soul_piano_1note_1recognition_PianoNoteRecognizer_nativeStart(JNIEnv* e
  * 若未运行则返回 false（与 Kotlin stop 幂等语义一致）。
  */
 extern "C" JNIEXPORT jboolean JNICALL
-Java_com_soul_piano_1note_1recognition_PianoNoteRecognizer_nativeStop(JNIEnv* env, jobject /*thiz*/) {
-    std::lock_guard<std::mutex> lock(gMutex);
-    if (!gRunning.load()) return JNI_FALSE;
-    stopLocked(env);
+Java_com_soul_piano_1note_1recognition_PianoNoteRecognizer_nativeStop(JNIEnv* env, jobject /*thiz*/,
+                                                                      jlong handle) {
+    NativeRecognizer* r = fromHandle(handle);
+    if (r == nullptr) return JNI_FALSE;
+    std::lock_guard<std::mutex> lock(r->mutex);
+    if (!r->running.load()) return JNI_FALSE;
+    stopLocked(env, *r);
+    return JNI_TRUE;
+}
+
+/**
+ * JNI：读取 Pipelined 模式计数，顺序为 pushed / dropped / discarded / coalesced。
+ * 未运行时返回 null。
+ */
+extern "C" JNIEXPORT jlongArray JNICALL
+Java_com_soul_piano_1note_1recognition_PianoNoteRecognizer_nativeGetPipelineStats(JNIEnv* env, jobject /*thiz*/,
+                                                                                  jlong handle) {
+    NativeRecognizer* r = fromHandle(handle);
+    if (r == nullptr) return nullptr;
+    std::lock_guard<std::mutex> lock(r->mutex);
+    if (r->engine == nullptr) return nullptr;
+    const AudioEngine::PipelineStats stats = r->engine->pipelineStats();
+    const jlong values[4] = {
+        static_cast<jlong>(stats.pushedHops),
+        static_cast<jlong>(stats.droppedHops),
+        static_cast<jlong>(stats.discardedHops),
+        static_cast<jlong>(stats.coalescedHops),
+    };
+    jlongArray out = env->NewLongArray(4);
+    if (out == nullptr) return nullptr;
+    env->SetLongArrayRegion(out, 0, 4, values);
+    return out;
+}
+
+/**
+ * JNI：读取实际生效的流配置，顺序为 sampleRate / hopSize（start 时按设备协商结果确定）。
+ * 未运行时返回 null。
+ */
+extern "C" JNIEXPORT jintArray JNICALL
+Java_com_soul_piano_1note_1recognition_PianoNoteRecognizer_nativeGetStreamConfig(JNIEnv* env, jobject /*thiz*/,
+                                                                                 jlong handle) {
+    NativeRecognizer* r = fromHandle(handle);
+    if (r == nullptr) return nullptr;
+    std::lock_guard<std::mutex> lock(r->mutex);
+    if (r->engine == nullptr || !r->running.load()) return nullptr;
+    const jint values[2] = {r->engine->sampleRate(), r->engine->hopSize()};
+    jintArray out = env->NewIntArray(2);
+    if (out == nullptr) return nullptr;
+    env->SetIntArrayRegion(out, 0, 2, values);
+    return out;
+}
+
+/**
+ * JNI：读取逐级耗时与 xrun 快照。布局：按 [StageStats::Stage] 顺序每级 count / p50 / p99 / max（ns）四项，
+ * 之后为 xrun 次数（不支持为 -1）与是否使用硬件时间戳（1 / 0）。未运行时返回 null。
+ */
+extern "C" JNIEXPORT jlongArray JNICALL
+Java_com_soul_piano_1note_1recognition_PianoNoteRecognizer_nativeGetStats(JNIEnv* env, jobject /*thiz*/,
+                                                                          jlong handle) {
+    NativeRecognizer* r = fromHandle(handle);
+    if (r == nullptr) return nullptr;
+    std::lock_guard<std::mutex> lock(r->mutex);
+    if (r->engine == nullptr) return nullptr;
+    const AudioEngine::Stats stats = r->engine->stats();
+
+    constexpr jsize kLength = StageStats::kNumStages * 4 + 2;
+    jlong values[kLength];
+    for (int32_t i = 0; i < StageStats::kNumStages; ++i) {
+        values[i * 4 + 0] = static_cast<jlong>(stats.stages[i].count);
+        values[i * 4 + 1] = static_cast<jlong>(stats.stages[i].p50Ns);
+        values[i * 4 + 2] = static_cast<jlong>(stats.stages[i].p99Ns);
+        values[i * 4 + 3] = static_cast<jlong>(stats.stages[i].maxNs);
+    }
+    values[kLength - 2] = stats.xRunCount;
+    values[kLength - 1] = stats.hardwareTimestamps ? 1 : 0;
+    jlongArray out = env->NewLongArray(kLength);
+    if (out == nullptr) return nullptr;
+    env->SetLongArrayRegion(out, 0, kLength, values);
+    return out;
+}
+
+/**
+ * JNI：设置调律表，下一次 nativeStart 时生效。offsets 为 88 键偏移（音分，下标 0 为 A0），null 表示不拉伸；
+ * 长度不符返回 false。越界值由 [TuningTable::set] 裁剪。
+ */
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_soul_piano_1note_1recognition_PianoNoteRecognizer_nativeSetTuning(JNIEnv* env, jobject /*thiz*/,
+                                                                           jlong handle, jfloat referenceHz,
+                                                                           jfloatArray offsets) {
+    NativeRecognizer* r = fromHandle(handle);
+    if (r == nullptr) return JNI_FALSE;
+    float values[TuningTable::kNumKeys] = {};
+    if (offsets != nullptr) {
+        if (env->GetArrayLength(offsets) != TuningTable::kNumKeys) return JNI_FALSE;
+        env->GetFloatArrayRegion(offsets, 0, TuningTable::kNumKeys, values);
+    }
+    std::lock_guard<std::mutex> lock(r->mutex);
+    r->tuning.set(referenceHz, values);
     return JNI_TRUE;
 }
+
+/**
+ * JNI：读取实例的调律表，布局同 [tuningToArray]。
+ */
+extern "C" JNIEXPORT jfloatArray JNICALL
+Java_com_soul_piano_1note_1recognition_PianoNoteRecognizer_nativeGetTuning(JNIEnv* env, jobject /*thiz*/,
+                                                                           jlong handle) {
+    NativeRecognizer* r = fromHandle(handle);
+    if (r == nullptr) return nullptr;
+    std::lock_guard<std::mutex> lock(r->mutex);
+    return tuningToArray(env, r->tuning);
+}
+
+/**
+ * JNI：开关校准采集，下一次 nativeStart 时生效（每次启动重新采集，停止时开启则同时清空上一次的结果）。
+ */
+extern "C" JNIEXPORT void JNICALL
+Java_com_soul_piano_1note_1recognition_PianoNoteRecognizer_nativeSetCalibrating(JNIEnv* /*env*/, jobject /*thiz*/,
+                                                                                jlong handle, jboolean enabled) {
+    NativeRecognizer* r = fromHandle(handle);
+    if (r == nullptr) return;
+    std::lock_guard<std::mutex> lock(r->mutex);
+    // 运行中的采集只由检测线程写，不在这里清空；下一次启动时会清空
+    if (enabled && !r->running.load()) r->calibrator.reset();
+    r->calibrating = enabled;
+}
+
+/**
+ * JNI：由上一次运行采集的结果生成调律表并替换实例的表（下一次启动生效），同时关闭校准；返回新表，布局同 [tuningToArray]。
+ * 运行中、未开启校准或没有任何已测键时返回 null，原表不变。
+ */
+extern "C" JNIEXPORT jfloatArray JNICALL
+Java_com_soul_piano_1note_1recognition_PianoNoteRecognizer_nativeFinishCalibration(JNIEnv* env, jobject /*thiz*/,
+                                                                                   jlong handle) {
+    NativeRecognizer* r = fromHandle(handle);
+    if (r == nullptr) return nullptr;
+    std::lock_guard<std::mutex> lock(r->mutex);
+    if (r->running.load() || !r->calibrating) return nullptr;
+    TuningTable calibrated;
+    if (!r->calibrator.build(r->tuning, calibrated)) return nullptr;
+    r->tuning = calibrated;
+    r->calibrating = false;
+    return tuningToArray(env, r->tuning);
+}
+
+/**
+ * JNI：离线识别一段单声道 PCM，返回全部事件；参数非法返回 null。
+ * tuning 为调律表（布局同 [tuningToArray]，null 为 440 Hz 十二平均律），与实时识别用同一张表时结果一致。
+ * 先拷出样本再分析：分析期间可能持续数秒，不能持有数组的 critical 指针。
+ */
+extern "C" JNIEXPORT jbyteArray JNICALL
+Java_com_soul_piano_1note_1recognition_PianoNoteRecognizer_nativeAnalyzePcm(JNIEnv* env, jobject /*thiz*/,
+                                                                            jfloatArray pcm, jint sampleRate,
+                                                                            jboolean polyphonic, jint maxNotes,
+                                                                            jboolean multiResolution,
+                                                                            jboolean onsetGating,
+                                                                            jboolean noiseWhitening, jint smoothingHops,
+                                                                            jint minNoteMs, jint hopSize,
+                                                                            jint numThreads, jfloatArray tuning) {
+    if (pcm == nullptr) return nullptr;
+    OfflineAnalyzer::Config config = offlineConfig(polyphonic, maxNotes, multiResolution, onsetGating,
+                                                   noiseWhitening, smoothingHops, minNoteMs, hopSize, numThreads);
+    if (!tuningFromArray(env, tuning, config.tuning)) return nullptr;
+    std::vector<float> samples(static_cast<size_t>(env->GetArrayLength(pcm)));
+    env->GetFloatArrayRegion(pcm, 0, static_cast<jsize>(samples.size()), samples.data());
+
+    OfflineAnalyzer analyzer(config);
+    std::vector<NoteEvent> events;
+    if (!analyzer.analyze(samples.data(), static_cast<int64_t>(samples.size()), sampleRate, events)) {
+        return nullptr;
+    }
+    return eventsToByteArray(env, events);
+}
+
+/**
+ * JNI：离线识别 WAV 文件，返回全部事件；文件不可读、格式不支持或调律表长度不符返回 null。tuning 同 nativeAnalyzePcm。
+ */
+extern "C" JNIEXPORT jbyteArray JNICALL
+Java_com_soul_piano_1note_1recognition_PianoNoteRecognizer_nativeAnalyzeFile(JNIEnv* env, jobject /*thiz*/,
+                                                                             jstring path, jboolean polyphonic,
+                                                                             jint maxNotes, jboolean multiResolution,
+                                                                             jboolean onsetGating,
+                                                                             jboolean noiseWhitening, jint smoothingHops,
+                                                                             jint minNoteMs, jint hopSize,
+                                                                             jint numThreads, jfloatArray tuning) {
+    if (path == nullptr) return nullptr;
+    OfflineAnalyzer::Config config = offlineConfig(polyphonic, maxNotes, multiResolution, onsetGating,
+                                                   noiseWhitening, smoothingHops, minNoteMs, hopSize, numThreads);
+    if (!tuningFromArray(env, tuning, config.tuning)) return nullptr;
+    const char* utf = env->GetStringUTFChars(path, nullptr);
+    if (utf == nullptr) return nullptr;
+
+    OfflineAnalyzer analyzer(config);
+    std::vector<NoteEvent> events;
+    const bool ok = analyzer.analyzeFile(utf, events);
+    env->ReleaseStringUTFChars(path, utf);
+    return ok ? eventsToByteArray(env, events) : nullptr;
+}
@@ -3,23 +3,32 @@ package com.soul.piano_note_recognition
 import android.os.Handler
 import android.os.HandlerThread
 import androidx.annotation.Keep
+import java.nio.ByteBuffer
+import java.nio.ByteOrder
 
 /**
  * 钢琴音符实时识别入口（Kotlin 层）。
  *
  * 职责：
  * - 通过 JNI 启动/停止底层 Oboe 录音与 C++ 音高检测；
- * - 将识别结果通过 [NoteCallback] 回传给业务层（MIDI、音量、可信度、频率）。
+ * - 将识别结果通过 [NoteCallback] 回传给业务层（MIDI、音量、可信度、频率、音分偏差）；
+ * - 按调律表（[setTuning]，默认 440 Hz 十二平均律）把基频归到琴键，可从一次校准演奏学出（[setCalibrating]）。
+ *
+ * 多实例：
+ * - 每个实例持有独立的 native 句柄（输入流、检测器状态、回调各自独立），可同时运行多个，
+ *   配合 [setInputDevice] 实现多麦克风 / 多乐器；不再使用时调用 [release] 释放 native 资源。
+ * - [getInstance] 为进程内默认实例，保持单实例用法不变（不要 release 它）。
+ * - PIPELINED_* 模式下所有实例的分析工作由 native 侧共享的定长线程池调度，线程数不随实例数增长。
  *
  * 线程与幂等：
- * - [start] / [stop] 使用 [stateLock] 保证线程安全；
+ * - [start] / [stop] / [release] 使用 [stateLock] 保证线程安全；
  * - 已在运行时再次 [start] 返回 false；已停止时再次 [stop] 返回 false；
  * - C++ 侧若出现“重复 nativeStart”（例如 JVM 异常后重入），会先释放旧资源再建新的，避免泄漏。
  *
  * 回调线程：
- * - JNI 从音频线程调用 [onNoteDetected]；此处再 [Handler.post] 到内部 [HandlerThread]，避免阻塞音频回调。
+ * - JNI 从音频线程（INLINE）或原生分析线程（PIPELINED_*）调用 [onNoteDetected]；此处再 [Handler.post] 到实例内部 [HandlerThread]，避免阻塞音频回调。
  */
-class PianoNoteRecognizer private constructor() {
+class PianoNoteRecognizer {
 
     /**
      * 音符检测结果回调。
@@ -31,12 +40,157 @@ class PianoNoteRecognizer private constructor() {
      */
     fun interface NoteCallback {
         fun onNote(midiNote: Int, volume: Float, confidence: Float, frequency: Float)
+
+        /**
+         * 带音分偏差的版本，默认转调四参数版本；需要音准信息时覆盖本方法。
+         *
+         * @param cents 相对调律表（[setTuning]）中该键中心频率的偏差（音分，约 -50..50）
+         */
+        fun onNote(midiNote: Int, volume: Float, confidence: Float, frequency: Float, cents: Float) =
+            onNote(midiNote, volume, confidence, frequency)
+    }
+
+    /**
+     * 原生状态机产生的音符事件（[startBatched] 模式）：逐帧结果经多数表决平滑、迟滞与最短音长处理后的 note-on / note-off。
+     *
+     * @param type [TYPE_NOTE_ON] 或 [TYPE_NOTE_OFF]
+     * @param midiNote MIDI 音符号 21–108
+     * @param volume NoteOn 为确认时的音量（力度）0..1；NoteOff 为 0
+     * @param confidence 触发帧（NoteOff 为最后一帧）可信度 0..1
+     * @param frequency 触发帧（NoteOff 为最后一帧）基频 Hz
+     * @param cents 触发帧（NoteOff 为最后一帧）相对调律表中该键中心的偏差（音分）
+     * @param framePosition 事件发生的输入帧号（自 start 起，按采样率换算时间）：NoteOn 为该音首次检出
+     *   （或起音门控检出的起音点）处，NoteOff 为首次缺席处；事件交付有平滑带来的延迟，时间戳不受影响
+     */
+    data class NoteEvent(
+        val type: Int,
+        val midiNote: Int,
+        val volume: Float,
+        val confidence: Float,
+        val frequency: Float,
+        val framePosition: Long,
+        val cents: Float = 0f,
+    ) {
+        companion object {
+            const val TYPE_NOTE_ON = 0
+            const val TYPE_NOTE_OFF = 1
+        }
+    }
+
+    /** 批量事件回调：一次 JNI 调用携带的全部事件，按产生顺序（同一琴键内时间不减，不同琴键的时间戳可能交错）。 */
+    fun interface NoteEventListener {
+        fun onNoteEvents(events: List<NoteEvent>)
+    }
+
+    /**
+     * 原生处理模式。
+     *
+     * - [INLINE]：音频回调线程内直接完成检测（默认，延迟最低）；
+     * - [PIPELINED_DROP_OLDEST]：音频线程只入队，分析线程检测；积压时丢弃最旧数据，时延有界（最多积压 4 个 hop）；
+     * - [PIPELINED_COALESCE]：同上，但积压时合并为一次检测，积压在队列容量（32 个 hop，默认帧移下约 340 ms）内时不丢样本。
+     *
+     * 两种 PIPELINED_* 模式在分析线程停顿超过队列容量时都会丢弃新数据（[PipelineStats.droppedHops]）；
+     * 缺口之后窗口重新攒满再检测，[NoteEvent.framePosition] 仍按真实输入帧号计。
+     */
+    enum class ProcessingMode(internal val nativeValue: Int) {
+        INLINE(0),
+        PIPELINED_DROP_OLDEST(1),
+        PIPELINED_COALESCE(2),
+    }
+
+    /**
+     * Pipelined 模式计数（自本次 [start] 起累计）。
+     *
+     * @param pushedHops 成功入队的 hop 数（每个 hop 为 [StreamConfig.hopSize] 帧）
+     * @param droppedHops 队列满、在音频线程被丢弃的 hop 数
+     * @param discardedHops DROP_OLDEST 下分析线程丢弃的积压 hop 数
+     * @param coalescedHops COALESCE 下被合并、未单独检测的 hop 数
+     */
+    data class PipelineStats(
+        val pushedHops: Long,
+        val droppedHops: Long,
+        val discardedHops: Long,
+        val coalescedHops: Long,
+    )
+
+    /**
+     * [getStats] 的计时级，顺序与 native StageStats::Stage 一致。
+     *
+     * - [FFT] / [HPS]（含噪声底白化）/ [YIN] / [POLYPHONIC]：检测器各级，跳过的帧（如起音门控）不计入；
+     * - [DETECT]：一帧检测总耗时；
+     * - [AUDIO_CALLBACK]：Oboe 数据回调总耗时（INLINE 含检测，PIPELINED_* 只含入队）；
+     * - [DISPATCH]：结果交付（JNI 调用 [onNoteDetected] / [onNoteEvents]）；
+     * - [END_TO_END]：窗口最新样本的采集时刻到开始交付的时延。
+     */
+    enum class Stage {
+        FFT,
+        HPS,
+        YIN,
+        POLYPHONIC,
+        DETECT,
+        AUDIO_CALLBACK,
+        DISPATCH,
+        END_TO_END,
+    }
+
+    /**
+     * 一级的耗时分布（纳秒，自本次 [start] 起）；分位数为对数分桶的上界，误差 < 25%，[maxNs] 为精确值。
+     * [count] 为 0 表示该级未运行（或 native 编译时关闭了计时）。
+     */
+    data class StageLatency(
+        val count: Long,
+        val p50Ns: Long,
+        val p99Ns: Long,
+        val maxNs: Long,
+    )
+
+    /**
+     * 运行统计快照。
+     *
+     * @param stages 各级耗时分布
+     * @param xRunCount 输入流溢出（xrun）次数；设备不支持时为 -1
+     * @param hardwareTimestamps [Stage.END_TO_END] 是否基于音频硬件时间戳；否则以回调到达时刻近似，不含输入缓冲时延
+     */
+    data class Stats(
+        val stages: Map<Stage, StageLatency>,
+        val xRunCount: Int,
+        val hardwareTimestamps: Boolean,
+    )
+
+    /**
+     * 实际生效的流配置（启动时与设备协商确定）。
+     *
+     * @param sampleRate 采样率 Hz；[NoteEvent.framePosition] / sampleRate 即秒数
+     * @param hopSize 帧移（每次检测推进的帧数），为设备 burst 的整数倍
+     */
+    data class StreamConfig(
+        val sampleRate: Int,
+        val hopSize: Int,
+    )
+
+    /**
+     * 调律表：基频按它归到琴键，结果的音分偏差相对其中心频率。
+     *
+     * @param referenceHz A4 参考音高 Hz（400..480）
+     * @param offsetsCents 88 键（下标 0 为 A0）相对参考音高十二平均律的拉伸偏移（音分，±45）；空表示不拉伸
+     */
+    data class Tuning(
+        val referenceHz: Float = 440f,
+        val offsetsCents: List<Float> = emptyList(),
+    ) {
+        companion object {
+            const val NUM_KEYS = 88
+        }
     }
 
     /** 用户回调；与 [isRunning] 一起在 [stateLock] 下读写，避免竞态。 */
     @Volatile
     private var callback: NoteCallback? = null
 
+    /** 批量事件回调；与 [callback] 互斥，仅 [startBatched] 时非空。 */
+    @Volatile
+    private var eventListener: NoteEventListener? = null
+
     /** 与 native 层运行状态对齐：只有 nativeStart 成功后才为 true。 */
     @Volatile
     private var isRunning: Boolean = false
@@ -45,24 +199,180 @@ class PianoNoteRecognizer private constructor() {
      * 专用工作线程：承载业务侧 [NoteCallback]，不把耗时/锁操作放在 Oboe 音频线程。
      * lazy + start()：首次使用前启动线程。
      */
-    private val handlerThread: HandlerThread by lazy {
+    private val handlerThreadLazy = lazy {
         HandlerThread("piano-note-recognition").apply { start() }
     }
+    private val handlerThread: HandlerThread by handlerThreadLazy
     private val handler: Handler by lazy { Handler(handlerThread.looper) }
 
-    /** [start]/[stop] 的互斥锁。 */
+    /** [start]/[stop]/[release] 的互斥锁。 */
     private val stateLock = Any()
 
+    /** native 实例句柄；[release] 后为 0。由 [stateLock] 保护。 */
+    private var nativeHandle: Long = nativeCreate()
+
+    /** 多音模式配置，在下一次 [start]/[startBatched] 时生效；由 [stateLock] 保护。 */
+    private var polyphonic: Boolean = false
+    private var maxNotes: Int = 6
+
+    /** 多分辨率模式配置，在下一次 [start]/[startBatched] 时生效；由 [stateLock] 保护。 */
+    private var multiResolution: Boolean = false
+
+    /** 起音门控配置，在下一次 [start]/[startBatched] 时生效；由 [stateLock] 保护。 */
+    private var onsetGating: Boolean = false
+
+    /** 噪声底白化配置，在下一次 [start]/[startBatched] 时生效；由 [stateLock] 保护。 */
+    private var noiseWhitening: Boolean = true
+
+    /** 事件跟踪参数，在下一次 [startBatched] 时生效；由 [stateLock] 保护。 */
+    private var smoothingHops: Int = 3
+    private var minNoteMs: Int = 40
+
+    /** 请求的采样率与帧移（0 表示跟随设备），在下一次 [start]/[startBatched] 时生效；由 [stateLock] 保护。 */
+    private var requestedSampleRate: Int = 0
+    private var requestedHopSize: Int = 0
+
+    /** 输入设备 id（0 为系统默认），在下一次 [start]/[startBatched] 时生效；由 [stateLock] 保护。 */
+    private var inputDeviceId: Int = 0
+
+    /**
+     * 开关多音（和弦）识别，下一次启动时生效。
+     *
+     * 开启后每帧最多输出 [maxNotes] 个同时发声的音：[NoteCallback] 对每个音各回调一次；
+     * [startBatched] 的事件按琴键独立产生 note-on / note-off。
+     *
+     * @param maxNotes 每帧最多音数 1..8
+     */
+    fun setPolyphonic(enabled: Boolean, maxNotes: Int = 6) = synchronized(stateLock) {
+        this.polyphonic = enabled
+        this.maxNotes = maxNotes.coerceIn(1, 8)
+    }
+
+    /**
+     * 开关多分辨率分析（单音模式），下一次启动时生效。
+     *
+     * 开启后低音区用 8192 点长窗提高频率分辨率，高音区只看最新 1024 点以更快响应换音；
+     * 多音模式下不生效。
+     */
+    fun setMultiResolution(enabled: Boolean) = synchronized(stateLock) {
+        this.multiResolution = enabled
+    }
+
+    /**
+     * 开关起音门控，下一次启动时生效。
+     *
+     * 开启后静音与稳定延音的帧跳过基频检测（复用上一次结果），显著降低平均 CPU；
+     * [startBatched] 的 note-on 事件 [NoteEvent.framePosition] 记在检出的起音点上，
+     * 单音模式下同一个音的重击也会产生新的 note-off / note-on。
+     */
+    fun setOnsetGating(enabled: Boolean) = synchronized(stateLock) {
+        this.onsetGating = enabled
+    }
+
+    /**
+     * 开关噪声底白化（默认开启），下一次启动时生效。
+     *
+     * 开启后逐频点跟踪稳态噪声（风扇、空调、工频嗡声等）的噪声底，在谐波分析前减去，
+     * 嘈杂环境下误报更少、低信噪比时识别更稳；噪声底约 1 秒内跟上环境变化。
+     */
+    fun setNoiseWhitening(enabled: Boolean) = synchronized(stateLock) {
+        this.noiseWhitening = enabled
+    }
+
+    /**
+     * 设置 [startBatched] 的事件跟踪参数，下一次启动时生效。
+     *
+     * @param smoothingHops 多数表决平滑帧数（奇数 1..9，1 表示不平滑）；越大越稳，事件交付越晚（时间戳不变）
+     * @param minNoteMs 最短音长（毫秒）：note-off 不早于 note-on 之后该时长
+     */
+    fun setNoteTracking(smoothingHops: Int = 3, minNoteMs: Int = 40) = synchronized(stateLock) {
+        this.smoothingHops = smoothingHops.coerceIn(1, 9)
+        this.minNoteMs = minNoteMs.coerceAtLeast(0)
+    }
+
+    /**
+     * 设置采样率与帧移，下一次启动时生效；实际值以 [streamConfig] 为准。
+     *
+     * 默认（0）跟随设备：以设备原生采样率打开输入流，避免系统重采样；帧移取约 10.7 ms（48 kHz 下 512 帧）
+     * 并对齐到设备 burst，使每次回调恰好推进整数个 hop。帧移越小时间分辨率越高、CPU 越高。
+     *
+     * @param sampleRate 采样率 Hz，0 为设备原生；设备不支持时以实际协商结果为准
+     * @param hopSize 帧移 1..2048，0 为按采样率与 burst 自动选择
+     */
+    fun setStreamConfig(sampleRate: Int = 0, hopSize: Int = 0) = synchronized(stateLock) {
+        this.requestedSampleRate = sampleRate.coerceAtLeast(0)
+        this.requestedHopSize = hopSize.coerceIn(0, 2048)
+    }
+
+    /**
+     * 指定输入设备，下一次启动时生效。多路麦克风时为每个实例指定不同设备。
+     *
+     * @param deviceId [android.media.AudioDeviceInfo.getId]，0 为系统默认输入
+     */
+    fun setInputDevice(deviceId: Int = 0) = synchronized(stateLock) {
+        this.inputDeviceId = deviceId.coerceAtLeast(0)
+    }
+
+    /**
+     * 设置调律表，下一次启动时生效；不影响 [analyzePcm] / [analyzeFile]（按 440 Hz 十二平均律）。
+     *
+     * 对 442 Hz 或拉伸调律的琴，琴键分界随实际音高移动，落在半音边界附近的音不再在相邻键之间闪烁。
+     *
+     * @return false 表示 [Tuning.offsetsCents] 长度既不为 0 也不为 [Tuning.NUM_KEYS]，或已 [release]
+     */
+    fun setTuning(tuning: Tuning): Boolean = synchronized(stateLock) {
+        if (nativeHandle == 0L) return false
+        val offsets = if (tuning.offsetsCents.isEmpty()) null else tuning.offsetsCents.toFloatArray()
+        nativeSetTuning(nativeHandle, tuning.referenceHz, offsets)
+    }
+
+    /** 当前调律表（越界值已裁剪）；已 [release] 时为 null。 */
+    fun getTuning(): Tuning? {
+        val values = synchronized(stateLock) {
+            if (nativeHandle == 0L) return null
+            nativeGetTuning(nativeHandle)
+        } ?: return null
+        return toTuning(values)
+    }
+
+    /**
+     * 开关校准采集，下一次启动时生效。
+     *
+     * 开启后启动识别并逐键（或弹一段覆盖音域的曲目）演奏，[stop] 后调用 [finishCalibration]；
+     * 偏离超过半个半音的琴可用学出的表再校准一轮。
+     */
+    fun setCalibrating(enabled: Boolean) = synchronized(stateLock) {
+        if (nativeHandle != 0L) nativeSetCalibrating(nativeHandle, enabled)
+    }
+
     /**
-     * 开始录音与识别。
+     * 由上一次运行的校准采集学出参考音高与逐键拉伸偏移，替换当前调律表（下一次启动生效）并关闭校准。
+     * 未弹到的键按相邻已测键插值。
      *
-     * @return true 表示 native 启动成功；false 表示已在运行或 native 启动失败（此时会清空 callback）
+     * @return 新的调律表；运行中、未开启校准或没有采集到可信的音时为 null（原表不变）
      */
-    fun start(callback: NoteCallback): Boolean = synchronized(stateLock) {
-        // 不允许重复启动：与用户需求一致，避免多路 Oboe stream 叠加
-        if (isRunning) return false
+    fun finishCalibration(): Tuning? {
+        val values = synchronized(stateLock) {
+            if (isRunning || nativeHandle == 0L) return null
+            nativeFinishCalibration(nativeHandle)
+        } ?: return null
+        return toTuning(values)
+    }
+
+    /**
+     * 开始录音与识别（逐帧回调）。需要音符起止时推荐 [startBatched]：只有事件跨 JNI。
+     *
+     * @param mode 原生处理模式，默认 [ProcessingMode.INLINE]
+     * @return true 表示 native 启动成功；false 表示已在运行、已 [release] 或 native 启动失败（此时会清空 callback）
+     */
+    fun start(callback: NoteCallback, mode: ProcessingMode = ProcessingMode.INLINE): Boolean = synchronized(stateLock) {
+        // 同一实例不允许重复启动，避免多路 Oboe stream 叠加；多路输入请用多个实例
+        if (isRunning || nativeHandle == 0L) return false
         this.callback = callback
-        val ok = nativeStart()
+        val ok = nativeStart(
+            nativeHandle, mode.nativeValue, false, 0, 0, polyphonic, maxNotes, multiResolution, onsetGating,
+            noiseWhitening, 0, 0, requestedSampleRate, requestedHopSize, inputDeviceId,
+        )
         if (!ok) {
             this.callback = null
             isRunning = false
@@ -72,6 +382,36 @@ class PianoNoteRecognizer private constructor() {
         true
     }
 
+    /**
+     * 以批量事件方式开始录音与识别：逐帧结果在 native 侧经平滑与迟滞转为 note-on / note-off（见 [setNoteTracking]），
+     * 攒够 [maxBatchEvents] 条或最早一条等待超过 [flushIntervalMs] 时一次性回调。
+     *
+     * @param flushIntervalMs 最大攒批时长（毫秒），<=0 表示每帧有事件即回调
+     * @param maxBatchEvents 单批最大事件数 1..64
+     * @return 同 [start]
+     */
+    fun startBatched(
+        listener: NoteEventListener,
+        mode: ProcessingMode = ProcessingMode.INLINE,
+        flushIntervalMs: Int = 50,
+        maxBatchEvents: Int = 16,
+    ): Boolean = synchronized(stateLock) {
+        if (isRunning || nativeHandle == 0L) return false
+        this.eventListener = listener
+        val ok = nativeStart(
+            nativeHandle, mode.nativeValue, true, flushIntervalMs, maxBatchEvents, polyphonic, maxNotes,
+            multiResolution, onsetGating, noiseWhitening, smoothingHops, minNoteMs, requestedSampleRate, requestedHopSize,
+            inputDeviceId,
+        )
+        if (!ok) {
+            this.eventListener = null
+            isRunning = false
+            return false
+        }
+        isRunning = true
+        true
+    }
+
     /**
      * 停止录音并释放 native 资源。
      *
@@ -79,17 +419,208 @@ class PianoNoteRecognizer private constructor() {
      */
     fun stop(): Boolean = synchronized(stateLock) {
         if (!isRunning) return false
-        val ok = nativeStop()
+        val ok = nativeStop(nativeHandle)
         isRunning = false
         this.callback = null
+        this.eventListener = null
         ok
     }
 
-    /** 对应 JNI：创建 AudioEngine、Oboe 流、注册回调到 Java 的 [onNoteDetected]。 */
-    private external fun nativeStart(): Boolean
+    /**
+     * 停止（若在运行）并释放 native 实例与回调线程；之后 [start] 恒返回 false。可重复调用。
+     */
+    fun release() = synchronized(stateLock) {
+        if (nativeHandle == 0L) return
+        nativeDestroy(nativeHandle)
+        nativeHandle = 0L
+        isRunning = false
+        this.callback = null
+        this.eventListener = null
+        if (handlerThreadLazy.isInitialized()) handlerThread.quitSafely()
+    }
+
+    /**
+     * 读取 Pipelined 模式计数；未运行时返回 null。INLINE 模式下各项恒为 0。
+     */
+    fun pipelineStats(): PipelineStats? {
+        // 持锁调用：避免与 [release] 并发时访问已释放的句柄
+        val values = synchronized(stateLock) {
+            if (nativeHandle == 0L) return null
+            nativeGetPipelineStats(nativeHandle)
+        } ?: return null
+        return PipelineStats(values[0], values[1], values[2], values[3])
+    }
+
+    /**
+     * 读取实际生效的采样率与帧移；未运行时返回 null。
+     */
+    fun streamConfig(): StreamConfig? {
+        // 持锁调用：避免与 [release] 并发时访问已释放的句柄
+        val values = synchronized(stateLock) {
+            if (nativeHandle == 0L) return null
+            nativeGetStreamConfig(nativeHandle)
+        } ?: return null
+        return StreamConfig(values[0], values[1])
+    }
+
+    /**
+     * 读取各级耗时分布与 xrun 计数；未运行时返回 null。记录端在 native 侧无锁完成，读取不影响音频线程。
+     */
+    fun getStats(): Stats? {
+        val values = synchronized(stateLock) {
+            if (nativeHandle == 0L) return null
+            nativeGetStats(nativeHandle)
+        } ?: return null
+        val stages = Stage.values().associateWith { stage ->
+            val base = stage.ordinal * 4
+            StageLatency(values[base], values[base + 1], values[base + 2], values[base + 3])
+        }
+        val tail = Stage.values().size * 4
+        return Stats(stages, values[tail].toInt(), values[tail + 1] != 0L)
+    }
+
+    /**
+     * 离线识别一段单声道 PCM（如录好的练琴录音），与实时识别互不影响、可同时进行。
+     *
+     * 与 [startBatched] 使用同一套检测与事件跟踪，沿用当前的多音 / 多分辨率 / 起音门控 / 噪声底白化 / [setNoteTracking] 配置、
+     * 调律表（[setTuning] / [finishCalibration]），以及 [setStreamConfig] 的帧移（0 时为 512）；
+     * native 侧按块分给多个线程并行检测。调用线程阻塞直到完成（1 小时音频约需数秒到数十秒），勿在主线程调用。
+     *
+     * @param pcm 样本 -1..1
+     * @param sampleRate 采样率 Hz（任意原生采样率，不需重采样）
+     * @param numThreads 工作线程数，<=0 为 CPU 核数
+     * @return 全部事件，[NoteEvent.framePosition] 为样本序号；参数非法时为 null
+     */
+    fun analyzePcm(pcm: FloatArray, sampleRate: Int = 48000, numThreads: Int = 0): List<NoteEvent>? {
+        val c = offlineConfig()
+        val bytes = nativeAnalyzePcm(
+            pcm, sampleRate, c.polyphonic, c.maxNotes, c.multiResolution, c.onsetGating, c.noiseWhitening,
+            c.smoothingHops, c.minNoteMs, c.hopSize, numThreads, c.tuning,
+        ) ?: return null
+        return readEvents(bytes)
+    }
+
+    /**
+     * 离线识别 WAV 文件（PCM 16/24/32 位或 float 32 位，多声道混为单声道，不重采样）；其余同 [analyzePcm]。
+     *
+     * @return 全部事件；文件不可读或格式不支持时为 null
+     */
+    fun analyzeFile(path: String, numThreads: Int = 0): List<NoteEvent>? {
+        val c = offlineConfig()
+        val bytes = nativeAnalyzeFile(
+            path, c.polyphonic, c.maxNotes, c.multiResolution, c.onsetGating, c.noiseWhitening,
+            c.smoothingHops, c.minNoteMs, c.hopSize, numThreads, c.tuning,
+        ) ?: return null
+        return readEvents(bytes)
+    }
+
+    /** 离线分析使用的配置快照；分析本身不持 [stateLock]，不阻塞 [start]/[stop]。 */
+    private class OfflineConfig(
+        val polyphonic: Boolean,
+        val maxNotes: Int,
+        val multiResolution: Boolean,
+        val onsetGating: Boolean,
+        val noiseWhitening: Boolean,
+        val smoothingHops: Int,
+        val minNoteMs: Int,
+        val hopSize: Int,
+        /** 布局同 [nativeGetTuning]；已 [release] 时为 null（440 Hz 十二平均律） */
+        val tuning: FloatArray?,
+    )
+
+    private fun offlineConfig(): OfflineConfig = synchronized(stateLock) {
+        OfflineConfig(
+            polyphonic, maxNotes, multiResolution, onsetGating, noiseWhitening, smoothingHops, minNoteMs, requestedHopSize,
+            if (nativeHandle != 0L) nativeGetTuning(nativeHandle) else null,
+        )
+    }
+
+    /** 对应 JNI：创建 native 实例，返回句柄（失败为 0）。 */
+    private external fun nativeCreate(): Long
+
+    /** 对应 JNI：停止并释放 native 实例，之后句柄失效。 */
+    private external fun nativeDestroy(handle: Long)
+
+    /**
+     * 对应 JNI：创建 AudioEngine、Oboe 流，注册回调到 Java 的 [onNoteDetected]；
+     * [batched] 为 true 时改为批量回调 [onNoteEvents]；[polyphonic] 为 true 时走多音检测；
+     * [multiResolution] 为 true 时单音检测走长短窗合并；[onsetGating] 为 true 时开启起音门控；
+     * [noiseWhitening] 为 true 时 HPS 前做噪声底白化；
+     * [smoothingHops] / [minNoteMs] 为批量模式的事件跟踪参数；[sampleRate] / [hopSize] 为 0 时跟随设备；
+     * [deviceId] 为 0 时使用系统默认输入。
+     */
+    private external fun nativeStart(
+        handle: Long,
+        mode: Int,
+        batched: Boolean,
+        flushIntervalMs: Int,
+        maxBatchEvents: Int,
+        polyphonic: Boolean,
+        maxNotes: Int,
+        multiResolution: Boolean,
+        onsetGating: Boolean,
+        noiseWhitening: Boolean,
+        smoothingHops: Int,
+        minNoteMs: Int,
+        sampleRate: Int,
+        hopSize: Int,
+        deviceId: Int,
+    ): Boolean
 
     /** 对应 JNI：停止流、delete AudioEngine、删除 GlobalRef。 */
-    private external fun nativeStop(): Boolean
+    private external fun nativeStop(handle: Long): Boolean
+
+    /** 对应 JNI：Pipelined 计数，顺序 pushed / dropped / discarded / coalesced。 */
+    private external fun nativeGetPipelineStats(handle: Long): LongArray?
+
+    /** 对应 JNI：实际流配置，顺序 sampleRate / hopSize；未运行为 null。 */
+    private external fun nativeGetStreamConfig(handle: Long): IntArray?
+
+    /** 对应 JNI：每级 count / p50 / p99 / max，之后 xrun 次数与硬件时间戳标志；未运行为 null。 */
+    private external fun nativeGetStats(handle: Long): LongArray?
+
+    /** 对应 JNI：设置调律表，[offsets] 为 null 表示不拉伸；长度不符返回 false。 */
+    private external fun nativeSetTuning(handle: Long, referenceHz: Float, offsets: FloatArray?): Boolean
+
+    /** 对应 JNI：调律表，参考音高之后为 88 键偏移。 */
+    private external fun nativeGetTuning(handle: Long): FloatArray?
+
+    /** 对应 JNI：开关校准采集。 */
+    private external fun nativeSetCalibrating(handle: Long, enabled: Boolean)
+
+    /** 对应 JNI：生成并替换调律表，布局同 [nativeGetTuning]；失败为 null。 */
+    private external fun nativeFinishCalibration(handle: Long): FloatArray?
+
+    /** 对应 JNI：离线识别 PCM，返回按 NoteEvent 布局拼接的事件字节；[tuning] 布局同 [nativeGetTuning]；参数非法为 null。 */
+    private external fun nativeAnalyzePcm(
+        pcm: FloatArray,
+        sampleRate: Int,
+        polyphonic: Boolean,
+        maxNotes: Int,
+        multiResolution: Boolean,
+        onsetGating: Boolean,
+        noiseWhitening: Boolean,
+        smoothingHops: Int,
+        minNoteMs: Int,
+        hopSize: Int,
+        numThreads: Int,
+        tuning: FloatArray?,
+    ): ByteArray?
+
+    /** 对应 JNI：离线识别 WAV 文件，返回值同 [nativeAnalyzePcm]。 */
+    private external fun nativeAnalyzeFile(
+        path: String,
+        polyphonic: Boolean,
+        maxNotes: Int,
+        multiResolution: Boolean,
+        onsetGating: Boolean,
+        noiseWhitening: Boolean,
+        smoothingHops: Int,
+        minNoteMs: Int,
+        hopSize: Int,
+        numThreads: Int,
+        tuning: FloatArray?,
+    ): ByteArray?
 
     /**
      * 由 C++ 在音频线程调用（非主线程）。
@@ -98,14 +629,57 @@ class PianoNoteRecognizer private constructor() {
      * 关键逻辑：只把数据 post 到 [handler]，再调用用户 [callback]。
      */
     @Keep
-    fun onNoteDetected(midiNote: Int, volume: Float, confidence: Float, frequency: Float) {
+    fun onNoteDetected(midiNote: Int, volume: Float, confidence: Float, frequency: Float, cents: Float) {
         val cb = callback ?: return
-        handler.post { cb.onNote(midiNote, volume, confidence, frequency) }
+        handler.post { cb.onNote(midiNote, volume, confidence, frequency, cents) }
+    }
+
+    /**
+     * 由 C++ 在检测线程调用，携带一批 [NoteEvent]（每条 32 字节，本机字节序）。
+     *
+     * 关键逻辑：[buffer] 由 native 复用，必须在本方法返回前读完；解析后再 post 到 [handler]。
+     */
+    @Keep
+    fun onNoteEvents(buffer: ByteBuffer, count: Int) {
+        val listener = eventListener ?: return
+        val events = readEvents(buffer, count)
+        handler.post { listener.onNoteEvents(events) }
     }
 
     companion object {
         private const val TAG = "PianoNoteRecognizer"
 
+        /** 与 C++ NoteEvent 的 sizeof 一致 */
+        private const val EVENT_BYTES = 32
+
+        /** 按 C++ NoteEvent 布局（本机字节序）解析 [count] 条事件 */
+        private fun readEvents(buffer: ByteBuffer, count: Int): List<NoteEvent> {
+            buffer.order(ByteOrder.nativeOrder())
+            val events = ArrayList<NoteEvent>(count)
+            for (i in 0 until count) {
+                val base = i * EVENT_BYTES
+                events.add(
+                    NoteEvent(
+                        type = buffer.getInt(base),
+                        midiNote = buffer.getInt(base + 4),
+                        volume = buffer.getFloat(base + 8),
+                        confidence = buffer.getFloat(base + 12),
+                        frequency = buffer.getFloat(base + 16),
+                        framePosition = buffer.getLong(base + 24),
+                        cents = buffer.getFloat(base + 20),
+                    )
+                )
+            }
+            return events
+        }
+
+        private fun readEvents(bytes: ByteArray): List<NoteEvent> =
+            readEvents(ByteBuffer.wrap(bytes), bytes.size / EVENT_BYTES)
+
+        /** native 调律数组（参考音高 + 88 键偏移）-> [Tuning] */
+        private fun toTuning(values: FloatArray): Tuning =
+            Tuning(values[0], values.copyOfRange(1, values.size).toList())
+
         @Volatile
         private var INSTANCE: PianoNoteRecognizer? = null
 
@@ -114,7 +688,7 @@ class PianoNoteRecognizer private constructor() {
             System.loadLibrary("piano_note_recognition")
         }
 
-        /** 双重检查锁定单例，与项目内其它 Manager 风格一致。 */
+        /** 进程内默认实例（双重检查锁定，与项目内其它 Manager 风格一致）；多路输入时另行构造实例。 */
         fun getInstance(): PianoNoteRecognizer {
             return INSTANCE ?: synchronized(this) {
                 INSTANCE ?: PianoNoteRecognizer().also { INSTANCE = it }
@@ -0,0 +1,316 @@
+/**
+ * @file NoteTrackingTest.cpp
+ * @brief 主机事件回归套件：固定逐帧序列送入 [NoteTracker] / [NoteEventBatcher]，合成音频送入 [OfflineAnalyzer]，核对事件
+ *
+ * 用例：
+ * - outliers：起止处的单帧杂音（-1,-1,-1,40,60×10,45,-1…）与音中单帧八度跳变不产生额外事件；
+ * - min_note：NoteOff 不早于 NoteOn 后 minNoteMs，单音模式被新音顶替时同样如此；
+ * - hysteresis：可信度低于 onConfidence 不起音，发声中高于 sustainConfidence 即保持；
+ * - restrike：起音窗口内换音记在起音帧上，窗口过去仍是同一个音时补一对 NoteOff / NoteOn；
+ * - batcher：按 maxBatchEvents 与 flushIntervalMs 成批交付，finish 补齐 NoteOff；
+ * - offline：14 个相隔静音的单音只产生 14 对事件；chunkHops = 256（多线程）与整段一块（单线程）的事件一致：
+ *   关闭噪声底白化时逐字节相同，开启时（每块重新跟踪噪声底，可信度略有出入）类型、琴键与时间戳相同。
+ *
+ * 用法：piano_note_tracking；任一用例失败返回 1。
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "SyntheticSignals.h"
+#include "audio/NoteEventBatcher.h"
+#include "audio/NoteTracker.h"
+#include "audio/OfflineAnalyzer.h"
+
+namespace {
+
+constexpr int32_t kSampleRate = 48000;
+constexpr int32_t kHop = 512;
+
+int32_t gFailures = 0;
+
+void check(bool ok, const char* test, const char* what) {
+    if (!ok) {
+        ++gFailures;
+        std::printf("FAIL %-12s %s\n", test, what);
+    }
+}
+
+void collect(void* user, const NoteEvent& event) {
+    static_cast<std::vector<NoteEvent>*>(user)->push_back(event);
+}
+
+bool isEvent(const NoteEvent& e, NoteEventType type, int32_t midi, int64_t at) {
+    return e.type == static_cast<int32_t>(type) && e.midiNote == midi && e.framePosition == at;
+}
+
+void printEvents(const char* test, const std::vector<NoteEvent>& events) {
+    for (const NoteEvent& e : events) {
+        std::printf("     %-12s %s m%d @%lld\n", test, e.type == 0 ? "ON " : "OFF", e.midiNote,
+                    static_cast<long long>(e.framePosition));
+    }
+}
+
+/** 第 i 帧窗口末端的帧号 */
+int64_t frameAt(int32_t i) { return static_cast<int64_t>(i + 1) * kHop; }
+
+/** 单音序列逐帧送入 tracker（-1 为无音帧），可信度统一为 confidence；返回全部事件（含 finish） */
+std::vector<NoteEvent> runMono(const NoteTracker::Config& config, const std::vector<int32_t>& notes,
+                               float confidence = 0.9f) {
+    std::vector<NoteEvent> events;
+    NoteTracker tracker;
+    tracker.configure(config, kSampleRate, &collect, &events);
+    for (size_t i = 0; i < notes.size(); ++i) {
+        const NoteTracker::FrameNote note{notes[i], 0.5f, confidence, 440.0f, 0.0f};
+        tracker.onFrame(&note, notes[i] >= 0 ? 1 : 0, frameAt(static_cast<int32_t>(i)));
+    }
+    tracker.finish(frameAt(static_cast<int32_t>(notes.size())));
+    return events;
+}
+
+std::vector<int32_t> sequence(std::initializer_list<std::pair<int32_t, int32_t>> runs) {
+    std::vector<int32_t> out;
+    for (const auto& run : runs) out.insert(out.end(), static_cast<size_t>(run.second), run.first);
+    return out;
+}
+
+void testOutliers() {
+    NoteTracker::Config config;
+    // 起止各一帧杂音：-1×3, 40, 60×10, 45, -1×6
+    auto events = runMono(config, sequence({{-1, 3}, {40, 1}, {60, 10}, {45, 1}, {-1, 6}}));
+    const bool ok = events.size() == 2 && isEvent(events[0], NoteEventType::NoteOn, 60, frameAt(4)) &&
+                    isEvent(events[1], NoteEventType::NoteOff, 60, frameAt(14));
+    check(ok, "outliers", "onset / release blips must not become notes");
+    if (!ok) printEvents("outliers", events);
+
+    // 音中单帧八度跳变与掉帧
+    events = runMono(config, sequence({{60, 5}, {72, 1}, {60, 3}, {-1, 1}, {60, 5}, {-1, 4}}));
+    check(events.size() == 2 && events[0].midiNote == 60 && events[1].midiNote == 60, "outliers",
+          "single-frame octave jump / dropout inside a note");
+    if (events.size() != 2) printEvents("outliers", events);
+
+    // 换音过渡帧不产生第三个音
+    events = runMono(config, sequence({{60, 6}, {61, 1}, {64, 6}, {-1, 4}}));
+    const bool change = events.size() == 4 && isEvent(events[0], NoteEventType::NoteOn, 60, frameAt(0)) &&
+                        isEvent(events[2], NoteEventType::NoteOn, 64, frameAt(7)) && events[1].midiNote == 60;
+    check(change, "outliers", "note change through a transition frame");
+    if (!change) printEvents("outliers", events);
+}
+
+void testMinNote() {
+    NoteTracker::Config config;
+    config.minNoteMs = 100;
+    const int64_t minFrames = static_cast<int64_t>(config.minNoteMs) * kSampleRate / 1000;
+
+    // 两帧的短音：NoteOff 推迟到最短音长处
+    auto events = runMono(config, sequence({{-1, 2}, {60, 2}, {-1, 20}}));
+    bool ok = events.size() == 2 && events[0].type == 0 && events[1].type == 1 &&
+              events[1].framePosition - events[0].framePosition == minFrames;
+    check(ok, "min_note", "short note is held for minNoteMs");
+    if (!ok) printEvents("min_note", events);
+
+    // 单音模式的顶替：新音等到最短音长处交接
+    events = runMono(config, sequence({{-1, 2}, {60, 2}, {62, 20}, {-1, 4}}));
+    ok = events.size() == 4 && isEvent(events[0], NoteEventType::NoteOn, 60, frameAt(2)) &&
+         isEvent(events[1], NoteEventType::NoteOff, 60, frameAt(2) + minFrames) &&
+         isEvent(events[2], NoteEventType::NoteOn, 62, frameAt(2) + minFrames);
+    check(ok, "min_note", "monophonic replacement respects minNoteMs");
+    if (!ok) printEvents("min_note", events);
+
+    // 所有音都不短于最短音长
+    for (size_t i = 0; i + 1 < events.size(); ++i) {
+        if (events[i].type != 0) continue;
+        for (size_t j = i + 1; j < events.size(); ++j) {
+            if (events[j].type == 1 && events[j].midiNote == events[i].midiNote) {
+                check(events[j].framePosition - events[i].framePosition >= minFrames, "min_note",
+                      "note shorter than minNoteMs");
+                break;
+            }
+        }
+    }
+}
+
+void testHysteresis() {
+    NoteTracker::Config config;
+    config.smoothingHops = 1;
+    config.onConfidence = 0.5f;
+    config.sustainConfidence = 0.2f;
+    config.minNoteMs = 0;
+
+    std::vector<NoteEvent> events;
+    NoteTracker tracker;
+    tracker.configure(config, kSampleRate, &collect, &events);
+    const float confidences[] = {0.3f, 0.4f, 0.6f, 0.3f, 0.25f, 0.3f, 0.1f, 0.1f, 0.3f, 0.4f};
+    int32_t frame = 0;
+    for (float c : confidences) {
+        const NoteTracker::FrameNote note{60, 0.5f, c, 261.6f, 0.0f};
+        tracker.onFrame(&note, 1, frameAt(frame++));
+    }
+    tracker.finish(frameAt(frame));
+    // 0.6 处起音，0.3 / 0.25 保持，0.1 处开始缺席；之后 0.3 / 0.4 不足以重新起音
+    const bool ok = events.size() == 2 && isEvent(events[0], NoteEventType::NoteOn, 60, frameAt(2)) &&
+                    isEvent(events[1], NoteEventType::NoteOff, 60, frameAt(6));
+    check(ok, "hysteresis", "on / sustain confidence thresholds");
+    if (!ok) printEvents("hysteresis", events);
+}
+
+void testRestrike() {
+    NoteTracker::Config config;
+    config.onsetWindowFrames = 4 * kHop;
+
+    std::vector<NoteEvent> events;
+    NoteTracker tracker;
+    tracker.configure(config, kSampleRate, &collect, &events);
+    const auto feed = [&](int32_t midi, int32_t frames, int64_t onsetFrame, int32_t& frame) {
+        for (int32_t i = 0; i < frames; ++i) {
+            const NoteTracker::FrameNote note{midi, 0.5f, 0.9f, 440.0f, 0.0f};
+            tracker.onFrame(&note, midi >= 0 ? 1 : 0, frameAt(frame), i == 0 ? onsetFrame : -1);
+            ++frame;
+        }
+    };
+    int32_t frame = 0;
+    feed(60, 10, frameAt(0) - 100, frame);
+    // 同一个音在起音窗口内没有变化：起音窗口过后补一对 NoteOff / NoteOn，记在起音帧上
+    const int64_t restrike = frameAt(frame) - 200;
+    feed(60, 10, restrike, frame);
+    // 起音窗口内换音：新音记在起音帧上
+    const int64_t change = frameAt(frame) - 300;
+    feed(64, 10, change, frame);
+    feed(-1, 4, -1, frame);
+    tracker.finish(frameAt(frame));
+
+    const bool ok = events.size() == 6 && isEvent(events[0], NoteEventType::NoteOn, 60, frameAt(0) - 100) &&
+                    isEvent(events[1], NoteEventType::NoteOff, 60, restrike) &&
+                    isEvent(events[2], NoteEventType::NoteOn, 60, restrike) &&
+                    isEvent(events[3], NoteEventType::NoteOff, 60, change) &&
+                    isEvent(events[4], NoteEventType::NoteOn, 64, change) && events[5].midiNote == 64 &&
+                    events[5].type == 1;
+    check(ok, "restrike", "re-strike and note change inside the onset window");
+    if (!ok) printEvents("restrike", events);
+}
+
+struct Batches {
+    int32_t flushes = 0;
+    int32_t largest = 0;
+    std::vector<NoteEvent> events;
+};
+
+void onBatch(void* user, const NoteEvent* events, int32_t count) {
+    auto& b = *static_cast<Batches*>(user);
+    ++b.flushes;
+    b.largest = std::max(b.largest, count);
+    b.events.insert(b.events.end(), events, events + count);
+}
+
+void testBatcher() {
+    // 每 4 帧换一个音、平滑 1 帧：每帧至多 2 条事件
+    NoteEventBatcher::Config config;
+    config.tracking.smoothingHops = 1;
+    config.tracking.minNoteMs = 0;
+    config.maxBatchEvents = 3;
+    config.flushIntervalMs = 1000;
+
+    Batches batches;
+    NoteEventBatcher batcher;
+    batcher.configure(config, kSampleRate, &onBatch, &batches);
+    int32_t frame = 0;
+    for (int32_t n = 0; n < 8; ++n) {
+        for (int32_t i = 0; i < 4; ++i) {
+            const NoteTracker::FrameNote note{48 + n, 0.5f, 0.9f, 130.0f, 0.0f};
+            batcher.onFrame(&note, 1, frameAt(frame++));
+        }
+    }
+    batcher.finish(frameAt(frame));
+    check(batches.events.size() == 16, "batcher", "every note yields one NoteOn / NoteOff pair");
+    check(batches.largest <= config.maxBatchEvents + 1, "batcher", "batch larger than maxBatchEvents");
+    check(batches.flushes >= 16 / (config.maxBatchEvents + 1), "batcher", "batches not flushed on size");
+
+    // 间隔交付：一个音起音后无新事件，flushIntervalMs 后单独交付
+    config.maxBatchEvents = NoteEventBatcher::kMaxBatchEvents;
+    config.flushIntervalMs = 50;
+    batches = Batches{};
+    batcher.configure(config, kSampleRate, &onBatch, &batches);
+    const int32_t intervalHops = config.flushIntervalMs * kSampleRate / 1000 / kHop;
+    frame = 0;
+    for (int32_t i = 0; i < intervalHops + 2; ++i) {
+        const NoteTracker::FrameNote note{60, 0.5f, 0.9f, 261.6f, 0.0f};
+        batcher.onFrame(&note, 1, frameAt(frame++));
+    }
+    check(batches.flushes == 1 && batches.events.size() == 1, "batcher", "pending NoteOn flushed on interval");
+    batcher.finish(frameAt(frame));
+    check(batches.flushes == 2 && batches.events.size() == 2, "batcher", "finish flushes the closing NoteOff");
+}
+
+void testOffline() {
+    // 1 s 底噪（噪声底白化先收敛）后 14 个单音，各 0.4 s，之间 0.25 s 静音；5 ms 起音、80 ms 制音
+    constexpr int32_t kNotes = 14;
+    const auto noteLength = static_cast<size_t>(0.4 * kSampleRate);
+    const auto gapLength = static_cast<size_t>(0.25 * kSampleRate);
+    const auto attack = static_cast<size_t>(0.005 * kSampleRate);
+    const auto release = static_cast<size_t>(0.08 * kSampleRate);
+    std::vector<float> signal(static_cast<size_t>(kSampleRate), 0.0f);
+    for (int32_t n = 0; n < kNotes; ++n) {
+        synth::Tone tone{40 + 4 * n};
+        tone.inharmonicity = 1e-4 * std::pow(2.0, (tone.midi - 21) / 24.0);
+        std::vector<float> note(noteLength, 0.0f);
+        synth::addTone(note, tone, static_cast<float>(kSampleRate), static_cast<uint32_t>(n));
+        for (size_t i = 0; i < attack; ++i) note[i] *= static_cast<float>(i) / static_cast<float>(attack);
+        for (size_t i = 0; i < release; ++i) {
+            note[noteLength - 1 - i] *= static_cast<float>(i) / static_cast<float>(release);
+        }
+        signal.insert(signal.end(), note.begin(), note.end());
+        signal.insert(signal.end(), gapLength, 0.0f);
+    }
+    synth::addNoise(signal, 40.0, 7u);
+
+    for (bool whitening : {true, false}) {
+        OfflineAnalyzer::Config config;
+        config.noiseWhitening = whitening;
+        config.chunkHops = 256;
+        config.numThreads = 4;
+        std::vector<NoteEvent> chunked;
+        OfflineAnalyzer(config).analyze(signal.data(), static_cast<int64_t>(signal.size()), kSampleRate, chunked);
+
+        config.chunkHops = static_cast<int32_t>(signal.size() / kHop) + 1;
+        config.numThreads = 1;
+        std::vector<NoteEvent> whole;
+        OfflineAnalyzer(config).analyze(signal.data(), static_cast<int64_t>(signal.size()), kSampleRate, whole);
+
+        bool pairs = chunked.size() == 2 * kNotes;
+        for (size_t i = 0; pairs && i < chunked.size(); ++i) {
+            pairs = chunked[i].midiNote == 40 + 4 * static_cast<int32_t>(i / 2) &&
+                    chunked[i].type ==
+                        static_cast<int32_t>(i % 2 == 0 ? NoteEventType::NoteOn : NoteEventType::NoteOff);
+        }
+        check(pairs, "offline", "one NoteOn / NoteOff pair per synthetic note");
+        if (!pairs) printEvents("offline", chunked);
+
+        bool same = chunked.size() == whole.size();
+        for (size_t i = 0; same && i < chunked.size(); ++i) {
+            same = whitening ? chunked[i].type == whole[i].type && chunked[i].midiNote == whole[i].midiNote &&
+                                   chunked[i].framePosition == whole[i].framePosition
+                             : std::memcmp(&chunked[i], &whole[i], sizeof(NoteEvent)) == 0;
+        }
+        check(same, "offline", whitening ? "chunkHops = 256 and a single chunk differ (whitening)"
+                                         : "chunkHops = 256 and a single chunk differ");
+    }
+}
+
+} // namespace
+
+int main() {
+    testOutliers();
+    testMinNote();
+    testHysteresis();
+    testRestrike();
+    testBatcher();
+    testOffline();
+    if (gFailures > 0) {
+        std::printf("%d check(s) failed\n", gFailures);
+        return 1;
+    }
+    std::printf("all note tracking checks passed\n");
+    return 0;
+}
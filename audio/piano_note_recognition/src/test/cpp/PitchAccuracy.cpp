@@ -0,0 +1,442 @@
+/**
+ * @file PitchAccuracy.cpp
+ * @brief 主机准确率回归套件：合成信号上跑 [PitchDetector]，与基线门限比较
+ *
+ * 套件（除 keys_44k 外均为 48 kHz，每个用例取 8 个相邻 hop 的窗口，过半帧正确即记为正确）：
+ * - keys_clean：88 键，谐波泛音；
+ * - keys_detuned：88 键，交替 ±30 音分失谐；
+ * - keys_inharmonic：88 键，B 由 A0 的 1e-4 按每八度 ×√2 增至 C8 约 1.2e-3；
+ * - noise_30db / noise_20db / noise_10db：同 keys_inharmonic 加白噪声；
+ * - keys_44k：同 keys_inharmonic，44.1 kHz 采样（检测器按 [PitchDetector::prepare] 重建派生表）；
+ * - hum_lead_5db：同 keys_inharmonic，音前先有约 1 s 的白噪声 + 50 Hz 工频（噪声底跟踪先建立），信噪比 5 dB；
+ *   另统计音前纯噪声帧中未报音的比例（hum_lead_5db_reject）；
+ * - hps_within_5c：只跑 [HPS::detect]（FFT 幅度谱，5 次谐波），失谐 ±30 音分的非谐音，统计基频误差在 ±5 音分内的键比例；
+ *   2048 点谱覆盖 88 键，8192 点谱只取多分辨率低音区（< [PitchDetector::kSplitHz]）；
+ * - tuning_*（linear，30 dB 噪声，经 [TuningTable] 取整）：tuning_cents_5c/detuned 为 ±30 音分失谐的谐波音报告音分
+ *   与真值相差 ±5 音分内的键比例；tuning_stretched 为 A4 = 442 Hz、低音 -15 / 高音 +30 音分拉伸的非谐音琴，
+ *   分别用 440 Hz 平均律表（et440）与 [TuningCalibrator] 两轮校准后的表（calibrated）检测，
+ *   tuning_centred_5c 为报告音分落在键中心 ±5 音分内的键比例；calibrated_cq 为校准表下的常 Q 前端（bin 中心按表取样）；
+ * - chords：大 / 小三和弦（根音 MIDI 40..76，非谐泛音，30 dB 噪声），多音模式下逐帧统计召回率与精确率；
+ *   chords_a452 为 A4 = 452 Hz 的琴配同参考音高的调律表（多音模板按表取样）。
+ * 单音套件在 linear（默认）、cq（常 Q 前端）、multires（多分辨率）三种配置下各跑一遍。
+ *
+ * 用法：piano_note_accuracy [--report]
+ * 低于 [kBaselines] 中任一门限时返回 1（--report 只打印不判定）。算法改动提高了准确率时同步抬高门限。
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "PitchDetector.h"
+#include "SyntheticSignals.h"
+#include "dsp/TuningCalibrator.h"
+
+namespace {
+
+constexpr int32_t kHop = 512;
+constexpr int32_t kFrames = 8;
+constexpr int32_t kSignalLength = PitchDetector::kLongFftSize + kFrames * kHop;
+
+enum class Mode {
+    Linear,
+    ConstantQ,
+    MultiResolution,
+};
+
+const char* modeName(Mode mode) {
+    switch (mode) {
+        case Mode::Linear:
+            return "linear";
+        case Mode::ConstantQ:
+            return "cq";
+        case Mode::MultiResolution:
+            return "multires";
+    }
+    return "?";
+}
+
+struct Metric {
+    std::string name;
+    double value;
+};
+
+/** 回归门限：当前实现实测值减去约 3 个百分点的余量 */
+struct Baseline {
+    const char* name;
+    double minimum;
+};
+
+constexpr Baseline kBaselines[] = {
+    {"keys_clean/linear", 0.96},
+    {"keys_clean/cq", 0.96},
+    {"keys_clean/multires", 0.96},
+    {"keys_detuned/linear", 0.95},
+    {"keys_detuned/cq", 0.95},
+    {"keys_detuned/multires", 0.96},
+    {"keys_inharmonic/linear", 0.96},
+    {"keys_inharmonic/cq", 0.96},
+    {"keys_inharmonic/multires", 0.96},
+    {"noise_30db/linear", 0.96},
+    {"noise_30db/cq", 0.96},
+    {"noise_30db/multires", 0.96},
+    {"noise_20db/linear", 0.96},
+    {"noise_20db/cq", 0.96},
+    {"noise_20db/multires", 0.96},
+    {"noise_10db/linear", 0.86},
+    {"noise_10db/cq", 0.83},
+    {"noise_10db/multires", 0.92},
+    {"keys_44k/linear", 0.96},
+    {"keys_44k/cq", 0.96},
+    {"keys_44k/multires", 0.96},
+    {"hum_lead_5db/linear", 0.30},
+    {"hum_lead_5db/cq", 0.32},
+    {"hum_lead_5db/multires", 0.46},
+    {"hum_lead_5db_reject/linear", 0.93},
+    {"hum_lead_5db_reject/cq", 0.93},
+    {"hum_lead_5db_reject/multires", 0.93},
+    {"hps_within_5c/2048", 0.55},
+    {"hps_within_5c/8192", 0.81},
+    {"tuning_cents_5c/detuned", 0.93},
+    {"tuning_stretched/et440", 0.96},
+    {"tuning_stretched/calibrated", 0.96},
+    {"tuning_centred_5c/calibrated", 0.97},
+    {"tuning_stretched/calibrated_cq", 0.96},
+    {"tuning_centred_5c/calibrated_cq", 0.97},
+    {"chords/recall", 0.70},
+    {"chords/precision", 0.77},
+    {"chords_a452/recall", 0.69},
+    {"chords_a452/precision", 0.74},
+};
+
+/** 钢琴弦非谐系数的粗略模型 */
+double inharmonicityFor(int32_t midi) { return 1e-4 * std::pow(2.0, (midi - 21) / 24.0); }
+
+/** 单音：对信号末尾 kFrames 个 hop 各检测一次，返回正确帧数 */
+int32_t correctFrames(PitchDetector& detector, Mode mode, const std::vector<float>& signal, int32_t expected,
+                      float sampleRate) {
+    detector.reset();
+    int32_t correct = 0;
+    for (int32_t f = 0; f < kFrames; ++f) {
+        const int32_t end = PitchDetector::kLongFftSize + (f + 1) * kHop;
+        PitchDetector::NoteResult r;
+        if (mode == Mode::MultiResolution) {
+            r = detector.processMultiResolution(signal.data() + end - PitchDetector::kLongFftSize,
+                                                PitchDetector::kLongFftSize, sampleRate);
+        } else {
+            r = detector.process(signal.data() + end - FFTWrapper::kFftSize, FFTWrapper::kFftSize, sampleRate);
+        }
+        if (r.midiNote == expected) ++correct;
+    }
+    return correct;
+}
+
+/** 88 键单音套件；返回正确率 */
+double runKeys(PitchDetector& detector, Mode mode, bool detune, bool inharmonic, double snrDb, float sampleRate) {
+    detector.prepare(sampleRate, kHop);
+    int32_t correct = 0;
+    for (int32_t midi = 21; midi <= 108; ++midi) {
+        synth::Tone tone{midi};
+        if (detune) tone.cents = (midi % 2 == 0) ? 30.0 : -30.0;
+        if (inharmonic) tone.inharmonicity = inharmonicityFor(midi);
+        std::vector<float> signal(kSignalLength, 0.0f);
+        synth::addTone(signal, tone, sampleRate);
+        if (snrDb > 0.0) synth::addNoise(signal, snrDb, static_cast<uint32_t>(midi));
+        if (2 * correctFrames(detector, mode, signal, midi, sampleRate) > kFrames) ++correct;
+    }
+    return correct / 88.0;
+}
+
+/**
+ * 噪声在前的单音套件：先 kLeadHops 帧只有噪声与工频，再起音；
+ * accuracy 按起音后窗口填满的 kFrames 帧过半正确统计，rejection 为纯噪声帧中未报音的比例
+ */
+void runNoiseLead(PitchDetector& detector, Mode mode, double snrDb, double& accuracy, double& rejection) {
+    constexpr int32_t kLeadHops = 96;
+    const int32_t toneStart = PitchDetector::kLongFftSize + kLeadHops * kHop;
+    const size_t length = static_cast<size_t>(toneStart + FFTWrapper::kFftSize + kFrames * kHop);
+    int32_t correct = 0;
+    int64_t noiseFrames = 0;
+    int64_t rejected = 0;
+    for (int32_t midi = 21; midi <= 108; ++midi) {
+        synth::Tone tone{midi};
+        tone.inharmonicity = inharmonicityFor(midi);
+        std::vector<float> note(length - static_cast<size_t>(toneStart), 0.0f);
+        synth::addTone(note, tone);
+        double power = 0.0;
+        for (float v : note) power += static_cast<double>(v) * v;
+        power /= static_cast<double>(note.size());
+
+        // 白噪声与工频各占一半噪声功率
+        const double sigma = std::sqrt(power / std::pow(10.0, snrDb / 10.0) / 2.0);
+        std::mt19937 rng(static_cast<uint32_t>(midi));
+        std::normal_distribution<double> white(0.0, 1.0);
+        std::vector<float> signal(length, 0.0f);
+        for (size_t i = 0; i < length; ++i) {
+            const double hum = std::sqrt(2.0) *
+                               std::sin(2.0 * synth::kPi * 50.0 * static_cast<double>(i) / synth::kSampleRate);
+            signal[i] = static_cast<float>(sigma * (white(rng) + hum));
+            if (i >= static_cast<size_t>(toneStart)) signal[i] += note[i - static_cast<size_t>(toneStart)];
+        }
+
+        detector.reset();
+        int32_t good = 0;
+        for (size_t end = PitchDetector::kLongFftSize + kHop; end <= length; end += kHop) {
+            PitchDetector::NoteResult r;
+            if (mode == Mode::MultiResolution) {
+                r = detector.processMultiResolution(signal.data() + end - PitchDetector::kLongFftSize,
+                                                    PitchDetector::kLongFftSize, synth::kSampleRate);
+            } else {
+                r = detector.process(signal.data() + end - FFTWrapper::kFftSize, FFTWrapper::kFftSize,
+                                     synth::kSampleRate);
+            }
+            if (end <= static_cast<size_t>(toneStart)) {
+                ++noiseFrames;
+                if (r.midiNote < 0) ++rejected;
+            } else if (end > static_cast<size_t>(toneStart + FFTWrapper::kFftSize) && r.midiNote == midi) {
+                ++good;
+            }
+        }
+        if (2 * good > kFrames) ++correct;
+    }
+    accuracy = correct / 88.0;
+    rejection = noiseFrames > 0 ? static_cast<double>(rejected) / static_cast<double>(noiseFrames) : 0.0;
+}
+
+/** HPS 频率精度：返回 f0 <= maxHz 的键中，[HPS::detect] 误差在 ±5 音分内的比例 */
+double runHpsPrecision(int32_t fftSize, float maxHz) {
+    FFTWrapper fft(fftSize);
+    HPS hps;
+    int32_t keys = 0;
+    int32_t precise = 0;
+    for (int32_t midi = 21; midi <= 108; ++midi) {
+        synth::Tone tone{midi};
+        tone.cents = (midi % 2 == 0) ? 30.0 : -30.0;
+        tone.inharmonicity = inharmonicityFor(midi);
+        const double f0 = synth::midiToHz(midi + tone.cents / 100.0);
+        if (f0 > maxHz) break;
+        std::vector<float> signal(fftSize, 0.0f);
+        synth::addTone(signal, tone);
+        const auto spectrum = fft.analyze(signal.data());
+        const auto r = hps.detect(spectrum.magnitudes, spectrum.numBins, synth::kSampleRate, 5, 27.5f, maxHz);
+        ++keys;
+        if (r.frequencyHz > 0.0f && std::fabs(1200.0 * std::log2(r.frequencyHz / f0)) <= 5.0) ++precise;
+    }
+    return keys > 0 ? static_cast<double>(precise) / keys : 0.0;
+}
+
+/** 拉伸调律的琴（相对 440 Hz 平均律的音分）：A4 = 442 Hz，低音区按键距平方降到 A0 的 -15 音分，高音区升到 C8 的 +30 音分 */
+double stretchedCents(int32_t midi) {
+    const double reference = 1200.0 * std::log2(442.0 / 440.0);
+    if (midi >= 69) {
+        const double d = (midi - 69) / 39.0;
+        return reference + 30.0 * d * d;
+    }
+    const double d = (69 - midi) / 48.0;
+    return reference - 15.0 * d * d;
+}
+
+/** 和弦套件：逐帧累计 TP / FP / FN；各音整体偏离 440 Hz 平均律 detuneCents 音分（检测器用当前调律表） */
+void runChords(PitchDetector& detector, double detuneCents, double& recall, double& precision) {
+    int64_t tp = 0;
+    int64_t fp = 0;
+    int64_t fn = 0;
+    const int32_t shapes[2][3] = {{0, 4, 7}, {0, 3, 7}};
+    for (int32_t root = 40; root <= 76; root += 3) {
+        for (const auto& shape : shapes) {
+            std::vector<float> signal(kSignalLength, 0.0f);
+            bool expected[128] = {};
+            for (int32_t interval : shape) {
+                synth::Tone tone{root + interval};
+                tone.inharmonicity = inharmonicityFor(tone.midi);
+                tone.cents = detuneCents;
+                tone.amplitude = 0.2;
+                synth::addTone(signal, tone, synth::kSampleRate, static_cast<uint32_t>(root));
+                expected[tone.midi] = true;
+            }
+            synth::addNoise(signal, 30.0, static_cast<uint32_t>(root));
+
+            detector.reset();
+            for (int32_t f = 0; f < kFrames; ++f) {
+                const int32_t end = PitchDetector::kLongFftSize + (f + 1) * kHop;
+                const auto chord = detector.processPolyphonic(signal.data() + end - FFTWrapper::kFftSize,
+                                                              FFTWrapper::kFftSize, synth::kSampleRate);
+                bool found[128] = {};
+                for (int32_t i = 0; i < chord.numNotes; ++i) {
+                    const int32_t m = chord.notes[i].midiNote;
+                    if (m < 0 || m >= 128 || found[m]) continue;
+                    found[m] = true;
+                    if (expected[m]) {
+                        ++tp;
+                    } else {
+                        ++fp;
+                    }
+                }
+                for (int32_t interval : shape) {
+                    if (!found[root + interval]) ++fn;
+                }
+            }
+        }
+    }
+    recall = tp + fn > 0 ? static_cast<double>(tp) / static_cast<double>(tp + fn) : 0.0;
+    precision = tp + fp > 0 ? static_cast<double>(tp) / static_cast<double>(tp + fp) : 0.0;
+}
+
+
+/**
+ * 调律套件：88 键按 stretched（[stretchedCents]，非谐泛音）或交替 ±30 音分（谐波泛音）失谐，加 30 dB 噪声，
+ * 用检测器当前的调律表检测。accuracy 同 [runKeys]；判对的键取正确帧报告音分的中位数：
+ * centsWithin5c 为它与真实基频相对该键中心的音分相差 ±5 音分内的比例（非谐音的 YIN 读数本身偏高，只对谐波音有意义），
+ * centred5c 为它本身在 ±5 音分内的比例（读数落在键中心，远离分界）。calibrator 非空时逐帧计入（另用一组噪声种子）。
+ */
+void runTuning(PitchDetector& detector, bool stretched, TuningCalibrator* calibrator, double& accuracy,
+               double& centsWithin5c, double& centred5c) {
+    detector.prepare(synth::kSampleRate, kHop);
+    const TuningTable& table = detector.tuning();
+    int32_t correct = 0;
+    int32_t precise = 0;
+    int32_t centred = 0;
+    for (int32_t midi = 21; midi <= 108; ++midi) {
+        synth::Tone tone{midi};
+        tone.cents = stretched ? stretchedCents(midi) : ((midi % 2 == 0) ? 30.0 : -30.0);
+        if (stretched) tone.inharmonicity = inharmonicityFor(midi);
+        std::vector<float> signal(kSignalLength, 0.0f);
+        synth::addTone(signal, tone);
+        synth::addNoise(signal, 30.0, static_cast<uint32_t>(midi) + (calibrator != nullptr ? 1000u : 0u));
+
+        detector.reset();
+        std::vector<float> cents;
+        for (int32_t f = 0; f < kFrames; ++f) {
+            const int32_t end = PitchDetector::kLongFftSize + (f + 1) * kHop;
+            const auto r = detector.process(signal.data() + end - FFTWrapper::kFftSize, FFTWrapper::kFftSize,
+                                            synth::kSampleRate);
+            if (calibrator != nullptr) calibrator->observe(r.midiNote, r.cents, r.confidence);
+            if (r.midiNote == midi) cents.push_back(r.cents);
+        }
+        if (2 * static_cast<int32_t>(cents.size()) <= kFrames) continue;
+        ++correct;
+        std::sort(cents.begin(), cents.end());
+        const auto f0 = static_cast<float>(synth::midiToHz(midi + tone.cents / 100.0));
+        const float expected = TuningTable::ratioToCents(f0 / table.centerHz(midi));
+        const float median = cents[cents.size() / 2];
+        if (std::fabs(median - expected) <= 5.0f) ++precise;
+        if (std::fabs(median) <= 5.0f) ++centred;
+    }
+    accuracy = correct / 88.0;
+    centsWithin5c = correct > 0 ? static_cast<double>(precise) / correct : 0.0;
+    centred5c = correct > 0 ? static_cast<double>(centred) / correct : 0.0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const bool reportOnly = argc > 1 && std::strcmp(argv[1], "--report") == 0;
+
+    auto detector = std::make_unique<PitchDetector>();
+    std::vector<Metric> metrics;
+
+    struct Suite {
+        const char* name;
+        bool detune;
+        bool inharmonic;
+        double snrDb;
+        float sampleRate;
+    };
+    const Suite suites[] = {
+        {"keys_clean", false, false, 0.0, synth::kSampleRate},
+        {"keys_detuned", true, false, 0.0, synth::kSampleRate},
+        {"keys_inharmonic", false, true, 0.0, synth::kSampleRate},
+        {"noise_30db", false, true, 30.0, synth::kSampleRate},
+        {"noise_20db", false, true, 20.0, synth::kSampleRate},
+        {"noise_10db", false, true, 10.0, synth::kSampleRate},
+        {"keys_44k", false, true, 0.0, 44100.0f},
+    };
+    for (const Suite& suite : suites) {
+        for (Mode mode : {Mode::Linear, Mode::ConstantQ, Mode::MultiResolution}) {
+            detector->setHpsFrontEnd(mode == Mode::ConstantQ ? PitchDetector::HpsFrontEnd::ConstantQ
+                                                             : PitchDetector::HpsFrontEnd::Linear);
+            const double accuracy =
+                runKeys(*detector, mode, suite.detune, suite.inharmonic, suite.snrDb, suite.sampleRate);
+            metrics.push_back({std::string(suite.name) + "/" + modeName(mode), accuracy});
+        }
+    }
+    detector->prepare(synth::kSampleRate, kHop);
+    for (Mode mode : {Mode::Linear, Mode::ConstantQ, Mode::MultiResolution}) {
+        detector->setHpsFrontEnd(mode == Mode::ConstantQ ? PitchDetector::HpsFrontEnd::ConstantQ
+                                                         : PitchDetector::HpsFrontEnd::Linear);
+        double accuracy = 0.0;
+        double rejection = 0.0;
+        runNoiseLead(*detector, mode, 5.0, accuracy, rejection);
+        metrics.push_back({std::string("hum_lead_5db/") + modeName(mode), accuracy});
+        metrics.push_back({std::string("hum_lead_5db_reject/") + modeName(mode), rejection});
+    }
+    detector->setHpsFrontEnd(PitchDetector::HpsFrontEnd::Linear);
+
+    metrics.push_back({"hps_within_5c/2048", runHpsPrecision(FFTWrapper::kFftSize, 4186.0f)});
+    metrics.push_back({"hps_within_5c/8192", runHpsPrecision(PitchDetector::kLongFftSize, PitchDetector::kSplitHz)});
+
+    // --- 调律：440 Hz 平均律表 -> 两轮校准 -> 校准表 ---
+    double accuracy = 0.0;
+    double within = 0.0;
+    double centred = 0.0;
+    runTuning(*detector, false, nullptr, accuracy, within, centred);
+    metrics.push_back({"tuning_cents_5c/detuned", within});
+    runTuning(*detector, true, nullptr, accuracy, within, centred);
+    metrics.push_back({"tuning_stretched/et440", accuracy});
+    metrics.push_back({"tuning_centred_5c/et440", centred});
+    TuningCalibrator calibrator;
+    for (int32_t pass = 0; pass < 2; ++pass) {
+        calibrator.reset();
+        runTuning(*detector, true, &calibrator, accuracy, within, centred);
+        TuningTable calibrated;
+        if (calibrator.build(detector->tuning(), calibrated)) detector->setTuning(calibrated);
+    }
+    runTuning(*detector, true, nullptr, accuracy, within, centred);
+    metrics.push_back({"tuning_stretched/calibrated", accuracy});
+    metrics.push_back({"tuning_centred_5c/calibrated", centred});
+    // 常 Q 前端与多音模板同样按校准表取样
+    detector->setHpsFrontEnd(PitchDetector::HpsFrontEnd::ConstantQ);
+    runTuning(*detector, true, nullptr, accuracy, within, centred);
+    detector->setHpsFrontEnd(PitchDetector::HpsFrontEnd::Linear);
+    metrics.push_back({"tuning_stretched/calibrated_cq", accuracy});
+    metrics.push_back({"tuning_centred_5c/calibrated_cq", centred});
+    detector->setTuning(TuningTable());
+
+    double recall = 0.0;
+    double precision = 0.0;
+    runChords(*detector, 0.0, recall, precision);
+    metrics.push_back({"chords/recall", recall});
+    metrics.push_back({"chords/precision", precision});
+    // A4 = 452 Hz 的琴（约 +46 音分，接近半音分界）：多音模板按调律表取样
+    TuningTable highPitch;
+    highPitch.set(452.0f, nullptr);
+    detector->setTuning(highPitch);
+    runChords(*detector, 1200.0 * std::log2(452.0 / 440.0), recall, precision);
+    detector->setTuning(TuningTable());
+    metrics.push_back({"chords_a452/recall", recall});
+    metrics.push_back({"chords_a452/precision", precision});
+
+    // --- 报告并与基线比较 ---
+    int32_t failures = 0;
+    std::printf("%-28s %8s %8s\n", "metric", "value", "min");
+    for (const Metric& m : metrics) {
+        double minimum = 0.0;
+        for (const Baseline& b : kBaselines) {
+            if (m.name == b.name) minimum = b.minimum;
+        }
+        const bool ok = m.value + 1e-9 >= minimum;
+        if (!ok) ++failures;
+        std::printf("%-28s %8.3f %8.3f%s\n", m.name.c_str(), m.value, minimum, ok ? "" : "  REGRESSION");
+    }
+    if (reportOnly) return 0;
+    if (failures > 0) {
+        std::printf("%d metric(s) below baseline\n", failures);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,380 @@
+/**
+ * @file PitchBenchmark.cpp
+ * @brief 主机基准：逐级测量检测管线每个 hop 的耗时（ns/hop）与堆分配次数（allocs/hop）
+ *
+ * 输入为合成的非谐钢琴音序列（每 0.5 s 换一个音，30 dB 白噪声），按 512 点 hop 滑动，
+ * 每级各跑 --hops 个 hop（默认 2000），取 --repeat 轮（默认 5）中最快一轮的平均值，减小调度抖动。
+ * 分配次数取自 [threadAllocationCount]：只有在 PIANO_NOTE_ALLOC_GUARD 构建（Debug 或 -DPIANO_NOTE_ALLOC_GUARD=ON）
+ * 下才计数，其余构建该列显示 n/a；基准期间关闭实时区 assert，只计数不中止。
+ *
+ * 默认管线跑完后另打印检测器 [StageStats] 的逐级分位数（PIANO_NOTE_STAGE_STATS 构建下）。
+ *
+ * engine/replay_*：[ReplayInputSource] 驱动完整的 [AudioEngine]（滑窗、检测、事件批量与回调），
+ * ns/hop 为整段回放的墙钟时间 / 分析 hop 数，另打印事件数、xrun、流水线计数与引擎各级分位数。
+ * 输入默认为同一合成信号，--replay 指定 WAV 录音（回归用的 golden 录音）。Inline 不限速回放，测整条路径的吞吐；
+ * Pipelined 按 --speed 倍速（默认 20，1 为实时）定速回放、只跑一轮：不限速时入队远快于分析，结果只反映队列满丢弃。
+ * 回放线程上的分配不计入 allocs/hop。
+ *
+ * 用法：piano_note_bench [--hops N] [--repeat R] [--replay file.wav] [--speed S]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "PitchDetector.h"
+#include "SyntheticSignals.h"
+#include "audio/AudioEngine.h"
+#include "audio/ReplayInputSource.h"
+#include "audio/SlidingWindow.h"
+#include "dsp/AllocationGuard.h"
+#include "dsp/ConstantQ.h"
+#include "dsp/FFTWrapper.h"
+#include "dsp/HPS.h"
+#include "dsp/NoiseFloor.h"
+#include "dsp/OnsetDetector.h"
+#include "dsp/PolyphonicDetector.h"
+#include "dsp/StageStats.h"
+#include "dsp/YINWrapper.h"
+
+namespace {
+
+constexpr int32_t kHop = 512;
+constexpr int32_t kWindow = FFTWrapper::kFftSize;
+constexpr int32_t kLongWindow = PitchDetector::kLongFftSize;
+
+/** 防止结果被优化掉 */
+volatile float gSink = 0.0f;
+
+struct StageResult {
+    double nsPerHop;
+    double allocsPerHop;
+};
+
+/**
+ * 对 hop 序号 0..hops-1 调用 body(window 末端样本序号)，返回最快一轮的平均值。
+ * 每轮前调用 reset（若有），不计时。
+ */
+StageResult measure(int32_t hops, int32_t repeat, const std::function<void()>& reset,
+                    const std::function<void(int64_t end)>& body) {
+    StageResult best{1e30, 0.0};
+    for (int32_t r = 0; r < repeat; ++r) {
+        if (reset) reset();
+        const uint64_t allocsBefore = threadAllocationCount();
+        const auto t0 = std::chrono::steady_clock::now();
+        for (int32_t h = 0; h < hops; ++h) {
+            body(kLongWindow + static_cast<int64_t>(h) * kHop);
+        }
+        const auto t1 = std::chrono::steady_clock::now();
+        const uint64_t allocs = threadAllocationCount() - allocsBefore;
+        const double ns = std::chrono::duration<double, std::nano>(t1 - t0).count() / hops;
+        if (ns < best.nsPerHop) best = StageResult{ns, static_cast<double>(allocs) / hops};
+    }
+    return best;
+}
+
+void report(const char* stage, const StageResult& result) {
+    if (allocationGuardEnabled()) {
+        std::printf("%-34s %12.0f %12.3f\n", stage, result.nsPerHop, result.allocsPerHop);
+    } else {
+        std::printf("%-34s %12.0f %12s\n", stage, result.nsPerHop, "n/a");
+    }
+}
+
+/** 合成测试信号：非谐钢琴音序列 + 30 dB 噪声 */
+std::vector<float> makeSignal(int32_t hops) {
+    const size_t length = static_cast<size_t>(kLongWindow) + static_cast<size_t>(hops) * kHop;
+    std::vector<float> signal(length, 0.0f);
+    const int32_t noteSamples = static_cast<int32_t>(synth::kSampleRate / 2);
+    const int32_t melody[] = {40, 52, 60, 64, 67, 72, 79, 88, 33, 48};
+    std::vector<float> segment;
+    for (size_t start = 0, i = 0; start < length; start += static_cast<size_t>(noteSamples), ++i) {
+        const size_t n = std::min(static_cast<size_t>(noteSamples), length - start);
+        segment.assign(n, 0.0f);
+        synth::Tone tone{melody[i % (sizeof(melody) / sizeof(melody[0]))]};
+        tone.inharmonicity = 1e-4 * std::pow(2.0, (tone.midi - 21) / 24.0);
+        synth::addTone(segment, tone, synth::kSampleRate, static_cast<uint32_t>(i));
+        std::copy(segment.begin(), segment.end(), signal.begin() + static_cast<std::ptrdiff_t>(start));
+    }
+    synth::addNoise(signal, 30.0);
+    return signal;
+}
+
+int32_t parseArg(int argc, char** argv, const char* name, int32_t fallback) {
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (std::strcmp(argv[i], name) == 0) return std::max(1, std::atoi(argv[i + 1]));
+    }
+    return fallback;
+}
+
+const char* parseString(int argc, char** argv, const char* name) {
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (std::strcmp(argv[i], name) == 0) return argv[i + 1];
+    }
+    return nullptr;
+}
+
+/** 回放时的事件计数（回调在检测线程或 stop 的调用线程上，不会并发） */
+struct ReplayCounters {
+    int64_t events = 0;
+    int64_t noteOns = 0;
+};
+
+void countEvents(void* user, const NoteEvent* events, int32_t count) {
+    auto* counters = static_cast<ReplayCounters*>(user);
+    counters->events += count;
+    for (int32_t i = 0; i < count; ++i) {
+        if (events[i].type == static_cast<int32_t>(NoteEventType::NoteOn)) ++counters->noteOns;
+    }
+}
+
+/**
+ * 用 source 驱动一个新引擎回放到结束，取 repeat 轮中最快一轮；打印 ns/hop 行与最后一轮的计数、分位数。
+ * @return 回放失败（源未就绪或引擎启动失败）为 false
+ */
+bool replayEngine(const char* name, ReplayInputSource& source, AudioEngine::ProcessingMode mode, int32_t repeat) {
+    double bestNs = 1e30;
+    int64_t hops = 0;
+    ReplayCounters counters;
+    AudioEngine::Stats stats{};
+    AudioEngine::PipelineStats pipeline{};
+    for (int32_t r = 0; r < repeat; ++r) {
+        AudioEngine engine;
+        engine.setInputSource(&source);
+        engine.setProcessingMode(mode);
+        counters = ReplayCounters{};
+        AudioEngine::Callbacks callbacks;
+        callbacks.onEvents = &countEvents;
+        callbacks.user = &counters;
+
+        const auto t0 = std::chrono::steady_clock::now();
+        if (!engine.start(callbacks)) return false;
+        source.waitUntilFinished();
+        stats = engine.stats();
+        engine.stop();
+        const auto t1 = std::chrono::steady_clock::now();
+
+        pipeline = engine.pipelineStats();
+        hops = std::max<int64_t>(source.numSamples() / engine.hopSize(), 1);
+        bestNs = std::min(bestNs, std::chrono::duration<double, std::nano>(t1 - t0).count() / static_cast<double>(hops));
+    }
+
+    std::printf("%-34s %12.0f %12s\n", name, bestNs, "n/a");
+    const double hopNs = 1e9 * static_cast<double>(source.numSamples()) / static_cast<double>(hops) /
+                         static_cast<double>(source.sampleRate());
+    std::printf("replay: hops=%lld speed=%.1fx events=%lld note_on=%lld xruns=%d pushed=%llu dropped=%llu "
+                "coalesced=%llu (%s, last round)\n",
+                static_cast<long long>(hops), hopNs / bestNs, static_cast<long long>(counters.events),
+                static_cast<long long>(counters.noteOns), stats.xRunCount,
+                static_cast<unsigned long long>(pipeline.pushedHops),
+                static_cast<unsigned long long>(pipeline.droppedHops),
+                static_cast<unsigned long long>(pipeline.coalescedHops), name);
+    if (StageStats::enabled()) {
+        const char* stageNames[] = {"detect", "callback", "dispatch", "e2e"};
+        const StageStats::Stage stages[] = {StageStats::Stage::Detect, StageStats::Stage::AudioCallback,
+                                            StageStats::Stage::Dispatch, StageStats::Stage::EndToEnd};
+        for (int32_t i = 0; i < 4; ++i) {
+            const StageStats::Summary& st = stats.stages[static_cast<int32_t>(stages[i])];
+            std::printf("stage %-8s count=%llu p50=%lluns p99=%lluns max=%lluns (%s, last round)\n", stageNames[i],
+                        static_cast<unsigned long long>(st.count), static_cast<unsigned long long>(st.p50Ns),
+                        static_cast<unsigned long long>(st.p99Ns), static_cast<unsigned long long>(st.maxNs), name);
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const int32_t hops = parseArg(argc, argv, "--hops", 2000);
+    const int32_t repeat = parseArg(argc, argv, "--repeat", 5);
+    const float sr = synth::kSampleRate;
+    setRealtimeAllocationFatal(false);
+
+    const std::vector<float> signal = makeSignal(hops);
+    const float* data = signal.data();
+
+    std::printf("hops=%d repeat=%d sampleRate=%.0f allocGuard=%s\n", hops, repeat, sr,
+                allocationGuardEnabled() ? "on" : "off");
+    std::printf("%-34s %12s %12s\n", "stage", "ns/hop", "allocs/hop");
+
+    // --- 单级：各自独立实例，输入为同一信号 ---
+    {
+        FFTWrapper fft;
+        report("fft2048/full", measure(hops, repeat, nullptr, [&](int64_t end) {
+                   gSink = gSink + fft.analyze(data + end - kWindow).rms;
+               }));
+        fft.setStrategy(FFTWrapper::Strategy::Incremental);
+        report("fft2048/incremental", measure(hops, repeat, [&] { fft.reset(); }, [&](int64_t end) {
+                   gSink = gSink + fft.analyze(data + end - kWindow).rms;
+               }));
+    }
+    {
+        FFTWrapper fft(kLongWindow);
+        report("fft8192/full", measure(hops, repeat, nullptr, [&](int64_t end) {
+                   gSink = gSink + fft.analyze(data + end - kLongWindow).rms;
+               }));
+    }
+
+    {
+        SlidingWindow window(kWindow);
+        report("window/slide2048", measure(hops, repeat, [&] { window.clear(); }, [&](int64_t end) {
+                   window.push(data + end - kHop, kHop);
+                   gSink = gSink + window.data()[0];
+               }));
+        window.resize(kLongWindow);
+        report("window/slide8192", measure(hops, repeat, [&] { window.clear(); }, [&](int64_t end) {
+                   window.push(data + end - kHop, kHop);
+                   gSink = gSink + window.data()[0];
+               }));
+    }
+
+    // 下游各级使用同一帧的预先算好的谱，只计本级耗时
+    FFTWrapper fft;
+    const auto spectrum = fft.analyze(data + kLongWindow - kWindow);
+    {
+        HPS hps;
+        report("hps/linear", measure(hops, repeat, nullptr, [&](int64_t) {
+                   gSink = gSink + hps.detect(spectrum.magnitudes, spectrum.numBins, sr, 5, 27.5f, 4186.0f).frequencyHz;
+               }));
+        NoiseFloor noise(spectrum.numBins);
+        std::vector<float> whitened(static_cast<size_t>(spectrum.numBins));
+        report("noise_floor/whiten", measure(hops, repeat, [&] { noise.reset(); }, [&](int64_t) {
+                   gSink = gSink + noise.whiten(spectrum.magnitudes, whitened.data(), spectrum.numBins);
+               }));
+        ConstantQ cq(kWindow, sr, PitchDetector::kCqBinsPerSemitone);
+        std::vector<float> cqOut(static_cast<size_t>(cq.numBins()));
+        report("constant_q/transform", measure(hops, repeat, nullptr, [&](int64_t) {
+                   cq.transform(spectrum.re, spectrum.im, cqOut.data());
+                   gSink = gSink + cqOut[0];
+               }));
+        report("hps/semitone", measure(hops, repeat, nullptr, [&](int64_t) {
+                   gSink = gSink + hps.detectSemitone(cqOut.data(), cq.binFrequencies(), cq.numBins(), cq.binsPerSemitone(),
+                                                      5, 27.5f, 4186.0f)
+                                       .frequencyHz;
+               }));
+    }
+    {
+        YINWrapper yin;
+        report("yin", measure(hops, repeat, nullptr, [&](int64_t end) {
+                   gSink = gSink + yin.detect(data + end - kWindow, kWindow, sr).pitchHz;
+               }));
+        // 级联融合里一次候选确认的开销：邻域 ±3% 的窄带 YIN（C4 附近）
+        report("yin/narrow", measure(hops, repeat, nullptr, [&](int64_t end) {
+                   yin.prepareNarrow(data + end - kWindow, kWindow);
+                   gSink = gSink + yin.detectNear(sr, 261.6f, PitchDetector::kNarrowYinTolerance).pitchHz;
+               }));
+    }
+    {
+        OnsetDetector onset;
+        report("onset/update", measure(hops, repeat, [&] { onset.reset(); }, [&](int64_t) {
+                   gSink = gSink + static_cast<float>(onset.update(spectrum.magnitudes, spectrum.numBins, kWindow, sr,
+                                                                  spectrum.rms));
+               }));
+    }
+    {
+        PolyphonicDetector poly;
+        poly.prepare(kWindow, sr);
+        PolyphonicDetector::Note notes[PolyphonicDetector::kMaxNotes];
+        report("polyphonic/detect", measure(hops, repeat, nullptr, [&](int64_t) {
+                   gSink = gSink + static_cast<float>(poly.detect(spectrum.magnitudes, spectrum.numBins, notes));
+               }));
+    }
+
+    {
+        // 逐级计时本身的开销：一帧三次打点 + 析构记录（与 PitchDetector::process 相同）
+        StageStats stats;
+        report("stage_stats/timer", measure(hops, repeat, [&] { stats.reset(); }, [&](int64_t) {
+                   StageTimer timer(stats, StageStats::Stage::Detect);
+                   timer.lap(StageStats::Stage::Fft);
+                   timer.lap(StageStats::Stage::Hps);
+                   timer.lap(StageStats::Stage::Yin);
+               }));
+    }
+
+    // --- 整条管线：与 AudioEngine 每 hop 的调用一致 ---
+    auto detector = std::make_unique<PitchDetector>();
+    const auto reset = [&] { detector->reset(); };
+    report("pipeline/process", measure(hops, repeat, reset, [&](int64_t end) {
+               gSink = gSink + detector->process(data + end - kWindow, kWindow, sr).frequencyHz;
+           }));
+    const PitchDetector::FusionStats fusion = detector->fusionStats();
+    const char* stageNames[] = {"fft", "hps", "yin", "detect"};
+    const StageStats::Stage stages[] = {StageStats::Stage::Fft, StageStats::Stage::Hps, StageStats::Stage::Yin,
+                                        StageStats::Stage::Detect};
+    StageStats::Summary stageSummaries[4];
+    for (int32_t i = 0; i < 4; ++i) stageSummaries[i] = detector->stageStats().summary(stages[i]);
+    detector->setFusionMode(PitchDetector::FusionMode::Parallel);
+    report("pipeline/process_parallel", measure(hops, repeat, reset, [&](int64_t end) {
+               gSink = gSink + detector->process(data + end - kWindow, kWindow, sr).frequencyHz;
+           }));
+    report("pipeline/multi_resolution_parallel", measure(hops, repeat, reset, [&](int64_t end) {
+               gSink = gSink + detector->processMultiResolution(data + end - kLongWindow, kLongWindow, sr).frequencyHz;
+           }));
+    detector->setFusionMode(PitchDetector::FusionMode::Cascaded);
+    detector->setNoiseWhitening(false);
+    report("pipeline/process_unwhitened", measure(hops, repeat, reset, [&](int64_t end) {
+               gSink = gSink + detector->process(data + end - kWindow, kWindow, sr).frequencyHz;
+           }));
+    detector->setNoiseWhitening(true);
+    detector->setHpsFrontEnd(PitchDetector::HpsFrontEnd::ConstantQ);
+    report("pipeline/process_cq", measure(hops, repeat, reset, [&](int64_t end) {
+               gSink = gSink + detector->process(data + end - kWindow, kWindow, sr).frequencyHz;
+           }));
+    detector->setHpsFrontEnd(PitchDetector::HpsFrontEnd::Linear);
+    report("pipeline/multi_resolution", measure(hops, repeat, reset, [&](int64_t end) {
+               gSink = gSink + detector->processMultiResolution(data + end - kLongWindow, kLongWindow, sr).frequencyHz;
+           }));
+    report("pipeline/polyphonic", measure(hops, repeat, reset, [&](int64_t end) {
+               gSink = gSink + static_cast<float>(
+                                   detector->processPolyphonic(data + end - kWindow, kWindow, sr).numNotes);
+           }));
+    detector->setOnsetGating(true);
+    report("pipeline/process_gated", measure(hops, repeat, reset, [&](int64_t end) {
+               gSink = gSink + detector->process(data + end - kWindow, kWindow, sr).frequencyHz;
+           }));
+    std::printf("fusion: frames=%llu narrow_yin=%llu confirmed=%llu full_yin=%llu (pipeline/process, last round)\n",
+                static_cast<unsigned long long>(fusion.frames), static_cast<unsigned long long>(fusion.narrowYin),
+                static_cast<unsigned long long>(fusion.confirmed), static_cast<unsigned long long>(fusion.fullYin));
+    if (StageStats::enabled()) {
+        for (int32_t i = 0; i < 4; ++i) {
+            const StageStats::Summary& st = stageSummaries[i];
+            std::printf("stage %-6s count=%llu p50=%lluns p99=%lluns max=%lluns (pipeline/process, last round)\n",
+                        stageNames[i], static_cast<unsigned long long>(st.count),
+                        static_cast<unsigned long long>(st.p50Ns), static_cast<unsigned long long>(st.p99Ns),
+                        static_cast<unsigned long long>(st.maxNs));
+        }
+    }
+    const auto& gate = detector->gateStats();
+    std::printf("gated: analyzed=%llu reused=%llu silent=%llu onsets=%llu (last round)\n",
+                static_cast<unsigned long long>(gate.analyzed), static_cast<unsigned long long>(gate.reused),
+                static_cast<unsigned long long>(gate.silent), static_cast<unsigned long long>(gate.onsets));
+
+    // --- 整条实时路径：回放源驱动 AudioEngine ---
+    ReplayInputSource::Config replayConfig;
+    replayConfig.pacing = ReplayInputSource::Pacing::Unpaced;
+    ReplayInputSource source(replayConfig);
+    const char* replayPath = parseString(argc, argv, "--replay");
+    if (replayPath != nullptr ? !source.loadWav(replayPath)
+                              : !source.setSamples(data, static_cast<int64_t>(signal.size()),
+                                                   static_cast<int32_t>(sr))) {
+        std::fprintf(stderr, "replay: cannot load %s\n", replayPath != nullptr ? replayPath : "synthetic signal");
+        return 1;
+    }
+    bool replayed = replayEngine("engine/replay_inline", source, AudioEngine::ProcessingMode::Inline, repeat);
+    replayConfig.pacing = ReplayInputSource::Pacing::RealTime;
+    replayConfig.speed = static_cast<float>(parseArg(argc, argv, "--speed", 20));
+    source.setConfig(replayConfig);
+    replayed = replayed && replayEngine("engine/replay_pipelined_paced", source, AudioEngine::ProcessingMode::Pipelined, 1);
+    if (!replayed) {
+        std::fprintf(stderr, "replay: engine failed to start\n");
+        return 1;
+    }
+    return 0;
+}
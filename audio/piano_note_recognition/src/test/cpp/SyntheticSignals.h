@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+/**
+ * @file SyntheticSignals.h
+ * @brief 主机基准 / 准确率套件共用的合成信号：钢琴式非谐泛音、失谐、和弦与指定信噪比的白噪声
+ *
+ * 泛音模型：第 n 次泛音频率 f_n = n f0 sqrt(1 + B n^2)（B 为弦的非谐系数），幅度 1/n，
+ * 只保留 0.45 fs 以下的泛音；每个音按 RMS 归一后乘 amplitude，和弦中各音等响。
+ * 噪声由固定种子生成，结果可复现。
+ */
+namespace synth {
+
+constexpr float kSampleRate = 48000.0f;
+constexpr double kPi = 3.14159265358979323846;
+
+inline double midiToHz(double midi) { return 440.0 * std::pow(2.0, (midi - 69.0) / 12.0); }
+
+struct Tone {
+    int32_t midi;
+    double cents = 0.0;          ///< 相对平均律的失谐
+    double inharmonicity = 0.0;  ///< B；真实钢琴约 1e-4（低音）.. 1e-3（高音）
+    int32_t partials = 12;
+    double amplitude = 0.3;      ///< 目标 RMS
+};
+
+/** 把一个音累加到 out[0..n)；phaseSeed 使同一信号里各音的初相不同 */
+inline void addTone(std::vector<float>& out, const Tone& tone, float sampleRate = kSampleRate,
+                    uint32_t phaseSeed = 1) {
+    const double f0 = midiToHz(tone.midi + tone.cents / 100.0);
+    std::mt19937 rng(phaseSeed * 7919u + static_cast<uint32_t>(tone.midi));
+    std::uniform_real_distribution<double> phase(0.0, 2.0 * kPi);
+
+    double power = 0.0;
+    std::vector<double> freqs;
+    std::vector<double> amps;
+    for (int32_t n = 1; n <= tone.partials; ++n) {
+        const double fn = n * f0 * std::sqrt(1.0 + tone.inharmonicity * n * n);
+        if (fn >= 0.45 * sampleRate) break;
+        freqs.push_back(fn);
+        amps.push_back(1.0 / n);
+        power += 0.5 / (static_cast<double>(n) * n);
+    }
+    const double gain = power > 0.0 ? tone.amplitude / std::sqrt(power) : 0.0;
+    for (size_t p = 0; p < freqs.size(); ++p) {
+        const double w = 2.0 * kPi * freqs[p] / sampleRate;
+        const double phi = phase(rng);
+        const double a = gain * amps[p];
+        for (size_t i = 0; i < out.size(); ++i) {
+            out[i] += static_cast<float>(a * std::sin(w * static_cast<double>(i) + phi));
+        }
+    }
+}
+
+/** 按当前信号 RMS 加白噪声，使 SNR 为 snrDb */
+inline void addNoise(std::vector<float>& out, double snrDb, uint32_t seed = 1) {
+    double power = 0.0;
+    for (float v : out) power += static_cast<double>(v) * v;
+    power /= static_cast<double>(out.size());
+    const double sigma = std::sqrt(power / std::pow(10.0, snrDb / 10.0));
+    std::mt19937 rng(seed);
+    std::normal_distribution<double> noise(0.0, sigma);
+    for (float& v : out) v += static_cast<float>(noise(rng));
+}
+
+} // namespace synth